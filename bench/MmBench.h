@@ -0,0 +1,45 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_BENCH_H__
+#define __MM_BENCH_H__
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace meshmagick
+{
+    /// Runs f repeats times and returns the fastest run in seconds.
+    template <typename F>
+    double bestOf(int repeats, F f)
+    {
+        double best = 1e30;
+        for (int i = 0; i < repeats; ++i)
+        {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            f();
+            const std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+}
+#endif
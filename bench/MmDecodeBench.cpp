@@ -0,0 +1,78 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Compares decoding vertex elements one at a time with MeshUtils::decodeVertexElement
+// against MeshUtils::decodeVertexElements, for the common element types.
+// Usage: MmDecodeBench [vertex count]
+
+#include "MmBench.h"
+#include "MmMeshUtils.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Ogre;
+using namespace meshmagick;
+
+int main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1 << 20;
+    const size_t stride = 32;
+    std::vector<unsigned char> data(count * stride);
+    std::mt19937 rng(1);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<unsigned char>(rng());
+    }
+    // The float types read the first 16 bytes, give them ordinary values instead of NaNs.
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (size_t c = 0; c < 4; ++c)
+        {
+            const float value = dist(rng);
+            std::memcpy(&data[i * stride + c * sizeof(float)], &value, sizeof(value));
+        }
+    }
+
+    const VertexElementType types[] = { VET_FLOAT2, VET_FLOAT3, VET_FLOAT4, VET_SHORT2,
+        VET_SHORT4, VET_USHORT2, VET_UBYTE4, VET_COLOUR_ABGR, VET_COLOUR_ARGB };
+    std::vector<float> single(4 * count), batch(4 * count);
+    std::printf("%zu vertices, ns per element\n", count);
+    std::printf("type  single   batch  same result\n");
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t)
+    {
+        const VertexElementType type = types[t];
+        const double singleSeconds = bestOf(5, [&]() {
+            for (size_t i = 0; i < count; ++i)
+            {
+                MeshUtils::decodeVertexElement(type, &data[i * stride], &single[4 * i]);
+            }
+        });
+        const double batchSeconds = bestOf(5, [&]() {
+            MeshUtils::decodeVertexElements(type, &data[0], stride, count, &batch[0]);
+        });
+        const bool same = std::memcmp(&single[0], &batch[0], single.size() * sizeof(float)) == 0;
+        std::printf("%4d  %6.2f  %6.2f  %s\n", static_cast<int>(type),
+            singleSeconds * 1e9 / count, batchSeconds * 1e9 / count, same ? "yes" : "NO");
+    }
+    return 0;
+}
@@ -0,0 +1,194 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Checks that memory doesn't grow with the number of files processed. Writes copies of a
+// generated mesh to the working directory and runs the info tool over them in batches,
+// each file under its own name as in a real run. Fails if the resident set size grew by
+// more than a few megabytes between the first and the last batch.
+// Usage: MmInfoMemoryCheck [file count]
+
+#include "MmInfoToolFactory.h"
+#include "MmOgreEnvironment.h"
+#include "MmToolManager.h"
+
+#include <OgreHardwareBufferManager.h>
+#include <OgreMeshManager.h>
+#include <OgreMeshSerializer.h>
+#include <OgreResourceGroupManager.h>
+#include <OgreSubMesh.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#if defined(_WIN32)
+#   include <windows.h>
+#   include <psapi.h>
+#else
+#   include <sys/resource.h>
+#   include <unistd.h>
+#endif
+
+using namespace Ogre;
+using namespace meshmagick;
+
+//New shared ptr API introduced in 1.10.1
+#if OGRE_VERSION >= 0x10A01
+#define OGRE_GETPOINTER(_sharedPtr) ((_sharedPtr).get())
+#else
+#define OGRE_GETPOINTER(_sharedPtr) ((_sharedPtr).getPointer())
+#endif
+
+namespace
+{
+    const size_t BATCH_SIZE = 1000;
+    const size_t ALLOWED_GROWTH_KB = 4 * 1024;
+
+    /// Current resident set size, the peak where the current one isn't available.
+    size_t getResidentKilobytes()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return counters.WorkingSetSize / 1024;
+#else
+        std::ifstream statm("/proc/self/statm");
+        size_t pages, residentPages;
+        if (statm >> pages >> residentPages)
+        {
+            return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+        }
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#   if defined(__APPLE__)
+        return static_cast<size_t>(usage.ru_maxrss) / 1024;
+#   else
+        return static_cast<size_t>(usage.ru_maxrss);
+#   endif
+#endif
+    }
+
+    /// Writes a mesh with a single submesh of vertexCount unindexed positions.
+    void writeMesh(const String& fileName, size_t vertexCount)
+    {
+        MeshPtr mesh = MeshManager::getSingleton().createManual(fileName,
+            ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        SubMesh* sm = mesh->createSubMesh();
+        sm->useSharedVertices = false;
+        sm->setMaterialName("generated");
+        sm->vertexData = new VertexData();
+        sm->vertexData->vertexCount = vertexCount;
+        sm->vertexData->vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+
+        std::vector<float> positions(vertexCount * 3);
+        std::vector<uint16> indices(vertexCount);
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            positions[3 * i] = static_cast<float>(i % 3);
+            positions[3 * i + 1] = static_cast<float>(i / 3);
+            positions[3 * i + 2] = 0;
+            indices[i] = static_cast<uint16>(i);
+        }
+        HardwareVertexBufferSharedPtr vb =
+            HardwareBufferManager::getSingleton().createVertexBuffer(
+                3 * sizeof(float), vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        vb->writeData(0, vb->getSizeInBytes(), &positions[0], true);
+        sm->vertexData->vertexBufferBinding->setBinding(0, vb);
+
+        sm->indexData->indexCount = vertexCount;
+        sm->indexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+            HardwareIndexBuffer::IT_16BIT, vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        sm->indexData->indexBuffer->writeData(0, vertexCount * sizeof(uint16), &indices[0], true);
+
+        mesh->_setBounds(AxisAlignedBox(Vector3::ZERO,
+            Vector3(2, static_cast<Real>(vertexCount / 3), 0)));
+        MeshSerializer serializer;
+        serializer.exportMesh(OGRE_GETPOINTER(mesh), fileName);
+        OgreEnvironment::getSingleton().releaseResources();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t fileCount = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 10000;
+
+    OgreEnvironment* ogreEnv = new OgreEnvironment();
+    ogreEnv->initialize();
+    ToolManager manager;
+    manager.registerToolFactory(new InfoToolFactory());
+
+    writeMesh("generated.mesh", 3000);
+    std::ifstream in("generated.mesh", std::ios_base::in | std::ios_base::binary);
+    const std::string meshData((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+    in.close();
+    std::remove("generated.mesh");
+
+    StringVector fileNames;
+    for (size_t i = 0; i < fileCount; ++i)
+    {
+        std::ostringstream fileName;
+        fileName << "generated" << i << ".mesh";
+        fileNames.push_back(fileName.str());
+        std::ofstream out(fileName.str().c_str(), std::ios_base::out | std::ios_base::binary);
+        out << meshData;
+    }
+
+    OptionList globalOptions;
+    globalOptions.push_back(Option("quiet", Any(true)));
+    size_t firstBatchKb = 0, lastBatchKb = 0;
+    int result = 0;
+    try
+    {
+        for (size_t first = 0; first < fileNames.size(); first += BATCH_SIZE)
+        {
+            const StringVector batch(fileNames.begin() + first,
+                fileNames.begin() + std::min(first + BATCH_SIZE, fileNames.size()));
+            manager.invokeTool("info", globalOptions, 0, NULL, batch, StringVector());
+            lastBatchKb = getResidentKilobytes();
+            if (first == 0)
+            {
+                firstBatchKb = lastBatchKb;
+            }
+            std::printf("%6zu files: %zu kB resident\n", first + batch.size(), lastBatchKb);
+        }
+        if (lastBatchKb > firstBatchKb + ALLOWED_GROWTH_KB)
+        {
+            std::printf("FAILED: grew by %zu kB after the first batch\n",
+                lastBatchKb - firstBatchKb);
+            result = 1;
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::printf("FAILED: %s\n", e.what());
+        result = 1;
+    }
+
+    for (size_t i = 0; i < fileNames.size(); ++i)
+    {
+        std::remove(fileNames[i].c_str());
+    }
+    delete ogreEnv;
+    return result;
+}
@@ -0,0 +1,108 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Compares loading meshes through an ifstream, as meshmagick did before, with loading them
+// through MappedFileDataStream. Both go through Ogre's MeshSerializer, only the stream
+// differs. Run it twice to have the files in the page cache for both.
+// Usage: MmLoadBench file.mesh...
+
+#include "MmBench.h"
+#include "MmMappedFileDataStream.h"
+#include "MmOgreEnvironment.h"
+
+#include <OgreMeshManager.h>
+#include <OgreMeshSerializer.h>
+#include <OgreResourceGroupManager.h>
+
+#include <fstream>
+#include <vector>
+
+using namespace Ogre;
+using namespace meshmagick;
+
+//New shared ptr API introduced in 1.10.1
+#if OGRE_VERSION >= 0x10A01
+#define OGRE_GETPOINTER(_sharedPtr) ((_sharedPtr).get())
+#else
+#define OGRE_GETPOINTER(_sharedPtr) ((_sharedPtr).getPointer())
+#endif
+
+namespace
+{
+    /// Loads fileName from stream and releases it again.
+    void loadMesh(const String& fileName, DataStreamPtr stream)
+    {
+        MeshPtr mesh = MeshManager::getSingleton().create(fileName,
+            ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        MeshSerializer serializer;
+        serializer.importMesh(stream, OGRE_GETPOINTER(mesh));
+        stream->close();
+        OgreEnvironment::getSingleton().releaseResources();
+    }
+
+    void loadWithIfstream(const std::vector<String>& fileNames)
+    {
+        for (size_t i = 0; i < fileNames.size(); ++i)
+        {
+            std::ifstream ifs(fileNames[i].c_str(), std::ios_base::in | std::ios_base::binary);
+            loadMesh(fileNames[i],
+                DataStreamPtr(new FileStreamDataStream(fileNames[i], &ifs, false)));
+        }
+    }
+
+    void loadWithMapping(const std::vector<String>& fileNames)
+    {
+        for (size_t i = 0; i < fileNames.size(); ++i)
+        {
+            loadMesh(fileNames[i], MappedFileDataStream::open(fileNames[i]));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::printf("usage: MmLoadBench file.mesh...\n");
+        return 1;
+    }
+
+    OgreEnvironment* ogreEnv = new OgreEnvironment();
+    ogreEnv->initialize();
+
+    std::vector<String> fileNames(argv + 1, argv + argc);
+    double megabytes = 0;
+    for (size_t i = 0; i < fileNames.size(); ++i)
+    {
+        std::ifstream ifs(fileNames[i].c_str(), std::ios_base::in | std::ios_base::binary);
+        ifs.seekg(0, std::ios_base::end);
+        megabytes += static_cast<double>(ifs.tellg()) / (1024 * 1024);
+    }
+
+    const double ifstreamSeconds = bestOf(5, [&]() { loadWithIfstream(fileNames); });
+    const double mappingSeconds = bestOf(5, [&]() { loadWithMapping(fileNames); });
+    std::printf("%zu files, %.1f MB\n", fileNames.size(), megabytes);
+    std::printf("ifstream  %8.2f ms  %8.1f MB/s\n", ifstreamSeconds * 1e3,
+        megabytes / ifstreamSeconds);
+    std::printf("mapped    %8.2f ms  %8.1f MB/s\n", mappingSeconds * 1e3,
+        megabytes / mappingSeconds);
+
+    delete ogreEnv;
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Checks that merging never leaves a morph animation on the shared vertices whose
+// keyframes hold fewer vertices than there are. Merges a mesh with a shared vertex morph
+// animation, then a plain mesh whose shared vertices are appended.
+// Usage: MmMergeMorphCheck
+
+#include "MmMeshMergeTool.h"
+#include "MmOgreEnvironment.h"
+
+#include <OgreAnimation.h>
+#include <OgreHardwareBufferManager.h>
+#include <OgreMeshManager.h>
+#include <OgreResourceGroupManager.h>
+#include <OgreSubMesh.h>
+
+#include <cstdio>
+#include <vector>
+
+using namespace Ogre;
+using namespace meshmagick;
+
+namespace
+{
+    const size_t VERTEX_COUNT = 3;
+
+    HardwareVertexBufferSharedPtr createPositionBuffer(float offset)
+    {
+        std::vector<float> positions(VERTEX_COUNT * 3);
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            positions[i] = offset + static_cast<float>(i);
+        }
+        HardwareVertexBufferSharedPtr vb =
+            HardwareBufferManager::getSingleton().createVertexBuffer(
+                3 * sizeof(float), VERTEX_COUNT, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        vb->writeData(0, vb->getSizeInBytes(), &positions[0], true);
+        return vb;
+    }
+
+    /// A mesh with one triangle in shared vertices, morphed if withMorph is set.
+    MeshPtr createMesh(const String& name, bool withMorph)
+    {
+        MeshPtr mesh = MeshManager::getSingleton().createManual(name,
+            ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        mesh->sharedVertexData = new VertexData();
+        mesh->sharedVertexData->vertexCount = VERTEX_COUNT;
+        mesh->sharedVertexData->vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+        mesh->sharedVertexData->vertexBufferBinding->setBinding(0, createPositionBuffer(0));
+
+        SubMesh* sm = mesh->createSubMesh();
+        sm->useSharedVertices = true;
+        sm->setMaterialName("generated");
+        const uint16 indices[VERTEX_COUNT] = { 0, 1, 2 };
+        sm->indexData->indexCount = VERTEX_COUNT;
+        sm->indexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+            HardwareIndexBuffer::IT_16BIT, VERTEX_COUNT, HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+        sm->indexData->indexBuffer->writeData(0, sizeof(indices), indices, true);
+
+        if (withMorph)
+        {
+            Animation* anim = mesh->createAnimation("morph", 1);
+            VertexAnimationTrack* track =
+                anim->createVertexTrack(0, mesh->sharedVertexData, VAT_MORPH);
+            track->createVertexMorphKeyFrame(0)->setVertexBuffer(createPositionBuffer(0));
+            track->createVertexMorphKeyFrame(1)->setVertexBuffer(createPositionBuffer(1));
+        }
+        mesh->_setBounds(AxisAlignedBox(Vector3::ZERO, Vector3(9, 9, 9)));
+        return mesh;
+    }
+}
+
+int main()
+{
+    OgreEnvironment* ogreEnv = new OgreEnvironment();
+    ogreEnv->initialize();
+
+    int result = 0;
+    try
+    {
+        MeshMergeTool tool;
+        tool.addMesh(createMesh("morphed.mesh", true));
+        tool.addMesh(createMesh("plain.mesh", false));
+        MeshPtr merged = tool.merge("merged.mesh");
+
+        const size_t sharedVertexCount = merged->sharedVertexData->vertexCount;
+        std::printf("%zu shared vertices after merging\n", sharedVertexCount);
+        for (ushort i = 0; i < merged->getNumAnimations(); ++i)
+        {
+            Animation* anim = merged->getAnimation(i);
+            if (!anim->hasVertexTrack(0) ||
+                anim->getVertexTrack(0)->getAnimationType() != VAT_MORPH)
+            {
+                continue;
+            }
+            VertexAnimationTrack* track = anim->getVertexTrack(0);
+            for (ushort k = 0; k < track->getNumKeyFrames(); ++k)
+            {
+                const size_t keyFrameVertices =
+                    track->getVertexMorphKeyFrame(k)->getVertexBuffer()->getNumVertices();
+                if (keyFrameVertices < sharedVertexCount)
+                {
+                    std::printf("FAILED: keyframe %u of %s holds %zu vertices\n",
+                        static_cast<unsigned int>(k), anim->getName().c_str(), keyFrameVertices);
+                    result = 1;
+                }
+            }
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::printf("FAILED: %s\n", e.what());
+        result = 1;
+    }
+
+    delete ogreEnv;
+    return result;
+}
@@ -0,0 +1,119 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Compares MeshUtils::transformPositions with transforming each position through
+// Matrix4 and merging it into an AxisAlignedBox, for typical vertex strides.
+// Usage: MmTransformBench [vertex count]
+
+#include "MmBench.h"
+#include "MmMeshUtils.h"
+
+#include <OgreAxisAlignedBox.h>
+#include <OgreMatrix4.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Ogre;
+using namespace meshmagick;
+
+namespace
+{
+    AxisAlignedBox transformReference(float* positions, size_t count, size_t stride,
+        const Matrix4& transform, bool store)
+    {
+        AxisAlignedBox aabb;
+        unsigned char* data = reinterpret_cast<unsigned char*>(positions);
+        for (size_t i = 0; i < count; ++i, data += stride)
+        {
+            float* p = reinterpret_cast<float*>(data);
+            const Vector3 v = transform * Vector3(p[0], p[1], p[2]);
+            aabb.merge(v);
+            if (store)
+            {
+                p[0] = v.x;
+                p[1] = v.y;
+                p[2] = v.z;
+            }
+        }
+        return aabb;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1 << 20;
+    const int repeats = 7;
+    Matrix4 transform;
+    transform.makeTransform(Vector3(1.5f, -2.0f, 0.25f), Vector3(1.0f, 2.0f, 0.5f),
+        Quaternion(Degree(37), Vector3(0.3f, 1.0f, 0.2f).normalisedCopy()));
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+    const size_t strides[] = { 12, 16, 24, 32, 48, 64 };
+    std::printf("%zu vertices, ns per vertex\n", count);
+    std::printf("stride  old/bounds  new/bounds  old/store  new/store  max difference\n");
+    for (size_t s = 0; s < sizeof(strides) / sizeof(strides[0]); ++s)
+    {
+        const size_t stride = strides[s];
+        std::vector<unsigned char> original(count * stride);
+        for (size_t i = 0; i < count; ++i)
+        {
+            float* p = reinterpret_cast<float*>(&original[i * stride]);
+            p[0] = dist(rng);
+            p[1] = dist(rng);
+            p[2] = dist(rng);
+        }
+
+        std::vector<unsigned char> oldData = original;
+        std::vector<unsigned char> newData = original;
+        float* oldPositions = reinterpret_cast<float*>(&oldData[0]);
+        float* newPositions = reinterpret_cast<float*>(&newData[0]);
+        double seconds[4];
+        seconds[0] = bestOf(repeats, [&]() {
+            transformReference(oldPositions, count, stride, transform, false); });
+        seconds[1] = bestOf(repeats, [&]() {
+            MeshUtils::transformPositions(newPositions, count, stride, transform, false); });
+        seconds[2] = bestOf(repeats, [&]() {
+            oldData = original;
+            transformReference(oldPositions, count, stride, transform, true); });
+        seconds[3] = bestOf(repeats, [&]() {
+            newData = original;
+            MeshUtils::transformPositions(newPositions, count, stride, transform, true); });
+
+        // Matrix4 works in Real and divides by w, so small differences are expected.
+        float maxDifference = 0;
+        for (size_t i = 0; i < count * stride / sizeof(float); ++i)
+        {
+            maxDifference = std::max(maxDifference,
+                std::fabs(oldPositions[i] - newPositions[i]));
+        }
+
+        std::printf("%6zu", stride);
+        for (int i = 0; i < 4; ++i)
+        {
+            std::printf("  %10.2f", seconds[i] * 1e9 / count);
+        }
+        std::printf("  %g\n", maxDifference);
+    }
+    return 0;
+}
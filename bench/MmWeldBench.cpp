@@ -0,0 +1,121 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Compares the two duplicate vertex indices of OptimiseTool, the std::map used before
+// and UniqueVertexGrid, on unindexed grids where each vertex is shared by up to six
+// triangles.
+// Usage: MmWeldBench [largest grid size]
+
+#include "MmBench.h"
+#include "MmOptimiseTool.h"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace Ogre;
+using namespace meshmagick;
+
+namespace
+{
+    const float TOLERANCE = 1e-06f;
+
+    /// Gives access to OptimiseTool's vertex indices.
+    class WeldBench : public OptimiseTool
+    {
+    public:
+        typedef std::vector<UniqueVertex> VertexList;
+
+        /// Two triangles per quad of a size x size grid, three vertices of their own each.
+        static void makeGrid(size_t size, VertexList& vertices)
+        {
+            vertices.clear();
+            const size_t corners[6][2] = { {0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1} };
+            for (size_t y = 0; y < size; ++y)
+            {
+                for (size_t x = 0; x < size; ++x)
+                {
+                    for (int c = 0; c < 6; ++c)
+                    {
+                        UniqueVertex v;
+                        const Real u = static_cast<Real>(x + corners[c][0]) / size;
+                        const Real w = static_cast<Real>(y + corners[c][1]) / size;
+                        v.position = Vector3(u * 100, w * 100, 0);
+                        v.normal = Vector3::UNIT_Z;
+                        v.uv[0] = Vector4(u, w, 0, 0);
+                        vertices.push_back(v);
+                    }
+                }
+            }
+        }
+
+        static size_t weldWithMap(const VertexList& vertices)
+        {
+            UniqueVertexLess lessObj;
+            lessObj.pos_tolerance = lessObj.norm_tolerance = lessObj.uv_tolerance = TOLERANCE;
+            lessObj.uvSets = 1;
+            UniqueVertexMap map(lessObj);
+            uint32 unique = 0;
+            for (size_t i = 0; i < vertices.size(); ++i)
+            {
+                if (map.find(vertices[i]) == map.end())
+                {
+                    map[vertices[i]] = VertexInfo(static_cast<uint32>(i), unique++);
+                }
+            }
+            return unique;
+        }
+
+        static size_t weldWithGrid(const VertexList& vertices)
+        {
+            UniqueVertexGrid grid;
+            grid.reset(TOLERANCE, TOLERANCE, TOLERANCE, 1, vertices.size());
+            uint32 unique = 0;
+            for (size_t i = 0; i < vertices.size(); ++i)
+            {
+                uint32 index;
+                if (!grid.find(vertices[i], index))
+                {
+                    grid.insert(vertices[i], unique++);
+                }
+            }
+            return unique;
+        }
+    };
+}
+
+int main(int argc, char** argv)
+{
+    const size_t largest = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 400;
+    std::printf("  vertices    unique      map ms     grid ms\n");
+    WeldBench::VertexList vertices;
+    for (size_t size = 25; size <= largest; size *= 2)
+    {
+        WeldBench::makeGrid(size, vertices);
+        size_t uniqueMap = 0, uniqueGrid = 0;
+        const double mapSeconds = bestOf(3, [&]() {
+            uniqueMap = WeldBench::weldWithMap(vertices); });
+        const double gridSeconds = bestOf(3, [&]() {
+            uniqueGrid = WeldBench::weldWithGrid(vertices); });
+
+        std::printf("%10zu  %8zu  %10.2f  %10.2f%s\n", vertices.size(), uniqueGrid,
+            mapSeconds * 1e3, gridSeconds * 1e3,
+            uniqueMap != uniqueGrid ? "  (map found a different count)" : "");
+    }
+    return 0;
+}
@@ -29,10 +29,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "MmTool.h"
 #include "MmToolManager.h"
 
+#include "MmCompressTool.h"
 #include "MmInfoTool.h"
+#include "MmLodTool.h"
 #include "MmMeshMergeTool.h"
+#include "MmMeshletTool.h"
 #include "MmOptimiseTool.h"
+#include "MmPipelineTool.h"
 #include "MmRenameTool.h"
+#include "MmReorganiseTool.h"
 #include "MmTransformTool.h"
 
 namespace meshmagick
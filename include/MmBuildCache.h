@@ -0,0 +1,132 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_BUILD_CACHE_H__
+#define __MM_BUILD_CACHE_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreString.h>
+#	include <Ogre/OgreStringVector.h>
+#else
+#	include <OgreString.h>
+#	include <OgreStringVector.h>
+#endif
+
+#include "MmOptionsParser.h"
+
+#include <iostream>
+#include <map>
+#include <set>
+
+namespace meshmagick
+{
+    /** On-disk cache of tool results, so unchanged assets aren't processed again.
+    @par
+        An invocation is identified by a key computed from the tool name, the parsed tool
+        options, the global options affecting the result and the content of the input files.
+        While a tool runs, the files it reads (e.g. linked skeletons) and writes are recorded.
+        The written files are stored with the content hashes of the read ones. On a later
+        invocation with the same key the stored files are restored instead of running the
+        tool, as long as the files read back then are unchanged.
+    @par
+        Each entry is one file in the cache directory. When the cache grows beyond its size
+        limit, the least recently used entries are removed.
+    */
+    class _MeshMagickExport BuildCache
+    {
+    public:
+        struct Statistics
+        {
+            Ogre::uint64 hits;
+            Ogre::uint64 misses;
+            Ogre::uint64 stores;
+            Ogre::uint64 evictions;
+            size_t numEntries;
+            Ogre::uint64 size;
+        };
+
+        /// @param maxSize size limit of the cache directory content in bytes
+        BuildCache(const Ogre::String& directory, Ogre::uint64 maxSize);
+        ~BuildCache();
+
+        /// Returns the per user cache directory of the platform, "" if there is none.
+        static Ogre::String getDefaultDirectory();
+
+        const Ogre::String& getDirectory() const;
+
+        /// Computes the key of an invocation. Returns "" if an input file can't be read,
+        /// such invocations aren't cached.
+        Ogre::String computeKey(const Ogre::String& toolName, const OptionList& globalOptions,
+            const OptionList& toolOptions, const Ogre::StringVector& inFileNames,
+            const Ogre::StringVector& outFileNames);
+
+        /// Restores the files stored for key and returns their names. Returns false on a miss.
+        bool restore(const Ogre::String& key, Ogre::StringVector& restoredFiles);
+
+        /** Starts recording the files read and written until endRecording.
+        @par
+            The tool run in between reports its file accesses via the static notify functions.
+        */
+        void beginRecording(const Ogre::String& key);
+        /// Stops recording and stores the written files under the key given to beginRecording.
+        /// Nothing is stored if the tool wrote no file or warned.
+        void endRecording();
+        /// Stops recording without storing anything, e.g. when the tool failed.
+        void abortRecording();
+
+        static void notifyFileRead(const Ogre::String& fileName);
+        /// Same as above, when the content hash is known already.
+        static void notifyFileRead(const Ogre::String& fileName, Ogre::uint64 hash, size_t size);
+        static void notifyFileWritten(const Ogre::String& fileName);
+        static void notifyWarning();
+
+        Statistics getStatistics() const;
+        void printStatistics(std::ostream& out) const;
+
+    private:
+        struct FileInfo
+        {
+            Ogre::uint64 hash;
+            size_t size;
+        };
+        typedef std::map<Ogre::String, FileInfo> FileInfoMap;
+
+        Ogre::String mDirectory;
+        Ogre::uint64 mMaxSize;
+
+        /// Content of the input files, as hashed by computeKey.
+        FileInfoMap mInputFiles;
+
+        Ogre::String mRecordingKey;
+        FileInfoMap mFilesRead;
+        std::set<Ogre::String> mFilesWritten;
+        bool mWarned;
+
+        /// The cache recording the current invocation, if any.
+        static BuildCache* msRecordingCache;
+
+        Ogre::String getEntryFileName(const Ogre::String& key) const;
+        void store();
+        void evict();
+        void updateStatistics(int hits, int misses, int stores, int evictions) const;
+    };
+}
+#endif
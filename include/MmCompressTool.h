@@ -0,0 +1,128 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_COMPRESS_TOOL_H__
+#define __MM_COMPRESS_TOOL_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreMesh.h>
+#else
+#	include <OgreMesh.h>
+#endif
+
+#include <vector>
+
+#include "MmOptionsParser.h"
+#include "MmTool.h"
+
+namespace meshmagick
+{
+    /** Re-encodes float vertex attributes with smaller normalised integer types.
+    @par
+        Normals, tangents and binormals are packed into signed normalised bytes or into
+        an octahedral encoding with two signed normalised shorts. Texture coordinates
+        inside [0, 1] or [-1, 1] become 16 bit normalised integers. Positions can be stored
+        as signed normalised shorts relative to the mesh bounds, in which case the mesh has
+        to be scaled and translated back by whoever places it. The tool saves the scale and
+        translation next to the mesh, foo.mesh gets foo.quant with the lines
+        "scale x y z" and "offset x y z": position = stored position * scale + offset.
+    @par
+        Each attribute is only converted if the encoding error stays within its limit.
+        Compressed meshes need hardware skinning and vertex animation.
+    */
+    class _MeshMagickExport CompressTool : public Tool
+    {
+    public:
+        CompressTool();
+
+        Ogre::String getName() const;
+
+        /// Compresses vertex attributes of all vertex data in mesh.
+        /// @return the number of vertex buffer bytes saved.
+        size_t compress(Ogre::MeshPtr mesh);
+
+        /// Whether the last compress call quantised the positions. If so, the original
+        /// positions are the stored ones times getPositionScale plus getPositionOffset.
+        bool hasQuantisedPositions() const;
+        const Ogre::Vector3& getPositionScale() const;
+        const Ogre::Vector3& getPositionOffset() const;
+
+        /// Writes the scale and offset of the last compress call, see class description.
+        void writeQuantisationFile(const Ogre::String& fileName) const;
+
+    private:
+        enum DirectionEncoding
+        {
+            DE_KEEP,
+            DE_SNORM8,
+            DE_OCTAHEDRAL
+        };
+
+        DirectionEncoding mNormalEncoding;
+        DirectionEncoding mTangentEncoding;
+        bool mCompressTexCoords;
+        bool mCompressPositions;
+        /// Maximum angle in degrees between original and encoded directions.
+        Ogre::Real mDirectionErrorLimit;
+        /// Maximum absolute texture coordinate error.
+        Ogre::Real mTexCoordErrorLimit;
+        /// Maximum position error relative to the largest mesh extent.
+        Ogre::Real mPositionErrorLimit;
+
+        /// Positions are stored as (position - mPositionCenter) / mPositionScale.
+        Ogre::Vector3 mPositionCenter;
+        Ogre::Vector3 mPositionScale;
+        bool mPositionsQuantised;
+
+        void setOptions(const OptionList& toolOptions);
+        void processMeshFile(Ogre::String inFile, Ogre::String outFile);
+
+        size_t processVertexData(Ogre::VertexData* vertexData, bool compressPositions);
+
+        /** Encodes vertexElem of all vertices with a smaller type, if possible.
+        @param newType Receives the new element type.
+        @param encoded Receives the encoded elements, tightly packed.
+        @return false if the element is kept as it is.
+        */
+        bool encodeElement(Ogre::VertexData* vertexData, const Ogre::VertexElement& vertexElem,
+            bool compressPositions, Ogre::VertexElementType& newType,
+            std::vector<unsigned char>& encoded);
+
+        bool encodeDirections(const std::vector<float>& values, unsigned short components,
+            DirectionEncoding encoding, const Ogre::String& name,
+            Ogre::VertexElementType& newType, std::vector<unsigned char>& encoded);
+        bool encodeTexCoords(const std::vector<float>& values, const Ogre::String& name,
+            Ogre::VertexElementType& newType, std::vector<unsigned char>& encoded);
+        bool encodePositions(const std::vector<float>& values,
+            Ogre::VertexElementType& newType, std::vector<unsigned char>& encoded);
+
+        void doInvoke(const OptionList& toolOptions,
+            const Ogre::StringVector& inFileNames,
+            const Ogre::StringVector& outFileNames);
+
+        bool supportsLoadedMeshes() const;
+        bool writesSidecarFiles() const;
+        void doBeginLoadedMeshes(const OptionList& toolOptions);
+        bool doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFileName,
+            const Ogre::String& outFileName);
+    };
+}
+#endif
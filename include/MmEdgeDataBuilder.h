@@ -0,0 +1,57 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_EDGE_DATA_BUILDER_H__
+#define __MM_EDGE_DATA_BUILDER_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreMesh.h>
+#else
+#	include <OgreMesh.h>
+#endif
+
+namespace meshmagick
+{
+    /** Builds the edge lists used for stencil shadows, faster than Mesh::buildEdgeList.
+    @par
+        The result is the same as that of Ogre's EdgeListBuilder: vertices are shared by
+        exact position across all vertex data of a LOD level, degenerate triangles are
+        skipped and edges are connected to the first triangle using them in reverse order.
+        Vertices are looked up in an open addressing hash table and open edges in short
+        per vertex lists, instead of the ordered maps Ogre uses.
+    @par
+        Positions and triangles are read per vertex and index data, and LOD levels are
+        built, concurrently. Buffers are only read, but must not be locked elsewhere
+        meanwhile.
+    */
+    class _MeshMagickExport EdgeDataBuilder
+    {
+    public:
+        /** Replaces the edge lists of all LOD levels of mesh by newly built ones.
+        @remarks
+            Like Mesh::buildEdgeList, only triangle submeshes with edge building enabled
+            are included, and manual LOD levels use the edge list of their own mesh.
+        @param numThreads threads to use, 0 for one per hardware thread.
+        */
+        static void buildEdgeLists(Ogre::MeshPtr mesh, size_t numThreads = 0);
+    };
+}
+#endif
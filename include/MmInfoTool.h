@@ -54,9 +54,12 @@ namespace meshmagick
 		size_t numElements;
 		Ogre::String elementType;
 		size_t indexBitWidth;
+		/// Bytes saved by converting 32 bit index buffers (including LOD) to 16 bit.
+		size_t indexBytesSavable;
 
 		SubMeshInfo() : name(), materialName(), usesSharedVertices(false),
-			vertices(), operationType(), numElements(0), elementType(), indexBitWidth(16) {}
+			vertices(), operationType(), numElements(0), elementType(), indexBitWidth(16),
+			indexBytesSavable(0) {}
 	};
 
 	struct SkeletonInfo
@@ -77,6 +80,8 @@ namespace meshmagick
 
 		Ogre::AxisAlignedBox storedBoundingBox;
 		Ogre::AxisAlignedBox actualBoundingBox;
+		/// false if the vertices haven't been read, as with info -fast.
+		bool actualBoundingBoxValid;
 
 		bool hasEdgeList;
 		unsigned short numLodLevels;
@@ -105,6 +110,7 @@ namespace meshmagick
 		MeshInfo() : name(), version(), endian(),
 			storedBoundingBox(Ogre::AxisAlignedBox::BOX_NULL),
 			actualBoundingBox(Ogre::AxisAlignedBox::BOX_NULL),
+			actualBoundingBoxValid(false),
 			hasEdgeList(false), numLodLevels(0),
 			hasSharedVertices(false), sharedVertices(), submeshes(),
 			morphAnimations(), poseNames(),
@@ -124,16 +130,28 @@ namespace meshmagick
 		SkeletonInfo getInfo(Ogre::SkeletonPtr skeleton);
 
     private:
+        /// The options for loaded meshes.
+        OptionList mToolOptions;
+
         MeshInfo processMesh(const Ogre::String& meshFileName) const;
+        MeshInfo getLoadedMeshInfo(Ogre::MeshPtr mesh, const Ogre::String& meshFileName) const;
         void processMesh(MeshInfo& info, Ogre::MeshPtr mesh) const;
 
         SkeletonInfo processSkeleton(const Ogre::String& skeletonFileName) const;
         void processSkeleton(SkeletonInfo& info, Ogre::SkeletonPtr skeleton) const;
 
+        /// Fills MeshInfo by walking the chunks of the mesh file, without importing it.
+        MeshInfo scanMesh(const Ogre::String& meshFileName) const;
+        SkeletonInfo scanSkeleton(const Ogre::String& skeletonFileName) const;
+
         void processSubMesh(SubMeshInfo&, Ogre::SubMesh* subMesh) const;
+		void processOperationType(SubMeshInfo&, Ogre::RenderOperation::OperationType,
+			size_t numIndices) const;
+		void addSubMeshTotals(MeshInfo&, const SubMeshInfo&) const;
 		void processBoneAssignmentData(VertexInfo&, const Ogre::VertexData* vd,
 			const Ogre::Mesh::IndexMap& blendIndexToBoneIndexMap) const;
-		void processVertexDeclaration(VertexInfo&, const Ogre::VertexDeclaration* vd) const;
+		void processVertexDeclaration(VertexInfo&,
+			const Ogre::VertexDeclaration::VertexElementList& elementList) const;
 
 		void printMeshInfo(const OptionList& toolOptions, const MeshInfo& info) const;
 		void printSkeletonInfo(const OptionList& toolOptions, const SkeletonInfo& info) const;
@@ -153,6 +171,11 @@ namespace meshmagick
 
         void doInvoke(const OptionList& toolOptions,
             const Ogre::StringVector& inFileNames, const Ogre::StringVector& outFileNames);
+
+        bool supportsLoadedMeshes() const;
+        void doBeginLoadedMeshes(const OptionList& toolOptions);
+        bool doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFileName,
+            const Ogre::String& outFileName);
     };
 }
 #endif
@@ -40,6 +40,9 @@ namespace meshmagick
         virtual Ogre::String getToolDescription() const;
 
         virtual void printToolHelp(std::ostream& out) const;
+
+        // The result is printed, not written.
+        virtual bool isCacheable() const;
     };
 }
 #endif
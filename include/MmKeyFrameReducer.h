@@ -0,0 +1,85 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_KEY_FRAME_REDUCER_H__
+#define __MM_KEY_FRAME_REDUCER_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreAnimation.h>
+#	include <Ogre/OgreSkeleton.h>
+#else
+#	include <OgreAnimation.h>
+#	include <OgreSkeleton.h>
+#endif
+
+#include <vector>
+
+namespace meshmagick
+{
+    /** Finds node animation keys that can be dropped without changing the animation
+    by more than given tolerances.
+    @par
+        Keys are checked against the interpolation of the keys kept around them, the
+        same way Ogre interpolates linear animations. A key is only dropped if all keys
+        between its kept neighbours stay within the tolerances.
+    */
+    class _MeshMagickExport KeyFrameReducer
+    {
+    public:
+        /**
+        @param rotationError Maximum rotation error in degrees.
+        @param translationError Maximum translation error, relative to the bone's chain length.
+        @param scaleError Maximum absolute error of each scale component.
+        */
+        KeyFrameReducer(Ogre::Real rotationError, Ogre::Real translationError,
+            Ogre::Real scaleError);
+
+        /** Collects the indices of redundant keys of track in ascending order.
+        @remarks
+            Only reads track, so different tracks can be processed concurrently.
+        @param chainLength Length of the bone chain the track animates, scales the
+            translation error.
+        */
+        void findRedundantKeys(const Ogre::NodeAnimationTrack* track,
+            Ogre::Animation::RotationInterpolationMode rotationMode, Ogre::Real chainLength,
+            std::vector<unsigned short>& redundantKeys) const;
+
+        /** Length of the longest bone chain starting at each bone, indexed by bone handle.
+        @remarks
+            That is the bone's offset from its parent plus the longest chain of its children.
+            Bones without length, like roots at the origin without children, get the
+            length of the longest chain in the skeleton.
+        */
+        static std::vector<Ogre::Real> getChainLengths(Ogre::Skeleton* skeleton);
+
+    private:
+        Ogre::Real mRotationError;
+        Ogre::Real mTranslationError;
+        Ogre::Real mScaleError;
+
+        /// Whether all keys strictly between first and last are within tolerance of
+        /// the interpolation between first and last.
+        bool isSegmentRedundant(const Ogre::NodeAnimationTrack* track,
+            Ogre::Animation::RotationInterpolationMode rotationMode,
+            Ogre::Real translationError, unsigned short first, unsigned short last) const;
+    };
+}
+#endif
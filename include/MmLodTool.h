@@ -0,0 +1,111 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_LOD_TOOL_H__
+#define __MM_LOD_TOOL_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreMesh.h>
+#else
+#	include <OgreMesh.h>
+#endif
+
+#include <vector>
+
+#include "MmOptionsParser.h"
+#include "MmTool.h"
+
+namespace meshmagick
+{
+    /** Generates LOD levels by simplifying each submesh with MeshSimplifier.
+    @par
+        Each level keeps a fixed fraction of the triangles of the previous one and is
+        stored as a face list of the submesh, so all levels share the submesh's vertex
+        data. Existing LOD levels, manual ones included, are replaced.
+    */
+    class _MeshMagickExport LodTool : public Tool
+    {
+    public:
+        enum LodStrategyType
+        {
+            LS_DISTANCE,
+            LS_PIXEL_COUNT
+        };
+
+        LodTool();
+
+        Ogre::String getName() const;
+
+        /** Replaces the LOD levels of mesh.
+        @param values LOD strategy user values of the levels below the full detail mesh,
+            ascending distances or descending pixel counts.
+        */
+        void generateLods(Ogre::MeshPtr mesh, LodStrategyType strategy,
+            const std::vector<Ogre::Real>& values);
+
+    private:
+        /// Positions and skinning of a vertex data as seen by the simplifier.
+        struct VertexInput
+        {
+            std::vector<Ogre::Vector3> positions;
+            std::vector<Ogre::uint32> skinKeys;
+        };
+
+        struct SubMeshJob
+        {
+            Ogre::SubMesh* subMesh;
+            const VertexInput* input;
+            std::vector<Ogre::uint32> indices;
+            /// Triangle lists of the generated levels.
+            std::vector<std::vector<Ogre::uint32> > levels;
+        };
+
+        LodStrategyType mStrategy;
+        std::vector<Ogre::Real> mValues;
+        size_t mNumLevels;
+        /// Fraction of the triangles of a level removed in the next one.
+        Ogre::Real mReduction;
+        size_t mNumThreads;
+        bool mStripEdgeLists;
+
+        void setOptions(const OptionList& toolOptions);
+        void processMeshFile(Ogre::String inFile, Ogre::String outFile);
+
+        /// Default LOD values for mesh if none are given.
+        std::vector<Ogre::Real> getDefaultValues(Ogre::MeshPtr mesh) const;
+
+        void readVertexInput(Ogre::VertexData* vertexData,
+            const Ogre::Mesh::VertexBoneAssignmentList& boneAssignments,
+            VertexInput& input) const;
+
+        void simplify(SubMeshJob& job, size_t numLevels) const;
+
+        void doInvoke(const OptionList& toolOptions,
+            const Ogre::StringVector& inFileNames,
+            const Ogre::StringVector& outFileNames);
+
+        bool supportsLoadedMeshes() const;
+        void doBeginLoadedMeshes(const OptionList& toolOptions);
+        bool doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFileName,
+            const Ogre::String& outFileName);
+    };
+}
+#endif
@@ -0,0 +1,59 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_MAPPED_FILE_DATA_STREAM_H__
+#define __MM_MAPPED_FILE_DATA_STREAM_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreDataStream.h>
+#	include <Ogre/OgreString.h>
+#else
+#	include <OgreDataStream.h>
+#	include <OgreString.h>
+#endif
+
+namespace meshmagick
+{
+    /// Read-only DataStream over a memory mapped file.
+    /// Reads are plain copies out of the mapping, so the serializers pull a whole
+    /// buffer chunk with a single memcpy instead of going through an ifstream.
+    class _MeshMagickExport MappedFileDataStream : public Ogre::MemoryDataStream
+    {
+    public:
+        /// Maps the given file and returns a stream over it.
+        /// Throws std::ios_base::failure if the file can't be opened. Files that can't
+        /// be mapped (e.g. empty files) are read into memory instead.
+        static Ogre::DataStreamPtr open(const Ogre::String& fileName);
+
+        ~MappedFileDataStream();
+
+        void close();
+
+    private:
+        void* mMapping;
+        size_t mMappingSize;
+
+        MappedFileDataStream(const Ogre::String& fileName, void* mapping, size_t size);
+
+        void unmap();
+    };
+}
+#endif
@@ -44,8 +44,11 @@ namespace meshmagick
 		The tool is then reset to be able to merge the next batch of meshes.
 	@par
 		The merge tool creates a new SubMesh for each SubMesh of the Meshes you add.
-		Its functionality is pretty basic still. No submesh merging based on material.
-		Only one Mesh can have shared vertex data.
+		If submesh merging is enabled, triangle list SubMeshes with the same material
+		and vertex layout are concatenated into one afterwards.
+		Shared vertex data of all Meshes is concatenated, it must have the same layout.
+		Morph animations of shared vertices are removed once other shared vertices are
+		appended, their keyframes only cover the vertices they were made for.
 	 */
 	class _MeshMagickExport MeshMergeTool : public Tool
     {
@@ -69,11 +72,42 @@ namespace meshmagick
 		/// Clears the list of Meshes to be baked.
 		void reset();
 
+		/// Whether MeshMergeTool#merge merges SubMeshes sharing a material.
+		void setMergeSubmeshes(bool mergeSubmeshes);
+
+		/// Whether MeshMergeTool#merge builds edge lists, which only stencil shadows need.
+		void setBuildEdgeLists(bool buildEdgeLists);
+
 	private: 
 		Ogre::SkeletonPtr mBaseSkeleton;
 		std::vector<Ogre::MeshPtr> mMeshes;
+		bool mMergeSubmeshes;
+		bool mBuildEdgeLists;
 
 		const Ogre::String findSubmeshName(Ogre::MeshPtr m, Ogre::ushort sid) const;
+		/// Converts 16 bit index buffers to 32 bit where the vertex data has grown too large.
+		void widenIndexBuffers(Ogre::MeshPtr mesh);
+		/** Removes the morph tracks on mesh's shared vertices with a warning.
+		@remarks
+			Called before the shared vertices of another mesh are appended, morph keyframes
+			only hold the vertices there were before.
+		*/
+		void removeSharedMorphTracks(Ogre::MeshPtr mesh, const Ogre::String& appendedMeshName);
+		/** Copies source's poses into target.
+		@param subMeshBase index of source's first submesh in target.
+		@param sharedVertexBase index of source's first shared vertex in target.
+		@return the index in target of each of source's poses.
+		*/
+		std::vector<Ogre::ushort> mergePoses(Ogre::MeshPtr target, Ogre::MeshPtr source,
+			Ogre::ushort subMeshBase, size_t sharedVertexBase);
+		/// Copies source's vertex animation tracks into target, see MeshMergeTool#mergePoses.
+		void mergeVertexAnimations(Ogre::MeshPtr target, Ogre::MeshPtr source,
+			Ogre::ushort subMeshBase, size_t sharedVertexBase,
+			const std::vector<Ogre::ushort>& poseIndices);
+		/// Merges SubMeshes with the same material and vertex layout.
+		void mergeSubmeshesByMaterial(Ogre::MeshPtr mesh);
+		/// Appends vertices, indices and bone assignments of all submeshes to the first one.
+		void mergeSubmeshes(const std::vector<Ogre::SubMesh*>& submeshes);
 
 		void doInvoke(const OptionList& toolOptions,
 			const Ogre::StringVector& inFileNames,
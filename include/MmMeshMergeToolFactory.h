@@ -41,6 +41,9 @@ namespace meshmagick
         virtual Ogre::String getToolDescription() const;
 
         virtual void printToolHelp(std::ostream& out) const;
+
+        // All input files end up in one output mesh.
+        virtual bool processesFilesIndependently(const OptionList& globalOptions) const;
     };
 }
 #endif
@@ -0,0 +1,142 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_MESH_SIMPLIFIER_H__
+#define __MM_MESH_SIMPLIFIER_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#include <OgrePlatform.h>
+#include <OgreVector3.h>
+
+#include <vector>
+
+namespace meshmagick
+{
+    /** Reduces the triangle count of a triangle list with quadric error metrics.
+    @par
+        This follows Garland and Heckbert's "Surface Simplification Using Quadric Error
+        Metrics", restricted to half edge collapses: a vertex is always merged into one of
+        its neighbours, so only the indices change and the vertex data can be shared by
+        all LOD levels. Collapses are done in passes, each pass picks the cheapest
+        collapses not touching each other.
+    @par
+        Vertices sharing a position but differing in other attributes, as on UV seams and
+        normal creases, are only collapsed along the seam and together with their
+        sibling. Open borders only collapse along the border. Vertices only collapse into
+        vertices influenced by the same bones, which keeps skinning boundaries in place.
+    */
+    class _MeshMagickExport MeshSimplifier
+    {
+    public:
+        /**
+        @param positions Position of every vertex of the vertex data.
+        @param skinKeys Per vertex id of the set of bones influencing it, or empty for
+            unskinned vertex data.
+        @param indices The triangle list to simplify, all indices less than
+            positions.size().
+        */
+        MeshSimplifier(const std::vector<Ogre::Vector3>& positions,
+            const std::vector<Ogre::uint32>& skinKeys,
+            const std::vector<Ogre::uint32>& indices);
+
+        /** Collapses edges until at most targetTriangleCount triangles are left.
+        @remarks
+            Stops early if no further collapse is possible. Can be called repeatedly
+            with decreasing targets to generate successive LOD levels.
+        */
+        void simplify(size_t targetTriangleCount);
+
+        /// The current triangle list.
+        const std::vector<Ogre::uint32>& getIndices() const;
+
+        /// Number of triangles in the current triangle list.
+        size_t getTriangleCount() const;
+
+    private:
+        /// Symmetric 4x4 matrix measuring the squared distance to a set of planes.
+        struct Quadric
+        {
+            double a00, a11, a22, a10, a20, a21;
+            double b0, b1, b2;
+            double c;
+
+            Quadric();
+            Quadric(const Ogre::Vector3& normal, double d, double weight);
+            Quadric& operator+=(const Quadric& other);
+            double evaluate(const Ogre::Vector3& p) const;
+        };
+
+        enum VertexKind
+        {
+            VK_MANIFOLD,
+            VK_BORDER,
+            VK_SEAM,
+            VK_LOCKED
+        };
+
+        struct Collapse
+        {
+            Ogre::uint32 from;
+            Ogre::uint32 to;
+            /// Siblings collapsed along with a seam vertex, same as from and to otherwise.
+            Ogre::uint32 siblingFrom;
+            Ogre::uint32 siblingTo;
+            double cost;
+
+            bool operator<(const Collapse& other) const { return cost < other.cost; }
+        };
+
+        const std::vector<Ogre::Vector3>& mPositions;
+        const std::vector<Ogre::uint32>& mSkinKeys;
+        std::vector<Ogre::uint32> mIndices;
+
+        /// Lowest vertex index with the same position, identifies the position.
+        std::vector<Ogre::uint32> mCanonical;
+        /// Error quadrics, indexed by canonical vertex.
+        std::vector<Quadric> mQuadrics;
+
+        // Per pass topology, rebuilt from mIndices.
+        std::vector<VertexKind> mKinds;
+        /// Referenced vertices sorted by canonical vertex, mGroupStart[c] is the first one
+        /// of the canonical vertex c.
+        std::vector<Ogre::uint32> mGroupStart;
+        std::vector<Ogre::uint32> mGroupVertices;
+        /// Triangles using each canonical vertex, laid out like the groups.
+        std::vector<Ogre::uint32> mTriangleStart;
+        std::vector<Ogre::uint32> mVertexTriangles;
+        /// Number of triangles using each edge between canonical vertices.
+        std::vector<std::pair<Ogre::uint64, Ogre::uint32> > mEdgeCounts;
+        /// Edges between actual vertices.
+        std::vector<Ogre::uint64> mEdges;
+
+        void computeQuadrics();
+        void buildTopology();
+        /// Whether vertex k of the triangle starting at index t is the first one at its
+        /// position, degenerate triangles may use a position more than once.
+        bool isFirstOfPosition(size_t t, int k) const;
+        Ogre::uint32 getEdgeCount(Ogre::uint32 a, Ogre::uint32 b) const;
+        bool hasEdge(Ogre::uint32 a, Ogre::uint32 b) const;
+        bool getCollapse(Ogre::uint32 from, Ogre::uint32 to, Collapse& collapse) const;
+        bool hasTriangleFlip(const Collapse& collapse,
+            const std::vector<Ogre::uint32>& remap) const;
+        size_t applyCollapse(const Collapse& collapse, std::vector<Ogre::uint32>& remap);
+    };
+}
+#endif
@@ -24,6 +24,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <OgreMesh.h>
 
+#include <vector>
+
 namespace meshmagick
 {
     /// Utility class containing mesh related functions that may be useful for
@@ -36,6 +38,68 @@ namespace meshmagick
 
         static Ogre::AxisAlignedBox getVertexDataAabb(Ogre::VertexData* vd,
             const Ogre::Matrix4& transform = Ogre::Matrix4::IDENTITY);
+
+        /** Transforms count float3 positions stride bytes apart and returns their bounds.
+        @remarks
+            Affine transforms use SSE2 or AVX code where the CPU supports it, chosen once
+            at runtime, and keep the bounds in registers while going over the positions.
+            Every code path rounds the same way, the result doesn't depend on the CPU.
+        @param store whether to write the transformed positions back, otherwise only the
+            bounds are computed.
+        @return the bounds of the transformed positions, a null box if count is 0.
+        */
+        static Ogre::AxisAlignedBox transformPositions(float* positions, size_t count,
+            size_t stride, const Ogre::Matrix4& transform, bool store);
+
+        /// Reads the positions of all vertices in vd, whatever their element type.
+        static void getPositions(Ogre::VertexData* vd, std::vector<Ogre::Vector3>& positions);
+
+        /// Reads the indices referenced by id, widened to 32 bit.
+        static void getIndices(const Ogre::IndexData* id, std::vector<Ogre::uint32>& indices);
+
+        /// Overwrites the indices referenced by id. indices must have id->indexCount
+        /// elements, each fitting the index buffer's type.
+        static void setIndices(Ogre::IndexData* id, const std::vector<Ogre::uint32>& indices);
+
+        /// Smallest index type able to address vertexCount vertices.
+        static Ogre::HardwareIndexBuffer::IndexType getIndexType(size_t vertexCount);
+
+        /// true if id covers its whole index buffer, starting at the first index. Only then
+        /// can the buffer be replaced without touching other index data sharing it.
+        static bool coversIndexBuffer(const Ogre::IndexData* id);
+
+        /** Replaces id's index buffer by one of the given type holding the same indices.
+        @remarks
+            Only done if coversIndexBuffer(id) holds. Index data sharing a buffer with other
+            index data is left alone.
+        @return true if the index buffer was replaced.
+        */
+        static bool changeIndexType(Ogre::IndexData* id,
+            Ogre::HardwareIndexBuffer::IndexType type);
+
+        /** Decodes a single vertex element of any type into floats.
+        @remarks
+            Normalised types are mapped to [0, 1] or [-1, 1], packed colours to rgba in [0, 1].
+            Plain integer types keep their integer value. Unused components of out are
+            set to 0, so elements can be compared component-wise.
+        @param type the element's type.
+        @param src pointer to the element's data within the vertex.
+        @param out receives up to four decoded components.
+        @return the number of components decoded.
+        */
+        static unsigned short decodeVertexElement(Ogre::VertexElementType type,
+            const void* src, float out[4]);
+
+        /** Decodes count vertex elements of one type, stride bytes apart, see
+            decodeVertexElement.
+        @remarks
+            Float, 16 bit and 8 bit types are converted with SSE2 code where the CPU
+            supports it, chosen once at runtime. The result is the same as decoding each
+            element on its own.
+        @param out receives four floats per element.
+        */
+        static void decodeVertexElements(Ogre::VertexElementType type, const void* src,
+            size_t stride, size_t count, float* out);
     };
 }
 #endif
@@ -0,0 +1,82 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_MESHLET_BUILDER_H__
+#define __MM_MESHLET_BUILDER_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#include <OgrePlatform.h>
+#include <OgreVector3.h>
+
+#include <vector>
+
+namespace meshmagick
+{
+    /// A cluster of triangles, contiguous in the triangle list it was built from.
+    struct Meshlet
+    {
+        /// First index of the meshlet in the reordered triangle list.
+        size_t indexStart;
+        size_t triangleCount;
+        /// Number of distinct vertices used by the meshlet.
+        size_t vertexCount;
+
+        /// Bounding sphere.
+        Ogre::Vector3 center;
+        Ogre::Real radius;
+
+        /** Cone containing all triangle normals, for backface culling of the whole meshlet.
+        @remarks
+            All triangles face away from the camera if
+            dot(normalise(coneApex - cameraPosition), coneAxis) >= coneCutoff.
+            coneCutoff is 1 if the normals are spread too much for the test to be useful.
+        */
+        Ogre::Vector3 coneApex;
+        Ogre::Vector3 coneAxis;
+        Ogre::Real coneCutoff;
+    };
+
+    /** Splits a triangle list into meshlets of limited vertex and triangle count.
+    @par
+        Meshlets are grown greedily from a seed triangle, always adding the adjacent
+        triangle that needs the fewest new vertices. Preferring triangles whose vertices
+        have few unassigned triangles left keeps meshlets compact and avoids leaving
+        single triangles behind.
+    */
+    class _MeshMagickExport MeshletBuilder
+    {
+    public:
+        /** Builds meshlets and reorders indices so that each meshlet is contiguous.
+        @param positions Position of every vertex referenced by indices.
+        @param indices Triangle list, reordered in place.
+        @param maxVertices Maximum number of vertices in a meshlet, at least 3.
+        @param maxTriangles Maximum number of triangles in a meshlet, at least 1.
+        @param meshlets Receives the meshlets in index order.
+        */
+        static void build(const std::vector<Ogre::Vector3>& positions,
+            std::vector<Ogre::uint32>& indices, size_t maxVertices, size_t maxTriangles,
+            std::vector<Meshlet>& meshlets);
+
+    private:
+        static void computeBounds(const std::vector<Ogre::Vector3>& positions,
+            const std::vector<Ogre::uint32>& indices, Meshlet& meshlet);
+    };
+}
+#endif
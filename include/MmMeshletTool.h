@@ -0,0 +1,93 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_MESHLET_TOOL_H__
+#define __MM_MESHLET_TOOL_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreMesh.h>
+#else
+#	include <OgreMesh.h>
+#endif
+
+#include <vector>
+
+#include "MmMeshletBuilder.h"
+#include "MmOptionsParser.h"
+#include "MmTool.h"
+
+namespace meshmagick
+{
+    /** Splits submeshes into meshlets for per cluster culling.
+    @par
+        The triangles of each submesh are reordered so that every meshlet is a contiguous
+        range of its index buffer. The meshlet table is written to a sidecar file next to
+        the mesh, named like the mesh with the extension .meshlets.
+    @par
+        The sidecar file is binary, in native byte order:
+        - char[4] "MMCL", uint32 version (1), uint32 number of submesh tables
+        - per submesh table: uint32 submesh index, uint32 number of meshlets
+        - per meshlet: uint32 first index in the submesh's index buffer, uint32 triangle
+          count, uint32 vertex count, float[3] sphere center, float sphere radius,
+          float[3] cone apex, float[3] cone axis, float cone cutoff
+        See Meshlet for how to use the cone.
+    */
+    class _MeshMagickExport MeshletTool : public Tool
+    {
+    public:
+        /// Meshlets of one submesh.
+        struct SubMeshMeshlets
+        {
+            unsigned short subMeshIndex;
+            std::vector<Meshlet> meshlets;
+        };
+        typedef std::vector<SubMeshMeshlets> MeshletTable;
+
+        MeshletTool();
+
+        Ogre::String getName() const;
+
+        /// Builds meshlets for all triangle list submeshes of mesh, reordering their indices.
+        void buildMeshlets(Ogre::MeshPtr mesh, MeshletTable& table);
+
+        /// Writes table to fileName in the sidecar format.
+        void writeMeshletFile(const Ogre::String& fileName, const MeshletTable& table);
+
+    private:
+        size_t mMaxVertices;
+        size_t mMaxTriangles;
+        bool mStripEdgeLists;
+
+        void setOptions(const OptionList& toolOptions);
+        void processMeshFile(Ogre::String inFile, Ogre::String outFile);
+
+        void doInvoke(const OptionList& toolOptions,
+            const Ogre::StringVector& inFileNames,
+            const Ogre::StringVector& outFileNames);
+
+        bool supportsLoadedMeshes() const;
+        bool writesSidecarFiles() const;
+        void doBeginLoadedMeshes(const OptionList& toolOptions);
+        bool doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFileName,
+            const Ogre::String& outFileName);
+    };
+}
+#endif
@@ -53,7 +53,23 @@ namespace meshmagick
 		Ogre::Log* getLog() const;
 		bool isStandalone() const;
 
+		/** Releases the meshes and skeletons loaded so far.
+		 * Resources are registered by file name, so a file can only be loaded again
+		 * after this. In non-standalone mode, the managers belong to the host
+		 * application and only the serializers are reset.
+		 */
+		void releaseResources();
+
+		/** Releases what the last processed file left behind.
+		 * Resets the serializers and, in standalone mode, removes meshes, skeletons and
+		 * materials of the default resource group that nothing but Ogre's resource system
+		 * references anymore. Resources still in use, e.g. by the mesh merge tool, are kept.
+		 */
+		void releaseUnreferencedResources();
+
     private:
+        void removeUnreferencedResources(Ogre::ResourceManager* manager);
+
         Ogre::LogManager* mLogMgr;
         Ogre::LodStrategyManager* mLodMgr;
         Ogre::Log* mLog;
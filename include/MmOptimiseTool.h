@@ -27,7 +27,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <OgreSubMesh.h>
 #include <Ogre.h>
 
+#include <mutex>
+
 #include "MmOptionsParser.h"
+#include "MmSkeletonRegistry.h"
 #include "MmTool.h"
 
 namespace meshmagick
@@ -42,12 +45,29 @@ namespace meshmagick
 	protected:
 		float mPosTolerance, mNormTolerance, mUVTolerance;
 		bool mKeepIdentityTracks;
+		bool mStripEdgeLists;
+		bool mReduceKeyFrames;
+		/// Keyframe reduction tolerances, see KeyFrameReducer.
+		Ogre::Real mKeyRotationError, mKeyTranslationError, mKeyScaleError;
+		bool mUseWeldMap;
+		bool mOptimiseVertexCache;
+		bool mReorderVertexFetch;
+		bool mNarrowIndexBuffers;
+		size_t mNumThreads;
+		/// Serialises HardwareBufferManager access from concurrently running jobs.
+		std::mutex mBufferManagerMutex;
+
+		/// Skeletons linked by the processed meshes.
+		SkeletonRegistry mLinkedSkeletons;
 
+		void setOptions(const OptionList& toolOptions);
 		void processMeshFile(Ogre::String file, Ogre::String outFile);
-		void processSkeletonFile(Ogre::String file, Ogre::String outFile);
+		bool processSkeletonFile(Ogre::String file, Ogre::String outFile);
+		void processLinkedSkeletons(const Ogre::StringVector& inFileNames);
 
 		void processMesh(Ogre::MeshPtr mesh);
 		void processSkeleton(Ogre::SkeletonPtr skeleton);
+		void reduceKeyFrames(Ogre::SkeletonPtr skeleton);
 
 		struct IndexInfo
 		{
@@ -59,7 +79,6 @@ namespace meshmagick
 		};
 		/** Mapping from original vertex index to new (potentially shared) vertex index */
 		typedef std::vector<IndexInfo> IndexRemap;
-		IndexRemap mIndexRemap;
 
 		struct UniqueVertex
 		{
@@ -67,15 +86,23 @@ namespace meshmagick
 			Ogre::Vector3 normal;
 			Ogre::Vector4 tangent;
 			Ogre::Vector3 binormal;
-			Ogre::Vector3 uv[OGRE_MAX_TEXTURE_COORD_SETS];
+			Ogre::Vector4 uv[OGRE_MAX_TEXTURE_COORD_SETS];
+			Ogre::Vector4 diffuse;
+			Ogre::Vector4 specular;
+			Ogre::Vector4 blendWeights;
+			Ogre::Vector4 blendIndices;
 
 			UniqueVertex()
 				: position(Ogre::Vector3::ZERO),
 				  normal(Ogre::Vector3::ZERO),
 				  tangent(Ogre::Vector4::ZERO),
-				  binormal(Ogre::Vector3::ZERO)
+				  binormal(Ogre::Vector3::ZERO),
+				  diffuse(Ogre::Vector4::ZERO),
+				  specular(Ogre::Vector4::ZERO),
+				  blendWeights(Ogre::Vector4::ZERO),
+				  blendIndices(Ogre::Vector4::ZERO)
 			{
-				memset(uv, 0, sizeof(Ogre::Vector3) * OGRE_MAX_TEXTURE_COORD_SETS);
+				memset(uv, 0, sizeof(Ogre::Vector4) * OGRE_MAX_TEXTURE_COORD_SETS);
 			}
 
 		};
@@ -101,33 +128,130 @@ namespace meshmagick
 			VertexInfo() {}
 
 		};
-		/** Map used to efficiently look up vertices that have the same components.
+		/** Map used to look up vertices that have the same components.
 		The second element is the source vertex info.
+		@note Only used with -weld-index=map, kept for comparison with UniqueVertexGrid.
+		UniqueVertexLess is no strict weak ordering, so results can depend on insertion order.
 		*/
 		typedef std::map<UniqueVertex, VertexInfo, UniqueVertexLess> UniqueVertexMap;
-		UniqueVertexMap mUniqueVertexMap;
+
+		/** Spatial hash used to efficiently look up vertices that have the same components.
+		@par
+			Vertices are bucketed by their position quantised to the position tolerance, so
+			every vertex within tolerance of a queried one lies in one of the 27 cells around
+			the query's cell. Only those are compared component-wise. If several vertices
+			match, the one inserted first wins, which keeps the result independent of
+			hash table layout. Lookup and insertion are expected constant time.
+		*/
+		class UniqueVertexGrid
+		{
+		public:
+			UniqueVertexGrid();
+
+			/// Clears the grid and sizes it for up to vertexCount unique vertices.
+			void reset(float posTolerance, float normTolerance, float uvTolerance,
+				unsigned short uvSets, size_t vertexCount);
+			/// Looks up a vertex equal to v within tolerance, returns true if one was found.
+			bool find(const UniqueVertex& v, Ogre::uint32& newIndex) const;
+			/// Adds v as unique vertex newIndex. Indices must be added in ascending order.
+			void insert(const UniqueVertex& v, Ogre::uint32 newIndex);
+
+		private:
+			struct CellKey
+			{
+				Ogre::int64 x, y, z;
+				bool operator==(const CellKey& rhs) const
+				{
+					return x == rhs.x && y == rhs.y && z == rhs.z;
+				}
+			};
+			struct Cell
+			{
+				CellKey key;
+				/// First and last vertex in this cell, chained through mNext. ~0 if unused.
+				Ogre::uint32 head, tail;
+			};
+			static const Ogre::uint32 NO_VERTEX = 0xffffffff;
+
+			float mPosTolerance, mNormTolerance, mUVTolerance;
+			unsigned short mUVSets;
+			double mInvCellSize;
+			std::vector<Cell> mCells;
+			size_t mCellMask;
+			std::vector<UniqueVertex> mVertices;
+			std::vector<Ogre::uint32> mNext;
+
+			CellKey getCellKey(const Ogre::Vector3& pos) const;
+			size_t findCell(const CellKey& key) const;
+			bool equals(const UniqueVertex& a, const UniqueVertex& b) const;
+			static bool equals(const Ogre::Vector4& a, const Ogre::Vector4& b,
+				Ogre::Real tolerance);
+		};
 		/** Ordered list of unique vertices used to write the final reorganised vertex buffer
 		*/
 		typedef std::vector<VertexInfo> UniqueVertexList;
-		UniqueVertexList mUniqueVertexList;
-
-		Ogre::VertexData* mTargetVertexData;
-		typedef std::list<Ogre::IndexData*> IndexDataList;
-		IndexDataList mIndexDataList;
-
-		void setTargetVertexData(Ogre::VertexData* vd);
-		void addIndexData(Ogre::IndexData* id);
-		bool optimiseGeometry();
-		bool calculateDuplicateVertices();
-		void rebuildVertexBuffers();
-		void remapIndexDataList();
-		void remapIndexes(Ogre::IndexData* idata);
-		Ogre::Mesh::VertexBoneAssignmentList getAdjustedBoneAssignments(
+
+		typedef std::vector<Ogre::SubMesh*> SubMeshList;
+
+		/** State for optimising one VertexData and the submeshes referencing it.
+		@par
+			Jobs for different vertex data share nothing, so OptimiseTool::processMesh
+			runs them concurrently. Output is collected in the job and printed in job
+			order once all jobs are done.
+		*/
+		struct GeometryJob
+		{
+			Ogre::VertexData* targetVertexData;
+			/// Submeshes whose index data (including LOD) references targetVertexData.
+			SubMeshList subMeshes;
+			IndexRemap indexRemap;
+			UniqueVertexMap uniqueVertexMap;
+			UniqueVertexGrid uniqueVertexGrid;
+			UniqueVertexList uniqueVertexList;
+			/// Whether the vertex data changed and dependent data has to be fixed.
+			bool optimised;
+			/// Whether triangle order changed.
+			bool reordered;
+			std::vector<std::pair<Ogre::String, Verbosity> > messages;
+
+			explicit GeometryJob(Ogre::VertexData* vd) : targetVertexData(vd), optimised(false), reordered(false) {}
+			void print(const Ogre::String& msg, Verbosity verbosity = V_NORMAL)
+			{
+				messages.push_back(std::make_pair(msg, verbosity));
+			}
+		};
+
+		bool optimiseGeometry(GeometryJob& job);
+		bool calculateDuplicateVertices(GeometryJob& job);
+		/// Removes triangles using a welded vertex twice or having no area from all
+		/// triangle lists, returns the number removed.
+		size_t removeDegenerateTriangles(GeometryJob& job);
+		/// Removes welded vertices no index data refers to from the unique vertex list,
+		/// returns the number removed.
+		size_t removeUnreferencedVertices(GeometryJob& job);
+		void rebuildVertexBuffers(GeometryJob& job);
+		void remapIndexDataList(GeometryJob& job);
+		void optimiseVertexCache(GeometryJob& job);
+		/// Renumbers vertices by first use in the index data, returns false if already in order.
+		bool reorderVertexFetch(GeometryJob& job);
+		/// Converts 32 bit index buffers to 16 bit if possible, returns true if any was.
+		bool narrowIndexBuffers(GeometryJob& job);
+		void remapIndexes(const GeometryJob& job, Ogre::IndexData* idata);
+		Ogre::Mesh::VertexBoneAssignmentList getAdjustedBoneAssignments(const GeometryJob& job,
 			Ogre::Mesh::BoneAssignmentIterator& it);
-        void fixLOD(Ogre::SubMesh::LODFaceList lodFaces);
+		void fixBoneAssignments(const GeometryJob& job, Ogre::Mesh* mesh);
+		void fixBoneAssignments(const GeometryJob& job, Ogre::SubMesh* sm);
+		void fixPoses(const GeometryJob& job, Ogre::Mesh* mesh, unsigned short target);
+		void fixMorphKeyFrames(const GeometryJob& job, Ogre::Mesh* mesh, unsigned short target);
 
 		void doInvoke(const OptionList& toolOptions,
 			const Ogre::StringVector& inFileNames, const Ogre::StringVector& outFileNames);
+
+		bool supportsLoadedMeshes() const;
+		void doBeginLoadedMeshes(const OptionList& toolOptions);
+		bool doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFileName,
+			const Ogre::String& outFileName);
+		void doEndLoadedMeshes();
 	};
 }
 #endif
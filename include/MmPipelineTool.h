@@ -0,0 +1,80 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_PIPELINE_TOOL_H__
+#define __MM_PIPELINE_TOOL_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreMesh.h>
+#else
+#	include <OgreMesh.h>
+#endif
+
+#include <vector>
+
+#include "MmOptionsParser.h"
+#include "MmTool.h"
+
+namespace meshmagick
+{
+    class ToolManager;
+
+    /** Runs several tools on a mesh, loading it once and saving it once.
+    @par
+        The stages are given like "transform -scale=2/2/2 | optimise | info", each stage
+        is a tool name followed by its options. Every mesh is loaded, handed through the
+        stages in order and saved, unless no stage modified it. Only tools supporting
+        loaded meshes can be stages, see Tool::supportsLoadedMeshes.
+    @par
+        Skeletons linked by the meshes are processed by each stage after all meshes are done.
+    */
+    class _MeshMagickExport PipelineTool : public Tool
+    {
+    public:
+        PipelineTool(ToolManager& toolManager);
+
+        Ogre::String getName() const;
+
+    private:
+        struct Stage
+        {
+            Ogre::String name;
+            OptionList options;
+            Tool* tool;
+        };
+        typedef std::vector<Stage> StageList;
+
+        ToolManager& mToolManager;
+
+        /// Parses the stage description and creates the stage's tools.
+        /// The caller has to destroy the tools with destroyStages.
+        void createStages(const Ogre::String& description, StageList& stages);
+        void destroyStages(StageList& stages);
+
+        void processMeshFile(const StageList& stages, const Ogre::String& inFile,
+            const Ogre::String& outFile);
+
+        void doInvoke(const OptionList& toolOptions,
+            const Ogre::StringVector& inFileNames,
+            const Ogre::StringVector& outFileNames);
+    };
+}
+#endif
@@ -0,0 +1,73 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_PROCESS_POOL_H__
+#define __MM_PROCESS_POOL_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreStringVector.h>
+#else
+#	include <OgreStringVector.h>
+#endif
+
+#include <iostream>
+#include <vector>
+
+namespace meshmagick
+{
+    /** Runs commands as child processes, a bounded number of them at a time.
+    @par
+        This is the ThreadPool counterpart for work that can't share one Ogre environment,
+        like processing several files with the same tool. Each child's stdout and stderr
+        are buffered and written in the order the commands were added, once all earlier
+        commands are done, so the output doesn't depend on scheduling.
+    @par
+        Only available on POSIX systems, see isSupported().
+    */
+    class _MeshMagickExport ProcessPool
+    {
+    public:
+        /// Creates a pool running up to numProcesses commands at a time.
+        /// 0 means one process per hardware thread.
+        explicit ProcessPool(size_t numProcesses = 0);
+
+        size_t getNumProcesses() const;
+
+        /// Adds a command. arguments[0] is the program, which is looked up in PATH,
+        /// if it doesn't contain a slash.
+        void addCommand(const Ogre::StringVector& arguments);
+
+        /** Runs all commands added so far and returns when they are done.
+        @return
+            Number of commands that failed, either because they couldn't be started
+            or because they exited with a non-zero status.
+        */
+        size_t run(std::ostream& out = std::cout, std::ostream& err = std::cerr);
+
+        /// Whether child processes can be run on this platform.
+        static bool isSupported();
+
+    private:
+        size_t mNumProcesses;
+        std::vector<Ogre::StringVector> mCommands;
+    };
+}
+#endif
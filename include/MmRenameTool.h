@@ -40,13 +40,22 @@ namespace meshmagick
 				const Ogre::StringVector& inFileNames,
 				const Ogre::StringVector& outFileNames);
 
+		bool supportsLoadedMeshes() const;
+		void doBeginLoadedMeshes(const OptionList& toolOptions);
+		bool doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFileName,
+				const Ogre::String& outFileName);
+
 	private:
 		typedef std::pair<Ogre::String, Ogre::String> StringPair;
 
+		/// The options for loaded meshes.
+		OptionList mToolOptions;
+
 		void processMeshFile(
 			const OptionList &toolOptions, Ogre::String inFile, Ogre::String outFile);
 		void processSkeletonFile(
 			const OptionList &toolOptions, Ogre::String inFile, Ogre::String outFile);
+		void processMesh(const OptionList &toolOptions, Ogre::MeshPtr mesh);
 		StringPair split(const Ogre::String& value) const;
 	};
 
@@ -0,0 +1,99 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_REORGANISE_TOOL_H__
+#define __MM_REORGANISE_TOOL_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreMesh.h>
+#else
+#	include <OgreMesh.h>
+#endif
+
+#include <vector>
+
+#include "MmOptionsParser.h"
+#include "MmTool.h"
+
+namespace meshmagick
+{
+    /** Rearranges vertex elements into the buffers given by a layout string.
+    @par
+        The layout uses the syntax of the layout strings printed by the info tool. Each
+        letter stands for an element semantic, a hyphen starts the next buffer. The n-th
+        occurrence of a letter refers to the element of that semantic with index n.
+        A '*' stands for all elements not listed otherwise. Without it, those are appended
+        to the last buffer. "p-*" puts positions into a buffer of their own and interleaves
+        everything else in a second buffer.
+    @par
+        Element types are kept, vertex order is not changed. Indices, bone assignments,
+        poses and morph keyframes, which hold their own position buffers, stay valid.
+    */
+    class _MeshMagickExport ReorganiseTool : public Tool
+    {
+    public:
+        ReorganiseTool();
+
+        Ogre::String getName() const;
+
+        /// Sets the target layout, fails if it cannot be parsed.
+        void setLayout(const Ogre::String& layout);
+
+        /// Reorganises all vertex data of mesh.
+        /// @return the number of vertex data whose layout was changed.
+        size_t reorganise(Ogre::MeshPtr mesh);
+
+    private:
+        struct LayoutElement
+        {
+            Ogre::VertexElementSemantic semantic;
+            unsigned short index;
+            /// Type code given in the layout, like "f3", empty if none was given.
+            Ogre::String type;
+            /// Placeholder for all elements not listed in the layout.
+            bool isRest;
+        };
+        typedef std::vector<LayoutElement> BufferLayout;
+
+        std::vector<BufferLayout> mLayout;
+
+        void setOptions(const OptionList& toolOptions);
+        void processMeshFile(Ogre::String inFile, Ogre::String outFile);
+
+        /** Rebuilds vertexData's declaration and buffers according to mLayout.
+        @param animationType how the vertex data is animated.
+        @param animationIncludesNormals whether the vertex animation animates normals too.
+        @return false if the layout is already in place or cannot be applied.
+        */
+        bool processVertexData(Ogre::VertexData* vertexData,
+            Ogre::VertexAnimationType animationType, bool animationIncludesNormals);
+
+        void doInvoke(const OptionList& toolOptions,
+            const Ogre::StringVector& inFileNames,
+            const Ogre::StringVector& outFileNames);
+
+        bool supportsLoadedMeshes() const;
+        void doBeginLoadedMeshes(const OptionList& toolOptions);
+        bool doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFileName,
+            const Ogre::String& outFileName);
+    };
+}
+#endif
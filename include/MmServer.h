@@ -0,0 +1,75 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_SERVER_H__
+#define __MM_SERVER_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreString.h>
+#else
+#	include <OgreString.h>
+#endif
+
+#include "MmOptionsParser.h"
+
+#include <iostream>
+
+namespace meshmagick
+{
+    class ToolManager;
+
+    /** Runs tool invocations sent as newline delimited JSON in one warm Ogre environment.
+    @par
+        Every request is a JSON object on a line of its own, like
+        {"id": 7, "tool": "optimise", "global": ["-quiet"], "options": ["-threads=1"],
+        "in": ["a.mesh"], "out": ["b.mesh"]}
+        Only "tool" and "in" are required, "global" and "options" are given as on the
+        command line. {"shutdown": true} stops the server.
+    @par
+        Every request is answered by one line
+        {"id": 7, "status": "ok", "stdout": "...", "stderr": "..."}
+        where "id" is copied from the request. Failed requests have status "error" and
+        a "message". Meshes and skeletons are released after each request.
+    */
+    class _MeshMagickExport Server
+    {
+    public:
+        Server(ToolManager& toolManager, const OptionDefinitionSet& globalOptionDefs);
+
+        /// Answers requests read from in until the end of input or a shutdown request.
+        void serve(std::istream& in, std::ostream& out);
+
+        /// Listens on a unix domain socket created at path and serves one connection
+        /// at a time, until a shutdown request. Not available on Windows.
+        void serveSocket(const Ogre::String& path);
+
+        /// Handles a single request line and returns the response line.
+        Ogre::String handleRequest(const Ogre::String& request);
+
+        bool isShutdownRequested() const;
+
+    private:
+        ToolManager& mToolManager;
+        OptionDefinitionSet mGlobalOptionDefs;
+        bool mShutdownRequested;
+    };
+}
+#endif
@@ -0,0 +1,90 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_SKELETON_REGISTRY_H__
+#define __MM_SKELETON_REGISTRY_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreString.h>
+#	include <Ogre/OgreStringVector.h>
+#else
+#	include <OgreString.h>
+#	include <OgreStringVector.h>
+#endif
+
+#include <map>
+#include <vector>
+
+namespace meshmagick
+{
+    /** Collects the skeleton files linked by the meshes of one tool invocation.
+    @par
+        Many meshes often share one skeleton. Instead of processing it once per mesh, tools
+        register the link here and process every entry once after all meshes are done.
+        Files are identified by their resolved path. Copies with the same content under
+        different paths share an entry as well, so they are loaded and processed once and
+        saved to each of their paths.
+    */
+    class _MeshMagickExport SkeletonRegistry
+    {
+    public:
+        struct Entry
+        {
+            /// The files of this entry, in the order they were registered.
+            Ogre::StringVector fileNames;
+            /// How the first referencing mesh wants the skeleton processed.
+            Ogre::String settings;
+
+            Ogre::uint64 contentHash;
+            size_t contentSize;
+        };
+
+        /** Registers a skeleton file and returns the index of its entry.
+        @param fileName the skeleton file as linked from the mesh
+        @param settings describes how the referencing mesh wants the skeleton processed, e.g.
+            the transformation. Copies of the same content only share an entry when their
+            settings match.
+        @param conflict set to true, if the file is already registered with other settings.
+            The settings of the first registration are kept in this case.
+        */
+        size_t add(const Ogre::String& fileName, const Ogre::String& settings, bool& conflict);
+
+        /// Returns whether the file has been registered, by resolved path.
+        bool contains(const Ogre::String& fileName) const;
+
+        size_t getNumEntries() const;
+        const Entry& getEntry(size_t index) const;
+
+        void clear();
+
+        /// Returns the absolute path of the file with symbolic links resolved,
+        /// or fileName itself if that is not possible.
+        static Ogre::String resolvePath(const Ogre::String& fileName);
+
+    private:
+        std::vector<Entry> mEntries;
+        /// Entry index by resolved path.
+        std::map<Ogre::String, size_t> mEntryIndices;
+
+        static bool hasSameContent(const Ogre::String& fileName1, const Ogre::String& fileName2);
+    };
+}
+#endif
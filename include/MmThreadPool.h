@@ -0,0 +1,83 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MM_THREAD_POOL_H__
+#define __MM_THREAD_POOL_H__
+
+#include "MeshMagickPrerequisites.h"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace meshmagick
+{
+    /** Fixed set of worker threads used to run independent tasks concurrently.
+    @par
+        run() hands out task indices to the workers and the calling thread until all
+        are done. Tasks must not touch shared state without their own synchronisation,
+        Ogre's managers are not thread safe in a default Ogre build.
+        run() is not reentrant, a task must not call run() on the same pool.
+    */
+    class _MeshMagickExport ThreadPool
+    {
+    public:
+        /// Creates a pool using numThreads threads in total, including the calling one.
+        /// 0 means one thread per hardware thread.
+        explicit ThreadPool(size_t numThreads = 0);
+        ~ThreadPool();
+
+        size_t getNumThreads() const;
+
+        /** Calls task(i) for every i in [0, count) and returns when all calls are done.
+        @par
+            If tasks throw, the remaining tasks are still run and the first exception
+            is rethrown afterwards.
+        */
+        void run(size_t count, const std::function<void(size_t)>& task);
+
+        /// Returns the number of hardware threads, at least 1.
+        static size_t getHardwareThreadCount();
+
+    private:
+        std::vector<std::thread> mWorkers;
+        std::mutex mMutex;
+        std::condition_variable mWorkAvailable;
+        std::condition_variable mWorkDone;
+
+        const std::function<void(size_t)>* mTask;
+        size_t mTaskCount;
+        size_t mNextTask;
+        size_t mBusyWorkers;
+        unsigned int mGeneration;
+        bool mShutdown;
+        std::exception_ptr mError;
+
+        ThreadPool(const ThreadPool&);
+        ThreadPool& operator=(const ThreadPool&);
+
+        void workerLoop();
+        /// Runs tasks until none are left. Expects mMutex to be locked by lock.
+        void runTasks(std::unique_lock<std::mutex>& lock);
+    };
+}
+#endif
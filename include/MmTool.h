@@ -23,8 +23,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "MeshMagickPrerequisites.h"
 
 #ifdef __APPLE__
+#	include <Ogre/OgreMesh.h>
 #	include <Ogre/OgreStringVector.h>
 #else
+#	include <OgreMesh.h>
 #	include <OgreStringVector.h>
 #endif
 
@@ -45,20 +47,44 @@ namespace meshmagick
         void invoke(const OptionList& globalOptions, const OptionList& toolOptions,
             const Ogre::StringVector& inFileNames, const Ogre::StringVector& outFileNames);
 
+        /** Whether the tool can work on meshes loaded by the caller, as the pipeline tool does.
+        @par
+            Then beginLoadedMeshes is called once with the options, processLoadedMesh for each
+            mesh and endLoadedMeshes after the last one. The caller loads and saves the meshes,
+            the file names are only given for messages and files written next to the mesh.
+        */
+        virtual bool supportsLoadedMeshes() const;
+        void beginLoadedMeshes(const OptionList& globalOptions, const OptionList& toolOptions);
+        /// Returns whether the mesh has been modified.
+        bool processLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFileName,
+            const Ogre::String& outFileName);
+        void endLoadedMeshes();
+        /// Whether processLoadedMesh writes files describing the mesh next to it, e.g.
+        /// meshlet tables. Depends on the options given to beginLoadedMeshes.
+        virtual bool writesSidecarFiles() const;
+
     protected:
         typedef enum {V_QUIET, V_NORMAL, V_HIGH} Verbosity;
         Verbosity mVerbosity;
         bool mFollowSkeletonLink;
+        OptionList mGlobalOptions;
 
         void print(const Ogre::String& msg, Verbosity verbosity=V_NORMAL,
 			std::ostream& out = std::cout) const;
         void warn(const Ogre::String& msg) const;
         void fail(const Ogre::String& msg) const;
+        /// Frees the resources of the file processed last, call after each file.
+        void releaseFileResources() const;
 
         virtual void doInvoke(const OptionList& toolOptions,
             const Ogre::StringVector& inFileNames,
             const Ogre::StringVector& outFileNames) = 0;
 
+        virtual void doBeginLoadedMeshes(const OptionList& toolOptions);
+        virtual bool doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFileName,
+            const Ogre::String& outFileName);
+        virtual void doEndLoadedMeshes();
+
     private:
         void setGlobalOptions(const OptionList& globalOptions);
     };
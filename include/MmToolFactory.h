@@ -41,6 +41,23 @@ namespace meshmagick
         virtual Ogre::String getToolDescription() const = 0;
 
         virtual void printToolHelp(std::ostream& out) const = 0;
+
+        // Returns whether the tool handles each input file on its own. If so, several
+        // files can be processed concurrently by separate invocations (global -jobs option).
+        // Tools writing files other than the output of each input, which several inputs may
+        // share (e.g. linked skeletons), must return false, at least for the global options
+        // that make them do so. Separate invocations would write those files concurrently.
+        virtual bool processesFilesIndependently(const OptionList& globalOptions) const
+        {
+            return true;
+        }
+
+        // Returns whether the result of the tool is just the files it writes, so that the
+        // build cache can restore them instead of invoking the tool again.
+        virtual bool isCacheable() const
+        {
+            return true;
+        }
     };
 }
 #endif
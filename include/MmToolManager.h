@@ -33,11 +33,17 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 namespace meshmagick
 {
+    class BuildCache;
+
     class _MeshMagickExport ToolManager
     {
     public:
+        ToolManager();
         ~ToolManager();
 
+        /// Invokes the named tool. With a build cache set, the files written by an earlier
+        /// invocation on the same input are restored instead, unless the global option
+        /// no-cache is set.
         void invokeTool(const Ogre::String& name, const OptionList& globalOptions,
             int toolArgc, const char** toolArgV,
             const Ogre::StringVector& inFileNames, const Ogre::StringVector& outFileNames);
@@ -45,15 +51,26 @@ namespace meshmagick
 		Tool* createTool(const Ogre::String& name);
         void destroyTool(Tool*);
 
+        /// Parses the arguments of the named tool into its options.
+        OptionList parseToolOptions(const Ogre::String& name, int toolArgc,
+            const char** toolArgV) const;
+
         void printToolList(std::ostream& out) const;
         void printToolHelp(const Ogre::String& toolName, std::ostream& out) const;
+        bool processesFilesIndependently(const Ogre::String& toolName,
+            const OptionList& globalOptions) const;
 
         void registerToolFactory(ToolFactory* factory);
         void unregisterToolFactory(ToolFactory* factory);
 
+        /// Sets the build cache used by invokeTool, NULL to disable caching.
+        /// The cache is not owned by the manager.
+        void setBuildCache(BuildCache* cache);
+
     private:
         typedef std::map<Ogre::String, ToolFactory*> FactoryMap;
         FactoryMap mFactories;
+        BuildCache* mBuildCache;
     };
 }
 #endif
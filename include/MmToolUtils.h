@@ -69,6 +69,16 @@ namespace meshmagick
         /// if not found there, "" is returned.
         static Ogre::String getSkeletonFileName(const Ogre::MeshPtr, const Ogre::String& meshFileName);
 
+        /// Returns the name of a file stored next to the given mesh file, with the .mesh
+        /// extension replaced by extension, e.g. foo.mesh -> foo.meshlets. Names without
+        /// .mesh extension get extension appended.
+        static Ogre::String getSidecarFileName(const Ogre::String& meshFileName,
+            const Ogre::String& extension);
+
+        /// Computes the 64 bit FNV-1a hash of the file content and sets size to the file size.
+        /// Returns false if the file can't be read.
+        static bool hashFile(const Ogre::String& fileName, Ogre::uint64& hash, size_t& size);
+
     };
 }
 #endif
@@ -35,8 +35,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #endif
 
 #include "MmOptionsParser.h"
+#include "MmSkeletonRegistry.h"
 #include "MmTool.h"
 
+#include <vector>
+
 namespace meshmagick
 {
     class _MeshMagickExport TransformTool : public Tool
@@ -56,10 +59,14 @@ namespace meshmagick
         bool mUpdateBoundingBox;
         bool mFlipVertexWinding;
         OptionList mOptions;
+        /// Skeletons linked by the processed meshes and the transform for each entry.
+        SkeletonRegistry mLinkedSkeletons;
+        std::vector<Ogre::Matrix4> mLinkedSkeletonTransforms;
 
-        void processSkeletonFile(Ogre::String file, Ogre::String outFile,
+        bool processSkeletonFile(Ogre::String file, Ogre::String outFile,
             bool calcTransform);
         void processMeshFile(Ogre::String file, Ogre::String outFile);
+        void processLinkedSkeletons(const Ogre::StringVector& inFileNames);
 
         void processSkeleton(Ogre::SkeletonPtr skeleton);
         void processMesh(Ogre::MeshPtr mesh);
@@ -91,6 +98,12 @@ namespace meshmagick
 		void doInvoke(const OptionList& toolOptions,
             const Ogre::StringVector& inFileNames,
             const Ogre::StringVector& outFileNames);
+
+        bool supportsLoadedMeshes() const;
+        void doBeginLoadedMeshes(const OptionList& toolOptions);
+        bool doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFileName,
+            const Ogre::String& outFileName);
+        void doEndLoadedMeshes();
     };
 }
 #endif
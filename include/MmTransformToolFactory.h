@@ -41,6 +41,9 @@ namespace meshmagick
         virtual Ogre::String getToolDescription() const;
 
         virtual void printToolHelp(std::ostream& out) const;
+
+        // Linked skeletons are shared by the meshes and processed once after all of them.
+        virtual bool processesFilesIndependently(const OptionList& globalOptions) const;
     };
 }
 #endif
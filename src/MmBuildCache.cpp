@@ -0,0 +1,780 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmBuildCache.h"
+
+#include "MmToolUtils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#   include <direct.h>
+#   include <sys/types.h>
+#   include <sys/utime.h>
+#else
+#   include <dirent.h>
+#   include <sys/stat.h>
+#   include <sys/types.h>
+#   include <unistd.h>
+#   include <utime.h>
+#endif
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    namespace
+    {
+        const char ENTRY_MAGIC[8] = {'M', 'M', 'C', 'A', 'C', 'H', 'E', '1'};
+        const String ENTRY_EXTENSION = ".mmc";
+        const String STATISTICS_FILE_NAME = "statistics";
+
+        /// Global options that don't change the files a tool writes.
+        const char* const NEUTRAL_GLOBAL_OPTIONS[] = {"cache-dir", "cache-size", "cache-stats",
+            "jobs", "no-cache", "quiet", "verbose"};
+
+        /// Incremental 64 bit FNV-1a hash.
+        class Hasher
+        {
+        public:
+            Hasher() : mHash(14695981039346656037ULL) {}
+
+            void add(const void* data, size_t size)
+            {
+                const unsigned char* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    mHash = (mHash ^ bytes[i]) * 1099511628211ULL;
+                }
+            }
+
+            void add(uint64 value)
+            {
+                unsigned char bytes[8];
+                for (int i = 0; i < 8; ++i)
+                {
+                    bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+                }
+                add(bytes, 8);
+            }
+
+            // The length goes first, so that consecutive strings can't run into each other.
+            void add(const String& value)
+            {
+                add(static_cast<uint64>(value.size()));
+                add(value.data(), value.size());
+            }
+
+            uint64 getHash() const
+            {
+                return mHash;
+            }
+
+        private:
+            uint64 mHash;
+        };
+
+        /// Formats an option value exactly, so that different values never give the same text.
+        /// Returns false for types the option parser doesn't produce.
+        bool getOptionValueString(const Any& value, String& valueString)
+        {
+            std::ostringstream os;
+            os << std::setprecision(17);
+            try
+            {
+                os << "b" << any_cast<bool>(value);
+                valueString = os.str();
+                return true;
+            }
+            catch (...) {}
+            try
+            {
+                os << "i" << any_cast<int>(value);
+                valueString = os.str();
+                return true;
+            }
+            catch (...) {}
+            try
+            {
+                os << "r" << any_cast<Real>(value);
+                valueString = os.str();
+                return true;
+            }
+            catch (...) {}
+            try
+            {
+                os << "s" << any_cast<String>(value);
+                valueString = os.str();
+                return true;
+            }
+            catch (...) {}
+            try
+            {
+                Vector3 v = any_cast<Vector3>(value);
+                os << "v" << v.x << "/" << v.y << "/" << v.z;
+                valueString = os.str();
+                return true;
+            }
+            catch (...) {}
+            try
+            {
+                Quaternion q = any_cast<Quaternion>(value);
+                os << "q" << q.w << "/" << q.x << "/" << q.y << "/" << q.z;
+                valueString = os.str();
+                return true;
+            }
+            catch (...) {}
+            return false;
+        }
+
+        void writeUInt64(std::ostream& out, uint64 value)
+        {
+            char bytes[8];
+            for (int i = 0; i < 8; ++i)
+            {
+                bytes[i] = static_cast<char>(value >> (8 * i));
+            }
+            out.write(bytes, 8);
+        }
+
+        bool readUInt64(std::istream& in, uint64& value)
+        {
+            unsigned char bytes[8];
+            if (!in.read(reinterpret_cast<char*>(bytes), 8))
+            {
+                return false;
+            }
+            value = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                value |= static_cast<uint64>(bytes[i]) << (8 * i);
+            }
+            return true;
+        }
+
+        void writeString(std::ostream& out, const String& value)
+        {
+            writeUInt64(out, value.size());
+            out.write(value.data(), value.size());
+        }
+
+        bool readString(std::istream& in, String& value, uint64 maxSize)
+        {
+            uint64 size;
+            if (!readUInt64(in, size) || size > maxSize)
+            {
+                return false;
+            }
+            value.resize(static_cast<size_t>(size));
+            return size == 0 || in.read(&value[0], static_cast<std::streamsize>(size));
+        }
+
+        bool readFile(const String& fileName, String& content)
+        {
+            std::ifstream in(fileName.c_str(), std::ios_base::in | std::ios_base::binary);
+            if (!in)
+            {
+                return false;
+            }
+            std::ostringstream os;
+            os << in.rdbuf();
+            content = os.str();
+            return !in.bad();
+        }
+
+        unsigned long getProcessId()
+        {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+            return GetCurrentProcessId();
+#else
+            return static_cast<unsigned long>(getpid());
+#endif
+        }
+
+        /// Writes to a temporary file first, so that concurrent invocations never see a
+        /// partially written file.
+        bool writeFile(const String& fileName, const String& content)
+        {
+            std::ostringstream os;
+            os << fileName << ".tmp" << getProcessId();
+            String tempFileName = os.str();
+            {
+                std::ofstream out(tempFileName.c_str(),
+                    std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+                if (!out)
+                {
+                    return false;
+                }
+                out.write(content.data(), content.size());
+                if (!out)
+                {
+                    out.close();
+                    std::remove(tempFileName.c_str());
+                    return false;
+                }
+            }
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+            // rename doesn't replace existing files here.
+            std::remove(fileName.c_str());
+#endif
+            if (std::rename(tempFileName.c_str(), fileName.c_str()) != 0)
+            {
+                std::remove(tempFileName.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        String getCurrentDirectory()
+        {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+            char buffer[MAX_PATH];
+            return _getcwd(buffer, MAX_PATH) != NULL ? String(buffer) : String();
+#else
+            std::vector<char> buffer(4096);
+            return getcwd(&buffer[0], buffer.size()) != NULL ? String(&buffer[0]) : String();
+#endif
+        }
+
+        void createDirectories(const String& path)
+        {
+            for (size_t pos = 1; pos <= path.size(); ++pos)
+            {
+                if (pos == path.size() || path[pos] == '/' || path[pos] == '\\')
+                {
+                    String dir = path.substr(0, pos);
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+                    _mkdir(dir.c_str());
+#else
+                    mkdir(dir.c_str(), 0777);
+#endif
+                }
+            }
+        }
+
+        struct EntryFile
+        {
+            String fileName;
+            uint64 size;
+            uint64 lastUse;
+
+            bool operator<(const EntryFile& rhs) const
+            {
+                return lastUse < rhs.lastUse;
+            }
+        };
+
+        std::vector<EntryFile> listEntryFiles(const String& directory)
+        {
+            std::vector<EntryFile> entryFiles;
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+            WIN32_FIND_DATAA findData;
+            HANDLE find = FindFirstFileA((directory + "\\*" + ENTRY_EXTENSION).c_str(), &findData);
+            if (find == INVALID_HANDLE_VALUE)
+            {
+                return entryFiles;
+            }
+            do
+            {
+                EntryFile entryFile;
+                entryFile.fileName = directory + "\\" + findData.cFileName;
+                entryFile.size = (static_cast<uint64>(findData.nFileSizeHigh) << 32)
+                    | findData.nFileSizeLow;
+                entryFile.lastUse = (static_cast<uint64>(findData.ftLastWriteTime.dwHighDateTime) << 32)
+                    | findData.ftLastWriteTime.dwLowDateTime;
+                entryFiles.push_back(entryFile);
+            }
+            while (FindNextFileA(find, &findData));
+            FindClose(find);
+#else
+            DIR* dir = opendir(directory.c_str());
+            if (dir == NULL)
+            {
+                return entryFiles;
+            }
+            while (struct dirent* dirEntry = readdir(dir))
+            {
+                String name = dirEntry->d_name;
+                if (!StringUtil::endsWith(name, ENTRY_EXTENSION, false))
+                {
+                    continue;
+                }
+                EntryFile entryFile;
+                entryFile.fileName = directory + "/" + name;
+                struct stat st;
+                if (stat(entryFile.fileName.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+                {
+                    entryFile.size = static_cast<uint64>(st.st_size);
+                    // Seconds alone can't order the entries of a quick batch.
+#ifdef __APPLE__
+                    entryFile.lastUse = static_cast<uint64>(st.st_mtimespec.tv_sec) * 1000000000ULL
+                        + st.st_mtimespec.tv_nsec;
+#else
+                    entryFile.lastUse = static_cast<uint64>(st.st_mtim.tv_sec) * 1000000000ULL
+                        + st.st_mtim.tv_nsec;
+#endif
+                    entryFiles.push_back(entryFile);
+                }
+            }
+            closedir(dir);
+#endif
+            return entryFiles;
+        }
+
+        void readCounters(const String& fileName, BuildCache::Statistics& statistics)
+        {
+            std::ifstream in(fileName.c_str());
+            String name;
+            uint64 value;
+            while (in >> name >> value)
+            {
+                if (name == "hits")
+                {
+                    statistics.hits = value;
+                }
+                else if (name == "misses")
+                {
+                    statistics.misses = value;
+                }
+                else if (name == "stores")
+                {
+                    statistics.stores = value;
+                }
+                else if (name == "evictions")
+                {
+                    statistics.evictions = value;
+                }
+            }
+        }
+
+        /// Marks the entry as used now, eviction goes by modification time.
+        void touchFile(const String& fileName)
+        {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+            _utime(fileName.c_str(), NULL);
+#else
+            utime(fileName.c_str(), NULL);
+#endif
+        }
+    }
+
+    BuildCache* BuildCache::msRecordingCache = NULL;
+
+    BuildCache::BuildCache(const String& directory, uint64 maxSize)
+        : mDirectory(directory), mMaxSize(maxSize), mWarned(false)
+    {
+        createDirectories(mDirectory);
+    }
+
+    BuildCache::~BuildCache()
+    {
+        if (msRecordingCache == this)
+        {
+            msRecordingCache = NULL;
+        }
+    }
+
+    String BuildCache::getDefaultDirectory()
+    {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+        const char* localAppData = std::getenv("LOCALAPPDATA");
+        if (localAppData != NULL && *localAppData != '\0')
+        {
+            return String(localAppData) + "\\meshmagick";
+        }
+#else
+        const char* cacheHome = std::getenv("XDG_CACHE_HOME");
+        if (cacheHome != NULL && *cacheHome != '\0')
+        {
+            return String(cacheHome) + "/meshmagick";
+        }
+        const char* home = std::getenv("HOME");
+        if (home != NULL && *home != '\0')
+        {
+            return String(home) + "/.cache/meshmagick";
+        }
+#endif
+        return "";
+    }
+
+    const String& BuildCache::getDirectory() const
+    {
+        return mDirectory;
+    }
+
+    String BuildCache::computeKey(const String& toolName, const OptionList& globalOptions,
+        const OptionList& toolOptions, const StringVector& inFileNames,
+        const StringVector& outFileNames)
+    {
+        mInputFiles.clear();
+
+        Hasher hasher;
+        hasher.add(String(ENTRY_MAGIC, sizeof(ENTRY_MAGIC)));
+        // Other versions may well write other files.
+        hasher.add(static_cast<uint64>(MESHMAGICK_VERSION_MAJOR));
+        hasher.add(static_cast<uint64>(MESHMAGICK_VERSION_MINOR));
+        hasher.add(static_cast<uint64>(MESHMAGICK_VERSION_PATCH));
+        hasher.add(static_cast<uint64>(OGRE_VERSION));
+        hasher.add(toolName);
+        // Relative file names are resolved against it, linked skeletons included.
+        hasher.add(getCurrentDirectory());
+
+        const char* const* neutralEnd = NEUTRAL_GLOBAL_OPTIONS
+            + sizeof(NEUTRAL_GLOBAL_OPTIONS) / sizeof(NEUTRAL_GLOBAL_OPTIONS[0]);
+        for (OptionList::const_iterator it = globalOptions.begin(); it != globalOptions.end(); ++it)
+        {
+            if (std::find(NEUTRAL_GLOBAL_OPTIONS, neutralEnd, it->first) != neutralEnd)
+            {
+                continue;
+            }
+            String valueString;
+            if (!getOptionValueString(it->second, valueString))
+            {
+                return "";
+            }
+            hasher.add(it->first);
+            hasher.add(valueString);
+        }
+
+        hasher.add(static_cast<uint64>(toolOptions.size()));
+        for (OptionList::const_iterator it = toolOptions.begin(); it != toolOptions.end(); ++it)
+        {
+            String valueString;
+            if (!getOptionValueString(it->second, valueString))
+            {
+                return "";
+            }
+            hasher.add(it->first);
+            hasher.add(valueString);
+        }
+
+        hasher.add(static_cast<uint64>(inFileNames.size()));
+        for (size_t i = 0; i < inFileNames.size(); ++i)
+        {
+            FileInfo info;
+            if (!ToolUtils::hashFile(inFileNames[i], info.hash, info.size))
+            {
+                mInputFiles.clear();
+                return "";
+            }
+            mInputFiles[inFileNames[i]] = info;
+            hasher.add(inFileNames[i]);
+            hasher.add(info.hash);
+            hasher.add(static_cast<uint64>(info.size));
+        }
+
+        hasher.add(static_cast<uint64>(outFileNames.size()));
+        for (size_t i = 0; i < outFileNames.size(); ++i)
+        {
+            hasher.add(outFileNames[i]);
+        }
+
+        std::ostringstream os;
+        os << std::hex << std::setw(16) << std::setfill('0') << hasher.getHash();
+        return os.str();
+    }
+
+    bool BuildCache::restore(const String& key, StringVector& restoredFiles)
+    {
+        restoredFiles.clear();
+        String entryFileName = getEntryFileName(key);
+        std::ifstream in(entryFileName.c_str(), std::ios_base::in | std::ios_base::binary);
+        if (!in)
+        {
+            updateStatistics(0, 1, 0, 0);
+            return false;
+        }
+
+        // Sanity limit for lengths read from the entry, a damaged entry is just a miss.
+        const uint64 maxSize = mMaxSize;
+        char magic[sizeof(ENTRY_MAGIC)];
+        uint64 numFilesRead = 0;
+        bool valid = in.read(magic, sizeof(magic))
+            && std::equal(magic, magic + sizeof(magic), ENTRY_MAGIC)
+            && readUInt64(in, numFilesRead);
+
+        bool unchanged = true;
+        for (uint64 i = 0; valid && unchanged && i < numFilesRead; ++i)
+        {
+            String fileName;
+            uint64 hash, size;
+            valid = readString(in, fileName, maxSize) && readUInt64(in, hash)
+                && readUInt64(in, size);
+            if (valid)
+            {
+                FileInfo info;
+                FileInfoMap::const_iterator it = mInputFiles.find(fileName);
+                if (it != mInputFiles.end())
+                {
+                    info = it->second;
+                }
+                else if (!ToolUtils::hashFile(fileName, info.hash, info.size))
+                {
+                    unchanged = false;
+                    break;
+                }
+                unchanged = info.hash == hash && info.size == size;
+            }
+        }
+
+        // Read everything before writing anything, so a damaged entry can't leave
+        // half of the files restored.
+        std::vector<std::pair<String, String> > filesWritten;
+        if (valid && unchanged)
+        {
+            uint64 numFilesWritten = 0;
+            valid = readUInt64(in, numFilesWritten);
+            for (uint64 i = 0; valid && i < numFilesWritten; ++i)
+            {
+                filesWritten.push_back(std::make_pair(String(), String()));
+                valid = readString(in, filesWritten.back().first, maxSize)
+                    && readString(in, filesWritten.back().second, maxSize);
+            }
+        }
+        in.close();
+
+        if (!valid)
+        {
+            std::remove(entryFileName.c_str());
+        }
+        if (!valid || !unchanged)
+        {
+            updateStatistics(0, 1, 0, 0);
+            return false;
+        }
+
+        for (size_t i = 0; i < filesWritten.size(); ++i)
+        {
+            if (!writeFile(filesWritten[i].first, filesWritten[i].second))
+            {
+                throw std::ios_base::failure(("cannot write file " + filesWritten[i].first).c_str());
+            }
+            restoredFiles.push_back(filesWritten[i].first);
+        }
+        touchFile(entryFileName);
+        updateStatistics(1, 0, 0, 0);
+        return true;
+    }
+
+    void BuildCache::beginRecording(const String& key)
+    {
+        mRecordingKey = key;
+        mFilesRead = mInputFiles;
+        mFilesWritten.clear();
+        mWarned = false;
+        msRecordingCache = this;
+    }
+
+    void BuildCache::endRecording()
+    {
+        if (msRecordingCache == this)
+        {
+            msRecordingCache = NULL;
+            if (!mWarned && !mFilesWritten.empty())
+            {
+                store();
+                evict();
+            }
+        }
+    }
+
+    void BuildCache::abortRecording()
+    {
+        if (msRecordingCache == this)
+        {
+            msRecordingCache = NULL;
+        }
+    }
+
+    void BuildCache::notifyFileRead(const String& fileName)
+    {
+        if (msRecordingCache != NULL
+            && msRecordingCache->mFilesRead.find(fileName) == msRecordingCache->mFilesRead.end())
+        {
+            FileInfo info;
+            if (ToolUtils::hashFile(fileName, info.hash, info.size))
+            {
+                msRecordingCache->mFilesRead[fileName] = info;
+            }
+        }
+    }
+
+    void BuildCache::notifyFileRead(const String& fileName, uint64 hash, size_t size)
+    {
+        if (msRecordingCache != NULL
+            && msRecordingCache->mFilesRead.find(fileName) == msRecordingCache->mFilesRead.end())
+        {
+            FileInfo info;
+            info.hash = hash;
+            info.size = size;
+            msRecordingCache->mFilesRead[fileName] = info;
+        }
+    }
+
+    void BuildCache::notifyFileWritten(const String& fileName)
+    {
+        if (msRecordingCache != NULL)
+        {
+            msRecordingCache->mFilesWritten.insert(fileName);
+        }
+    }
+
+    void BuildCache::notifyWarning()
+    {
+        if (msRecordingCache != NULL)
+        {
+            msRecordingCache->mWarned = true;
+        }
+    }
+
+    BuildCache::Statistics BuildCache::getStatistics() const
+    {
+        Statistics statistics;
+        statistics.hits = 0;
+        statistics.misses = 0;
+        statistics.stores = 0;
+        statistics.evictions = 0;
+        statistics.numEntries = 0;
+        statistics.size = 0;
+
+        readCounters(mDirectory + "/" + STATISTICS_FILE_NAME, statistics);
+
+        std::vector<EntryFile> entryFiles = listEntryFiles(mDirectory);
+        statistics.numEntries = entryFiles.size();
+        for (size_t i = 0; i < entryFiles.size(); ++i)
+        {
+            statistics.size += entryFiles[i].size;
+        }
+        return statistics;
+    }
+
+    void BuildCache::printStatistics(std::ostream& out) const
+    {
+        Statistics statistics = getStatistics();
+        uint64 lookups = statistics.hits + statistics.misses;
+        const Real mb = 1024.0f * 1024.0f;
+        Real hitRate = lookups > 0 ? 100.0f * statistics.hits / lookups : 0.0f;
+        out << "Build cache " << mDirectory << std::endl;
+        out << "entries   : " << statistics.numEntries << std::endl;
+        out << "size      : " << StringConverter::toString(statistics.size / mb, 1, 0, ' ',
+            std::ios::fixed) << " MB of " << StringConverter::toString(mMaxSize / mb, 1, 0, ' ',
+            std::ios::fixed) << " MB" << std::endl;
+        out << "hits      : " << statistics.hits << std::endl;
+        out << "misses    : " << statistics.misses << std::endl;
+        out << "hit rate  : " << StringConverter::toString(hitRate, 1, 0, ' ', std::ios::fixed)
+            << "%" << std::endl;
+        out << "stores    : " << statistics.stores << std::endl;
+        out << "evictions : " << statistics.evictions << std::endl;
+    }
+
+    String BuildCache::getEntryFileName(const String& key) const
+    {
+        return mDirectory + "/" + key + ENTRY_EXTENSION;
+    }
+
+    void BuildCache::store()
+    {
+        std::ostringstream out(std::ios_base::out | std::ios_base::binary);
+        out.write(ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+        writeUInt64(out, mFilesRead.size());
+        for (FileInfoMap::const_iterator it = mFilesRead.begin(); it != mFilesRead.end(); ++it)
+        {
+            writeString(out, it->first);
+            writeUInt64(out, it->second.hash);
+            writeUInt64(out, it->second.size);
+        }
+        writeUInt64(out, mFilesWritten.size());
+        for (std::set<String>::const_iterator it = mFilesWritten.begin();
+            it != mFilesWritten.end(); ++it)
+        {
+            String content;
+            if (!readFile(*it, content))
+            {
+                return;
+            }
+            writeString(out, *it);
+            writeString(out, content);
+        }
+
+        String entry = out.str();
+        // An entry that doesn't fit would only push everything else out.
+        if (entry.size() <= mMaxSize && writeFile(getEntryFileName(mRecordingKey), entry))
+        {
+            updateStatistics(0, 0, 1, 0);
+        }
+    }
+
+    void BuildCache::evict()
+    {
+        std::vector<EntryFile> entryFiles = listEntryFiles(mDirectory);
+        uint64 size = 0;
+        for (size_t i = 0; i < entryFiles.size(); ++i)
+        {
+            size += entryFiles[i].size;
+        }
+        if (size <= mMaxSize)
+        {
+            return;
+        }
+
+        std::sort(entryFiles.begin(), entryFiles.end());
+        int numEvicted = 0;
+        for (size_t i = 0; i < entryFiles.size() && size > mMaxSize; ++i)
+        {
+            // Another process may have removed it already.
+            if (std::remove(entryFiles[i].fileName.c_str()) == 0)
+            {
+                ++numEvicted;
+            }
+            size -= entryFiles[i].size;
+        }
+        updateStatistics(0, 0, 0, numEvicted);
+    }
+
+    void BuildCache::updateStatistics(int hits, int misses, int stores, int evictions) const
+    {
+        // Concurrent invocations may lose an update now and then, good enough for statistics.
+        Statistics statistics;
+        statistics.hits = 0;
+        statistics.misses = 0;
+        statistics.stores = 0;
+        statistics.evictions = 0;
+        readCounters(mDirectory + "/" + STATISTICS_FILE_NAME, statistics);
+
+        std::ostringstream out;
+        out << "hits " << statistics.hits + hits << "\n"
+            << "misses " << statistics.misses + misses << "\n"
+            << "stores " << statistics.stores + stores << "\n"
+            << "evictions " << statistics.evictions + evictions << "\n";
+        writeFile(mDirectory + "/" + STATISTICS_FILE_NAME, out.str());
+    }
+}
@@ -0,0 +1,684 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmCompressTool.h"
+
+#include <OgreHardwareBufferManager.h>
+#include <OgreStringConverter.h>
+#include <OgreSubMesh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+#include "MmBuildCache.h"
+#include "MmMeshUtils.h"
+#include "MmOgreEnvironment.h"
+#include "MmStatefulMeshSerializer.h"
+#include "MmToolUtils.h"
+
+using namespace Ogre;
+
+// Normalised integer vertex element types were introduced with Ogre 1.10.
+#if OGRE_VERSION >= 0x10A00
+#define MM_HAS_NORMALISED_VERTEX_ELEMENTS
+#endif
+
+namespace
+{
+    /// Converts v in [lo, 1] to a normalised integer with 1 mapped to maxValue.
+    template <typename T>
+    T encodeNormalised(float v, float lo, float maxValue)
+    {
+        const float clamped = std::max(lo, std::min(1.0f, v));
+        return static_cast<T>(std::floor(clamped * maxValue + 0.5f));
+    }
+
+    float decodeNormalised(float q, float maxValue)
+    {
+        return std::max(-1.0f, q / maxValue);
+    }
+
+    float sign(float v)
+    {
+        return v < 0.0f ? -1.0f : 1.0f;
+    }
+
+    /// Maps a direction onto the octahedron and unfolds it into [-1, 1]^2.
+    void encodeOctahedral(const Vector3& dir, float& u, float& v)
+    {
+        const float l1 = std::abs(dir.x) + std::abs(dir.y) + std::abs(dir.z);
+        if (l1 == 0.0f)
+        {
+            u = v = 0.0f;
+            return;
+        }
+
+        u = dir.x / l1;
+        v = dir.y / l1;
+        if (dir.z < 0.0f)
+        {
+            const float pu = u;
+            u = (1.0f - std::abs(v)) * sign(pu);
+            v = (1.0f - std::abs(pu)) * sign(v);
+        }
+    }
+
+    Vector3 decodeOctahedral(float u, float v)
+    {
+        Vector3 dir(u, v, 1.0f - std::abs(u) - std::abs(v));
+        if (dir.z < 0.0f)
+        {
+            dir.x = (1.0f - std::abs(v)) * sign(u);
+            dir.y = (1.0f - std::abs(u)) * sign(v);
+        }
+        return dir.normalisedCopy();
+    }
+
+    /// Angle between two directions in degrees, 0 if one of them has no length.
+    float getAngle(const Vector3& a, const Vector3& b)
+    {
+        const Real lengths = a.length() * b.length();
+        if (lengths == 0)
+        {
+            return 0.0f;
+        }
+        const Real cosine = std::max(Real(-1), std::min(Real(1), a.dotProduct(b) / lengths));
+        return static_cast<float>(Radian(std::acos(cosine)).valueDegrees());
+    }
+}
+
+namespace meshmagick
+{
+    CompressTool::CompressTool()
+        : mNormalEncoding(DE_SNORM8),
+          mTangentEncoding(DE_SNORM8),
+          mCompressTexCoords(true),
+          mCompressPositions(false),
+          mDirectionErrorLimit(1.0),
+          mTexCoordErrorLimit(1e-4),
+          mPositionErrorLimit(1e-4),
+          mPositionCenter(Vector3::ZERO),
+          mPositionScale(Vector3::UNIT_SCALE),
+          mPositionsQuantised(false)
+    {
+    }
+
+    Ogre::String CompressTool::getName() const
+    {
+        return "compress";
+    }
+
+    void CompressTool::setOptions(const OptionList& toolOptions)
+    {
+#ifndef MM_HAS_NORMALISED_VERTEX_ELEMENTS
+        fail("compress needs normalised vertex element types, which Ogre has since 1.10.");
+#endif
+        const String normals = OptionsUtil::getStringOption(toolOptions, "normals", "snorm8");
+        mNormalEncoding = normals == "keep" ? DE_KEEP :
+            normals == "octahedral" ? DE_OCTAHEDRAL : DE_SNORM8;
+        mTangentEncoding =
+            OptionsUtil::getStringOption(toolOptions, "tangents", "snorm8") == "keep" ?
+            DE_KEEP : DE_SNORM8;
+        mCompressTexCoords =
+            OptionsUtil::getStringOption(toolOptions, "uvs", "norm16") != "keep";
+        mCompressPositions =
+            OptionsUtil::getStringOption(toolOptions, "positions", "keep") == "short4";
+
+        mDirectionErrorLimit = 1.0;
+        mTexCoordErrorLimit = 1e-4;
+        mPositionErrorLimit = 1e-4;
+        for (OptionList::const_iterator it = toolOptions.begin(); it != toolOptions.end(); ++it)
+        {
+            if (it->first == "direction_error")
+            {
+                mDirectionErrorLimit = any_cast<Real>(it->second);
+            }
+            else if (it->first == "uv_error")
+            {
+                mTexCoordErrorLimit = any_cast<Real>(it->second);
+            }
+            else if (it->first == "position_error")
+            {
+                mPositionErrorLimit = any_cast<Real>(it->second);
+            }
+        }
+    }
+
+    void CompressTool::doInvoke(const OptionList& toolOptions,
+        const StringVector& inFileNames, const StringVector& outFileNamesArg)
+    {
+        // Name count has to match, else we have no way to figure out how to apply output
+        // names to input files.
+        if (!(outFileNamesArg.empty() || inFileNames.size() == outFileNamesArg.size()))
+        {
+            fail("number of output files must match number of input files.");
+        }
+
+        setOptions(toolOptions);
+
+        StringVector outFileNames = outFileNamesArg.empty() ? inFileNames : outFileNamesArg;
+
+        for (size_t i = 0, end = inFileNames.size(); i < end; ++i)
+        {
+            if (StringUtil::endsWith(inFileNames[i], ".mesh", true))
+            {
+                processMeshFile(inFileNames[i], outFileNames[i]);
+            }
+            else
+            {
+                warn("unrecognised name ending for file " + inFileNames[i]);
+                warn("file skipped.");
+            }
+
+            releaseFileResources();
+        }
+    }
+
+    void CompressTool::processMeshFile(Ogre::String inFile, Ogre::String outFile)
+    {
+        StatefulMeshSerializer* meshSerializer =
+            OgreEnvironment::getSingleton().getMeshSerializer();
+
+        print("Loading mesh " + inFile + "...");
+        MeshPtr mesh;
+        try
+        {
+            mesh = meshSerializer->loadMesh(inFile);
+        }
+        catch(std::exception& e)
+        {
+            warn(e.what());
+            warn("Unable to open mesh file " + inFile);
+            warn("file skipped.");
+            return;
+        }
+        print("Compressing mesh...");
+        doProcessLoadedMesh(mesh, inFile, outFile);
+        meshSerializer->saveMesh(outFile, true);
+        print("Mesh saved as " + outFile + ".");
+    }
+
+    bool CompressTool::supportsLoadedMeshes() const
+    {
+        return true;
+    }
+
+    bool CompressTool::writesSidecarFiles() const
+    {
+        // The position scale and offset.
+        return mCompressPositions;
+    }
+
+    void CompressTool::doBeginLoadedMeshes(const OptionList& toolOptions)
+    {
+        setOptions(toolOptions);
+    }
+
+    bool CompressTool::doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String&,
+        const Ogre::String& outFile)
+    {
+        compress(mesh);
+        if (mPositionsQuantised)
+        {
+            // foo.mesh -> foo.quant
+            const String quantisationFile = ToolUtils::getSidecarFileName(outFile, ".quant");
+            writeQuantisationFile(quantisationFile);
+            print("Position scale and offset saved as " + quantisationFile + ".");
+        }
+        return true;
+    }
+
+    bool CompressTool::hasQuantisedPositions() const
+    {
+        return mPositionsQuantised;
+    }
+
+    const Vector3& CompressTool::getPositionScale() const
+    {
+        return mPositionScale;
+    }
+
+    const Vector3& CompressTool::getPositionOffset() const
+    {
+        return mPositionCenter;
+    }
+
+    void CompressTool::writeQuantisationFile(const Ogre::String& fileName) const
+    {
+        std::ofstream out(fileName.c_str());
+        if (!out)
+        {
+            fail("cannot open file " + fileName);
+        }
+
+        // Enough digits to read back the exact float values.
+        out << std::setprecision(9);
+        out << "# position = stored position * scale + offset" << std::endl;
+        out << "scale " << mPositionScale.x << " " << mPositionScale.y << " "
+            << mPositionScale.z << std::endl;
+        out << "offset " << mPositionCenter.x << " " << mPositionCenter.y << " "
+            << mPositionCenter.z << std::endl;
+
+        if (!out)
+        {
+            fail("failed writing " + fileName);
+        }
+        BuildCache::notifyFileWritten(fileName);
+    }
+
+    size_t CompressTool::compress(MeshPtr mesh)
+    {
+        // Quantised positions only work if the whole mesh is scaled back as one,
+        // bones and vertex animation would need to be quantised as well.
+        bool compressPositions = mCompressPositions;
+        if (compressPositions &&
+            (mesh->hasSkeleton() || mesh->hasVertexAnimation() || mesh->getPoseCount() > 0))
+        {
+            warn("Positions of skinned or vertex animated meshes are kept as float.");
+            compressPositions = false;
+        }
+        const AxisAlignedBox bounds = MeshUtils::getMeshAabb(mesh);
+        if (compressPositions && bounds.isFinite())
+        {
+            mPositionCenter = bounds.getCenter();
+            mPositionScale = bounds.getHalfSize();
+            for (int i = 0; i < 3; ++i)
+            {
+                if (mPositionScale[i] <= 0)
+                {
+                    mPositionScale[i] = 1;
+                }
+            }
+
+            // Rounding moves positions by up to half a step of the largest axis.
+            const Real maxScale = std::max(mPositionScale.x,
+                std::max(mPositionScale.y, mPositionScale.z));
+            if (maxScale / 65534 > mPositionErrorLimit * 2 * maxScale)
+            {
+                print("Position error limit is below the 16 bit resolution, "
+                    "positions are kept as float.");
+                compressPositions = false;
+            }
+        }
+        else
+        {
+            compressPositions = false;
+        }
+
+        mPositionsQuantised = compressPositions;
+        size_t bytesSaved = 0;
+        if (mesh->sharedVertexData != NULL)
+        {
+            print("Compressing shared vertex data...");
+            bytesSaved += processVertexData(mesh->sharedVertexData, compressPositions);
+        }
+        for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+        {
+            SubMesh* submesh = mesh->getSubMesh(i);
+            if (!submesh->useSharedVertices && submesh->vertexData != NULL)
+            {
+                print("Compressing submesh " + StringConverter::toString(i) + " vertex data...");
+                bytesSaved += processVertexData(submesh->vertexData, compressPositions);
+            }
+        }
+
+        if (compressPositions)
+        {
+            // Bounds are in the quantised space now.
+            const AxisAlignedBox& stored = mesh->getBounds();
+            mesh->_setBounds(AxisAlignedBox(
+                (stored.getMinimum() - mPositionCenter) / mPositionScale,
+                (stored.getMaximum() - mPositionCenter) / mPositionScale), false);
+
+            // Edge lists and shadow volumes need float positions.
+            if (mesh->isEdgeListBuilt())
+            {
+                mesh->freeEdgeList();
+                warn("Edge list removed, it can't be used with quantised positions.");
+            }
+
+            print("Positions are stored relative to the mesh bounds. To restore the original "
+                "size, scale by " + StringConverter::toString(mPositionScale) +
+                " and then translate by " + StringConverter::toString(mPositionCenter) + ".",
+                V_QUIET);
+        }
+
+        print(StringConverter::toString(bytesSaved) + " vertex buffer bytes saved in total.");
+        return bytesSaved;
+    }
+
+    size_t CompressTool::processVertexData(VertexData* vertexData, bool compressPositions)
+    {
+        // Copy, the declaration is modified at the end.
+        const VertexDeclaration::VertexElementList elements =
+            vertexData->vertexDeclaration->getElements();
+
+        std::vector<VertexElementType> newTypes;
+        std::vector<std::vector<unsigned char> > encoded(elements.size());
+        bool changed = false;
+        size_t i = 0;
+        for (VertexDeclaration::VertexElementList::const_iterator it = elements.begin();
+            it != elements.end(); ++it, ++i)
+        {
+            newTypes.push_back(it->getType());
+            if (encodeElement(vertexData, *it, compressPositions, newTypes[i], encoded[i]))
+            {
+                changed = true;
+            }
+        }
+        if (!changed)
+        {
+            print("    nothing to compress.");
+            return 0;
+        }
+
+        // Elements keep their buffer and their order in it, but are packed tightly.
+        std::map<unsigned short, size_t> newVertexSizes;
+        std::vector<size_t> newOffsets;
+        i = 0;
+        for (VertexDeclaration::VertexElementList::const_iterator it = elements.begin();
+            it != elements.end(); ++it, ++i)
+        {
+            size_t& vertexSize = newVertexSizes[it->getSource()];
+            newOffsets.push_back(vertexSize);
+            vertexSize += VertexElement::getTypeSize(newTypes[i]);
+        }
+
+        size_t oldSize = 0;
+        size_t newSize = 0;
+        for (std::map<unsigned short, size_t>::const_iterator bi = newVertexSizes.begin();
+            bi != newVertexSizes.end(); ++bi)
+        {
+            const unsigned short source = bi->first;
+            const size_t newVertexSize = bi->second;
+            HardwareVertexBufferSharedPtr oldBuffer =
+                vertexData->vertexBufferBinding->getBuffer(source);
+            const size_t oldVertexSize = oldBuffer->getVertexSize();
+            HardwareVertexBufferSharedPtr newBuffer =
+                HardwareBufferManager::getSingleton().createVertexBuffer(
+                    newVertexSize, vertexData->vertexCount,
+                    oldBuffer->getUsage(), oldBuffer->hasShadowBuffer());
+
+            const unsigned char* src = static_cast<const unsigned char*>(
+                oldBuffer->lock(HardwareBuffer::HBL_READ_ONLY));
+            unsigned char* dest = static_cast<unsigned char*>(
+                newBuffer->lock(HardwareBuffer::HBL_DISCARD));
+            for (size_t v = 0; v < vertexData->vertexCount; ++v)
+            {
+                i = 0;
+                for (VertexDeclaration::VertexElementList::const_iterator it = elements.begin();
+                    it != elements.end(); ++it, ++i)
+                {
+                    if (it->getSource() != source)
+                    {
+                        continue;
+                    }
+
+                    unsigned char* pDest = dest + v * newVertexSize + newOffsets[i];
+                    if (encoded[i].empty())
+                    {
+                        memcpy(pDest, src + v * oldVertexSize + it->getOffset(), it->getSize());
+                    }
+                    else
+                    {
+                        const size_t elemSize = VertexElement::getTypeSize(newTypes[i]);
+                        memcpy(pDest, &encoded[i][v * elemSize], elemSize);
+                    }
+                }
+            }
+            newBuffer->unlock();
+            oldBuffer->unlock();
+
+            vertexData->vertexBufferBinding->setBinding(source, newBuffer);
+            oldSize += oldVertexSize;
+            newSize += newVertexSize;
+        }
+
+        i = 0;
+        for (VertexDeclaration::VertexElementList::const_iterator it = elements.begin();
+            it != elements.end(); ++it, ++i)
+        {
+            vertexData->vertexDeclaration->modifyElement(static_cast<unsigned short>(i),
+                it->getSource(), newOffsets[i], newTypes[i], it->getSemantic(), it->getIndex());
+        }
+
+        const size_t bytesSaved = (oldSize - newSize) * vertexData->vertexCount;
+        print("    vertex size " + StringConverter::toString(oldSize) + " -> " +
+            StringConverter::toString(newSize) + " bytes, " +
+            StringConverter::toString(oldSize - newSize) + " bytes saved per vertex, " +
+            StringConverter::toString(bytesSaved) + " in total.");
+        return bytesSaved;
+    }
+
+    bool CompressTool::encodeElement(VertexData* vertexData, const VertexElement& vertexElem,
+        bool compressPositions, VertexElementType& newType, std::vector<unsigned char>& encoded)
+    {
+#ifdef MM_HAS_NORMALISED_VERTEX_ELEMENTS
+        const VertexElementType type = vertexElem.getType();
+        if (VertexElement::getBaseType(type) != VET_FLOAT1)
+        {
+            return false;
+        }
+
+        const unsigned short components = VertexElement::getTypeCount(type);
+        const VertexElementSemantic semantic = vertexElem.getSemantic();
+        const bool isPosition = semantic == VES_POSITION && compressPositions && components == 3;
+        const bool isNormal = semantic == VES_NORMAL && mNormalEncoding != DE_KEEP &&
+            components == 3;
+        const bool isTangent = (semantic == VES_TANGENT || semantic == VES_BINORMAL) &&
+            mTangentEncoding != DE_KEEP && components >= 3;
+        const bool isTexCoord = semantic == VES_TEXTURE_COORDINATES && mCompressTexCoords &&
+            components == 2;
+        if (!isPosition && !isNormal && !isTangent && !isTexCoord)
+        {
+            return false;
+        }
+
+        // Read the element of all vertices.
+        std::vector<float> values(vertexData->vertexCount * components);
+        HardwareVertexBufferSharedPtr buffer =
+            vertexData->vertexBufferBinding->getBuffer(vertexElem.getSource());
+        unsigned char* data =
+            static_cast<unsigned char*>(buffer->lock(HardwareBuffer::HBL_READ_ONLY));
+        for (size_t v = 0; v < vertexData->vertexCount; ++v)
+        {
+            float* ptr;
+            vertexElem.baseVertexPointerToElement(data, &ptr);
+            std::copy(ptr, ptr + components, &values[v * components]);
+            data += buffer->getVertexSize();
+        }
+        buffer->unlock();
+
+        bool compressed;
+        if (isPosition)
+        {
+            compressed = encodePositions(values, newType, encoded);
+        }
+        else if (isNormal)
+        {
+            compressed = encodeDirections(values, components, mNormalEncoding, "normals",
+                newType, encoded);
+        }
+        else if (isTangent)
+        {
+            compressed = encodeDirections(values, components, mTangentEncoding,
+                semantic == VES_TANGENT ? "tangents" : "binormals", newType, encoded);
+        }
+        else
+        {
+            compressed = encodeTexCoords(values,
+                "texture coordinates " + StringConverter::toString(vertexElem.getIndex()),
+                newType, encoded);
+        }
+
+        if (!compressed)
+        {
+            newType = type;
+            encoded.clear();
+        }
+        return compressed;
+#else
+        return false;
+#endif
+    }
+
+#ifdef MM_HAS_NORMALISED_VERTEX_ELEMENTS
+    bool CompressTool::encodeDirections(const std::vector<float>& values,
+        unsigned short components, DirectionEncoding encoding, const String& name,
+        VertexElementType& newType, std::vector<unsigned char>& encoded)
+    {
+        const size_t count = values.size() / components;
+        float maxError = 0.0f;
+        encoded.resize(count * 4);
+
+        if (encoding == DE_OCTAHEDRAL && components == 3)
+        {
+            newType = VET_SHORT2_NORM;
+            int16* out = reinterpret_cast<int16*>(&encoded[0]);
+            for (size_t i = 0; i < count; ++i, out += 2)
+            {
+                const Vector3 dir(values[i * 3], values[i * 3 + 1], values[i * 3 + 2]);
+                float u, v;
+                encodeOctahedral(dir, u, v);
+                out[0] = encodeNormalised<int16>(u, -1.0f, 32767.0f);
+                out[1] = encodeNormalised<int16>(v, -1.0f, 32767.0f);
+
+                const Vector3 decoded = decodeOctahedral(
+                    decodeNormalised(out[0], 32767.0f), decodeNormalised(out[1], 32767.0f));
+                maxError = std::max(maxError, getAngle(dir, decoded));
+            }
+        }
+        else
+        {
+            // xyz and, for 4 component tangents, the handedness in w.
+            newType = VET_BYTE4_NORM;
+            int8* out = reinterpret_cast<int8*>(&encoded[0]);
+            for (size_t i = 0; i < count; ++i, out += 4)
+            {
+                const float* in = &values[i * components];
+                const Vector3 dir(in[0], in[1], in[2]);
+                const Vector3 unit = dir.normalisedCopy();
+                for (int k = 0; k < 3; ++k)
+                {
+                    out[k] = encodeNormalised<int8>(unit[k], -1.0f, 127.0f);
+                }
+                out[3] = components == 4 ? encodeNormalised<int8>(sign(in[3]), -1.0f, 127.0f) : 0;
+
+                const Vector3 decoded(decodeNormalised(out[0], 127.0f),
+                    decodeNormalised(out[1], 127.0f), decodeNormalised(out[2], 127.0f));
+                maxError = std::max(maxError, getAngle(dir, decoded));
+            }
+        }
+
+        if (maxError > mDirectionErrorLimit)
+        {
+            print("    " + name + ": error of " + StringConverter::toString(maxError) +
+                " degrees exceeds the limit, kept as float.");
+            return false;
+        }
+        print("    " + name + " compressed, maximum error " +
+            StringConverter::toString(maxError) + " degrees.", V_HIGH);
+        return true;
+    }
+
+    bool CompressTool::encodeTexCoords(const std::vector<float>& values, const String& name,
+        VertexElementType& newType, std::vector<unsigned char>& encoded)
+    {
+        if (values.empty())
+        {
+            return false;
+        }
+
+        const float lo = *std::min_element(values.begin(), values.end());
+        const float hi = *std::max_element(values.begin(), values.end());
+        float maxError = 0.0f;
+        encoded.resize(values.size() * sizeof(uint16));
+        if (lo >= 0.0f && hi <= 1.0f)
+        {
+            newType = VET_USHORT2_NORM;
+            uint16* out = reinterpret_cast<uint16*>(&encoded[0]);
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                out[i] = encodeNormalised<uint16>(values[i], 0.0f, 65535.0f);
+                maxError = std::max(maxError, std::abs(out[i] / 65535.0f - values[i]));
+            }
+        }
+        else if (lo >= -1.0f && hi <= 1.0f)
+        {
+            newType = VET_SHORT2_NORM;
+            int16* out = reinterpret_cast<int16*>(&encoded[0]);
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                out[i] = encodeNormalised<int16>(values[i], -1.0f, 32767.0f);
+                maxError = std::max(maxError,
+                    std::abs(decodeNormalised(out[i], 32767.0f) - values[i]));
+            }
+        }
+        else
+        {
+            // Repeating texture coordinates would need a scale in the material.
+            print("    " + name + " outside [-1, 1], kept as float.");
+            return false;
+        }
+
+        if (maxError > mTexCoordErrorLimit)
+        {
+            print("    " + name + ": error of " + StringConverter::toString(maxError) +
+                " exceeds the limit, kept as float.");
+            return false;
+        }
+        print("    " + name + " compressed, maximum error " +
+            StringConverter::toString(maxError) + ".", V_HIGH);
+        return true;
+    }
+
+    bool CompressTool::encodePositions(const std::vector<float>& values,
+        VertexElementType& newType, std::vector<unsigned char>& encoded)
+    {
+        const size_t count = values.size() / 3;
+        Real maxError = 0;
+
+        newType = VET_SHORT4_NORM;
+        encoded.resize(count * 4 * sizeof(int16));
+        int16* out = reinterpret_cast<int16*>(&encoded[0]);
+        for (size_t i = 0; i < count; ++i, out += 4)
+        {
+            const Vector3 pos(values[i * 3], values[i * 3 + 1], values[i * 3 + 2]);
+            const Vector3 rel = (pos - mPositionCenter) / mPositionScale;
+            for (int k = 0; k < 3; ++k)
+            {
+                out[k] = encodeNormalised<int16>(static_cast<float>(rel[k]), -1.0f, 32767.0f);
+                const Real decoded = decodeNormalised(out[k], 32767.0f) * mPositionScale[k] +
+                    mPositionCenter[k];
+                maxError = std::max(maxError, std::abs(decoded - pos[k]));
+            }
+            out[3] = 32767;
+        }
+
+        // The error limit has been checked for the whole mesh up front, as all vertex data
+        // has to use the same quantisation.
+        print("    positions compressed, maximum error " +
+            StringConverter::toString(maxError) + ".", V_HIGH);
+        return true;
+    }
+#endif
+}
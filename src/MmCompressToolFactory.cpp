@@ -0,0 +1,107 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmCompressToolFactory.h"
+#include "MmCompressTool.h"
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    //------------------------------------------------------------------------
+    Tool* CompressToolFactory::createTool()
+    {
+        Tool* tool = new CompressTool();
+        return tool;
+    }
+    //------------------------------------------------------------------------
+
+    void CompressToolFactory::destroyTool(Tool* tool)
+    {
+        delete tool;
+    }
+    //------------------------------------------------------------------------
+
+    OptionDefinitionSet CompressToolFactory::getOptionDefinitions() const
+    {
+        OptionDefinitionSet optionDefs;
+        optionDefs.insert(OptionDefinition("normals", OT_SELECTION, false, false,
+            Any(String("snorm8")), ";snorm8;octahedral;keep"));
+        optionDefs.insert(OptionDefinition("tangents", OT_SELECTION, false, false,
+            Any(String("snorm8")), ";snorm8;keep"));
+        optionDefs.insert(OptionDefinition("uvs", OT_SELECTION, false, false,
+            Any(String("norm16")), ";norm16;keep"));
+        optionDefs.insert(OptionDefinition("positions", OT_SELECTION, false, false,
+            Any(String("short4")), ";keep;short4"));
+        optionDefs.insert(OptionDefinition("direction_error", OT_REAL, false, false, Any(Real(1))));
+        optionDefs.insert(OptionDefinition("uv_error", OT_REAL, false, false, Any(Real(1e-4))));
+        optionDefs.insert(OptionDefinition("position_error", OT_REAL, false, false,
+            Any(Real(1e-4))));
+        return optionDefs;
+    }
+    //------------------------------------------------------------------------
+
+    void CompressToolFactory::printToolHelp(std::ostream& out) const
+    {
+        out << std::endl;
+        out << "Stores vertex attributes in smaller, normalised integer formats" << std::endl
+            << std::endl;
+        out << "options:" << std::endl;
+        out << "   -normals=snorm8|octahedral|keep - encoding of normals (default snorm8)"
+            << std::endl;
+        out << "       snorm8: signed normalised bytes, 4 bytes per normal" << std::endl;
+        out << "       octahedral: two signed normalised shorts, 4 bytes per normal," << std::endl;
+        out << "       needs shaders decoding them" << std::endl;
+        out << "   -tangents=snorm8|keep - encoding of tangents and binormals (default snorm8)"
+            << std::endl;
+        out << "   -uvs=norm16|keep - encoding of 2D texture coordinates (default norm16)"
+            << std::endl;
+        out << "       Only texture coordinates within [0, 1] or [-1, 1] are converted."
+            << std::endl;
+        out << "   -positions=keep|short4 - encoding of positions (default keep)" << std::endl;
+        out << "       short4 stores positions relative to the mesh bounds. The scale and" << std::endl;
+        out << "       translation to restore them are saved next to the mesh, foo.mesh" << std::endl;
+        out << "       gets foo.quant. They have to be applied to the nodes the mesh is" << std::endl;
+        out << "       attached to. Not done for animated meshes." << std::endl;
+        out << "   -direction_error=degrees - maximum error for normals and tangents (default 1)"
+            << std::endl;
+        out << "   -uv_error=val - maximum error for texture coordinates (default 0.0001)"
+            << std::endl;
+        out << "   -position_error=val - maximum error for positions, relative to the mesh size"
+            << std::endl;
+        out << "       (default 0.0001)" << std::endl;
+        out << "Attributes exceeding their error limit are kept as float." << std::endl;
+        out << "Compressed meshes need hardware skinning and hardware vertex animation."
+            << std::endl
+            << std::endl;
+    }
+    //------------------------------------------------------------------------
+
+    Ogre::String CompressToolFactory::getToolName() const
+    {
+        return "compress";
+    }
+    //------------------------------------------------------------------------
+
+    Ogre::String CompressToolFactory::getToolDescription() const
+    {
+        return "Compress vertex attributes to save memory.";
+    }
+    //------------------------------------------------------------------------
+}
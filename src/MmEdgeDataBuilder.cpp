@@ -0,0 +1,526 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmEdgeDataBuilder.h"
+
+#include <OgreEdgeListBuilder.h>
+#include <OgreException.h>
+#include <OgreSubMesh.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+
+#include "MmMeshUtils.h"
+#include "MmThreadPool.h"
+
+using namespace Ogre;
+
+//New shared ptr API introduced in 1.10.1
+#if OGRE_VERSION >= 0x10A01
+#define OGRE_ISNULL(_sharedPtr) (!(_sharedPtr))
+#else
+#define OGRE_ISNULL(_sharedPtr) ((_sharedPtr).isNull())
+#endif
+
+namespace
+{
+    const uint32 NO_ENTRY = 0xffffffff;
+    
+    /// Power of two size keeping a hash table with maxEntries at most half full.
+    size_t getTableSize(size_t maxEntries)
+    {
+        size_t size = 16;
+        while (size < maxEntries * 2)
+        {
+            size *= 2;
+        }
+        return size;
+    }
+
+    void hashCombine(size_t& seed, size_t value)
+    {
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    /// Assigns ids to distinct positions in order of first use, EdgeListBuilder's common vertices.
+    class CommonVertexTable
+    {
+    public:
+        explicit CommonVertexTable(size_t maxVertices)
+            : mSlots(getTableSize(maxVertices), NO_ENTRY), mMask(mSlots.size() - 1)
+        {
+        }
+
+        uint32 findOrCreate(const Vector3& position)
+        {
+            for (size_t slot = hash(position) & mMask; ; slot = (slot + 1) & mMask)
+            {
+                const uint32 id = mSlots[slot];
+                if (id == NO_ENTRY)
+                {
+                    mSlots[slot] = static_cast<uint32>(mPositions.size());
+                    mPositions.push_back(position);
+                    return mSlots[slot];
+                }
+                // Vertices are shared by exact position, like Ogre does.
+                if (mPositions[id] == position)
+                {
+                    return id;
+                }
+            }
+        }
+
+    private:
+        std::vector<uint32> mSlots;
+        size_t mMask;
+        std::vector<Vector3> mPositions;
+
+        static size_t hash(const Vector3& p)
+        {
+            // Adding 0 turns -0 into 0, which compares equal to it.
+            std::hash<Real> hasher;
+            size_t seed = hasher(p.x + Real(0));
+            hashCombine(seed, hasher(p.y + Real(0)));
+            hashCombine(seed, hasher(p.z + Real(0)));
+            return seed;
+        }
+    };
+
+    /** Edges waiting for a second triangle, EdgeListBuilder's edge map.
+    @remarks
+        Open edges are kept in a list per start vertex. Those lists are as short as
+        the vertex valence, and common vertex ids are in order of first use, which
+        keeps lookups local where a map or a hash table over all edges isn't.
+    */
+    class OpenEdgeTable
+    {
+    public:
+        explicit OpenEdgeTable(size_t numVertices)
+            : mFirst(numVertices, NO_ENTRY), mFreeNode(NO_ENTRY), mSize(0)
+        {
+        }
+
+        /// Adds the edge from v0 to v1, unless one is open already.
+        /// That keeps the first edge like the std::map::insert in EdgeListBuilder.
+        void insert(uint32 v0, uint32 v1, uint32 group, uint32 edge)
+        {
+            for (uint32 n = mFirst[v0]; n != NO_ENTRY; n = mNodes[n].next)
+            {
+                if (mNodes[n].end == v1)
+                {
+                    return;
+                }
+            }
+
+            // Nodes of removed edges are reused.
+            uint32 n = mFreeNode;
+            if (n != NO_ENTRY)
+            {
+                mFreeNode = mNodes[n].next;
+            }
+            else
+            {
+                n = static_cast<uint32>(mNodes.size());
+                mNodes.push_back(Node());
+            }
+            Node& node = mNodes[n];
+            node.end = v1;
+            node.group = group;
+            node.edge = edge;
+            node.next = mFirst[v0];
+            mFirst[v0] = n;
+            ++mSize;
+        }
+
+        /// Removes the open edge from v0 to v1, returns false if there is none.
+        bool remove(uint32 v0, uint32 v1, uint32& group, uint32& edge)
+        {
+            for (uint32* link = &mFirst[v0]; *link != NO_ENTRY; link = &mNodes[*link].next)
+            {
+                const uint32 n = *link;
+                if (mNodes[n].end == v1)
+                {
+                    group = mNodes[n].group;
+                    edge = mNodes[n].edge;
+                    *link = mNodes[n].next;
+                    mNodes[n].next = mFreeNode;
+                    mFreeNode = n;
+                    --mSize;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        size_t size() const
+        {
+            return mSize;
+        }
+
+    private:
+        struct Node
+        {
+            uint32 end;
+            uint32 group;
+            uint32 edge;
+            uint32 next;
+        };
+
+        std::vector<uint32> mFirst;
+        uint32 mFreeNode;
+        size_t mSize;
+        std::vector<Node> mNodes;
+    };
+
+    /// Index data of a LOD level together with its vertex set, EdgeListBuilder's Geometry.
+    struct Geometry
+    {
+        size_t vertexSet;
+        size_t indexSet;
+        RenderOperation::OperationType operationType;
+        std::vector<uint32> indices;
+        const std::vector<Vector3>* positions;
+
+        /// Vertex indices of all triangles, strips and fans unrolled.
+        std::vector<uint32> corners;
+        /// Whether two corners of a triangle have the same position.
+        std::vector<bool> isDegenerate;
+        /// Face normals of the non degenerate triangles.
+        std::vector<Vector4> faceNormals;
+    };
+
+    bool isVertexSetLess(const Geometry& a, const Geometry& b)
+    {
+        return a.vertexSet < b.vertexSet;
+    }
+
+    struct LodInput
+    {
+        unsigned short lodIndex;
+        std::vector<const VertexData*> vertexSets;
+        std::vector<Geometry> geometries;
+        EdgeData* edgeData;
+    };
+
+    /// Unrolls the triangles of geometry and computes the normals of the non degenerate ones.
+    void buildTriangles(Geometry& geometry)
+    {
+        const std::vector<uint32>& indices = geometry.indices;
+        const std::vector<Vector3>& positions = *geometry.positions;
+        const bool isList = geometry.operationType == RenderOperation::OT_TRIANGLE_LIST;
+        const size_t numTriangles = isList ? indices.size() / 3 :
+            indices.size() < 3 ? 0 : indices.size() - 2;
+        geometry.corners.reserve(numTriangles * 3);
+        geometry.isDegenerate.reserve(numTriangles);
+        geometry.faceNormals.reserve(numTriangles);
+
+        uint32 tri[3] = { 0, 0, 0 };
+        for (size_t t = 0; t < numTriangles; ++t)
+        {
+            if (isList || t == 0)
+            {
+                const size_t first = isList ? t * 3 : 0;
+                tri[0] = indices[first];
+                tri[1] = indices[first + 1];
+                tri[2] = indices[first + 2];
+            }
+            else
+            {
+                if (geometry.operationType == RenderOperation::OT_TRIANGLE_FAN)
+                {
+                    // Fan: shift along, keeping first vertex
+                    tri[1] = tri[2];
+                }
+                else if (t & 1)
+                {
+                    // Strip: shift along, and alternate winding
+                    tri[0] = tri[2];
+                }
+                else
+                {
+                    tri[1] = tri[2];
+                }
+                tri[2] = indices[t + 2];
+            }
+
+            if (tri[0] >= positions.size() || tri[1] >= positions.size() ||
+                tri[2] >= positions.size())
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Index out of vertex data range.",
+                    "EdgeDataBuilder::buildEdgeLists");
+            }
+
+            // Equal positions share a common vertex, which makes the triangle degenerate.
+            const Vector3& v0 = positions[tri[0]];
+            const Vector3& v1 = positions[tri[1]];
+            const Vector3& v2 = positions[tri[2]];
+            const bool isDegenerate = v0 == v1 || v1 == v2 || v2 == v0;
+            geometry.corners.insert(geometry.corners.end(), tri, tri + 3);
+            geometry.isDegenerate.push_back(isDegenerate);
+            if (!isDegenerate)
+            {
+                geometry.faceNormals.push_back(
+                    Math::calculateFaceNormalWithoutNormalize(v0, v1, v2));
+            }
+        }
+    }
+
+    void connectOrCreateEdge(EdgeData* edgeData, OpenEdgeTable& openEdges, size_t vertexSet,
+        size_t triangleIndex, size_t vertIndex0, size_t vertIndex1,
+        uint32 sharedVertIndex0, uint32 sharedVertIndex1)
+    {
+        // An existing edge uses the vertices in reverse order.
+        uint32 group;
+        uint32 edge;
+        if (openEdges.remove(sharedVertIndex1, sharedVertIndex0, group, edge))
+        {
+            EdgeData::Edge& e = edgeData->edgeGroups[group].edges[edge];
+            e.triIndex[1] = triangleIndex;
+            e.degenerate = false;
+            return;
+        }
+
+        EdgeData::EdgeList& edges = edgeData->edgeGroups[vertexSet].edges;
+        openEdges.insert(sharedVertIndex0, sharedVertIndex1, static_cast<uint32>(vertexSet),
+            static_cast<uint32>(edges.size()));
+        EdgeData::Edge e;
+        e.degenerate = true;
+        e.triIndex[0] = triangleIndex;
+        e.triIndex[1] = static_cast<size_t>(~0);
+        e.sharedVertIndex[0] = sharedVertIndex0;
+        e.sharedVertIndex[1] = sharedVertIndex1;
+        e.vertIndex[0] = vertIndex0;
+        e.vertIndex[1] = vertIndex1;
+        edges.push_back(e);
+    }
+
+    /// Builds the edge data of a LOD level from its geometry's triangles.
+    EdgeData* buildEdgeData(const LodInput& lod)
+    {
+        // There are at most as many common vertices as vertices in the used vertex sets.
+        size_t numCorners = 0;
+        size_t numVertices = 0;
+        std::vector<bool> isVertexSetCounted(lod.vertexSets.size(), false);
+        for (size_t g = 0; g < lod.geometries.size(); ++g)
+        {
+            const Geometry& geometry = lod.geometries[g];
+            numCorners += geometry.corners.size();
+            if (!isVertexSetCounted[geometry.vertexSet])
+            {
+                numVertices += geometry.positions->size();
+                isVertexSetCounted[geometry.vertexSet] = true;
+            }
+        }
+
+        EdgeData* edgeData = OGRE_NEW EdgeData();
+        edgeData->triangles.reserve(numCorners / 3);
+        edgeData->triangleFaceNormals.reserve(numCorners / 3);
+        edgeData->edgeGroups.resize(lod.vertexSets.size());
+        for (size_t i = 0; i < lod.vertexSets.size(); ++i)
+        {
+            EdgeData::EdgeGroup& eg = edgeData->edgeGroups[i];
+            eg.vertexSet = i;
+            eg.vertexData = lod.vertexSets[i];
+            eg.triStart = 0;
+            eg.triCount = 0;
+        }
+
+        CommonVertexTable commonVertices(numVertices);
+        OpenEdgeTable openEdges(numVertices);
+        // Common vertex of each vertex, so positions are hashed once per vertex, not per corner.
+        std::vector<std::vector<uint32> > commonIndices(lod.vertexSets.size());
+        for (size_t g = 0; g < lod.geometries.size(); ++g)
+        {
+            const Geometry& geometry = lod.geometries[g];
+            std::vector<uint32>& common = commonIndices[geometry.vertexSet];
+            common.resize(geometry.positions->size(), NO_ENTRY);
+
+            EdgeData::EdgeGroup& eg = edgeData->edgeGroups[geometry.vertexSet];
+            size_t triangleIndex = edgeData->triangles.size();
+            // Geometry is sorted by vertex set, set triStart when first seeing the group.
+            if (!eg.triCount)
+            {
+                eg.triStart = triangleIndex;
+            }
+
+            for (size_t c = 0; c < geometry.corners.size(); c += 3)
+            {
+                EdgeData::Triangle tri;
+                tri.indexSet = geometry.indexSet;
+                tri.vertexSet = geometry.vertexSet;
+                uint32 shared[3];
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    const uint32 index = geometry.corners[c + i];
+                    if (common[index] == NO_ENTRY)
+                    {
+                        common[index] = commonVertices.findOrCreate((*geometry.positions)[index]);
+                    }
+                    tri.vertIndex[i] = index;
+                    tri.sharedVertIndex[i] = shared[i] = common[index];
+                }
+                // Degenerate triangles are skipped after their vertices got common ids.
+                if (geometry.isDegenerate[c / 3])
+                {
+                    continue;
+                }
+                edgeData->triangles.push_back(tri);
+
+                connectOrCreateEdge(edgeData, openEdges, geometry.vertexSet, triangleIndex,
+                    tri.vertIndex[0], tri.vertIndex[1], shared[0], shared[1]);
+                connectOrCreateEdge(edgeData, openEdges, geometry.vertexSet, triangleIndex,
+                    tri.vertIndex[1], tri.vertIndex[2], shared[1], shared[2]);
+                connectOrCreateEdge(edgeData, openEdges, geometry.vertexSet, triangleIndex,
+                    tri.vertIndex[2], tri.vertIndex[0], shared[2], shared[0]);
+                ++triangleIndex;
+            }
+            edgeData->triangleFaceNormals.insert(edgeData->triangleFaceNormals.end(),
+                geometry.faceNormals.begin(), geometry.faceNormals.end());
+
+            eg.triCount = triangleIndex - eg.triStart;
+        }
+
+        edgeData->triangleLightFacings.resize(edgeData->triangles.size());
+        edgeData->isClosed = openEdges.size() == 0;
+        return edgeData;
+    }
+
+    /// Mesh only sets mEdgeListsBuilt itself, when building or loading edge lists.
+    /// A pointer to the protected member can be taken through a derived class.
+    struct MeshEdgeListAccess : public Mesh
+    {
+        static bool Mesh::* getBuiltFlag()
+        {
+            return &MeshEdgeListAccess::mEdgeListsBuilt;
+        }
+    };
+}
+
+namespace meshmagick
+{
+    void EdgeDataBuilder::buildEdgeLists(MeshPtr mesh, size_t numThreads)
+    {
+        mesh->freeEdgeList();
+
+        // Collect vertex and index data of each LOD level in the order Mesh::buildEdgeList
+        // hands them to EdgeListBuilder, so vertex and index sets are numbered the same.
+        std::vector<LodInput> lods;
+        bool hasIndexData = false;
+        for (unsigned short lodIndex = 0; lodIndex < mesh->getNumLodLevels(); ++lodIndex)
+        {
+            MeshLodUsage& usage = const_cast<MeshLodUsage&>(mesh->getLodLevel(lodIndex));
+            if (!usage.manualName.empty() && lodIndex != 0)
+            {
+                // Manual LOD levels use the edge list of their own mesh.
+                if (!OGRE_ISNULL(usage.manualMesh))
+                {
+                    usage.edgeData = usage.manualMesh->getEdgeList(0);
+                }
+                continue;
+            }
+
+            LodInput lod;
+            lod.lodIndex = lodIndex;
+            lod.edgeData = 0;
+            if (mesh->sharedVertexData != 0)
+            {
+                lod.vertexSets.push_back(mesh->sharedVertexData);
+            }
+            for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+            {
+                SubMesh* sm = mesh->getSubMesh(i);
+                if (sm->operationType != RenderOperation::OT_TRIANGLE_FAN &&
+                    sm->operationType != RenderOperation::OT_TRIANGLE_LIST &&
+                    sm->operationType != RenderOperation::OT_TRIANGLE_STRIP)
+                {
+                    continue;
+                }
+                hasIndexData = true;
+
+                Geometry geometry;
+                geometry.operationType = sm->operationType;
+                geometry.positions = 0;
+                if (sm->useSharedVertices)
+                {
+                    geometry.vertexSet = 0;
+                }
+                else if (sm->isBuildEdgesEnabled())
+                {
+                    geometry.vertexSet = lod.vertexSets.size();
+                    lod.vertexSets.push_back(sm->vertexData);
+                }
+                else
+                {
+                    continue;
+                }
+                geometry.indexSet = lod.geometries.size();
+                MeshUtils::getIndices(lodIndex == 0 ? sm->indexData : sm->mLodFaceList[lodIndex - 1],
+                    geometry.indices);
+                lod.geometries.push_back(geometry);
+            }
+            std::stable_sort(lod.geometries.begin(), lod.geometries.end(), isVertexSetLess);
+            lods.push_back(lod);
+        }
+
+        if (!hasIndexData)
+        {
+            // Like Mesh::buildEdgeList, give up on edge lists for meshes without triangles.
+            mesh->setAutoBuildEdgeLists(false);
+            return;
+        }
+
+        // Buffers are read up front, locking them isn't thread safe. LOD levels share
+        // their vertex data, so positions are read once per vertex data.
+        std::map<const VertexData*, std::vector<Vector3> > positions;
+        std::vector<Geometry*> geometries;
+        for (size_t l = 0; l < lods.size(); ++l)
+        {
+            for (size_t g = 0; g < lods[l].geometries.size(); ++g)
+            {
+                Geometry& geometry = lods[l].geometries[g];
+                const VertexData* vd = lods[l].vertexSets[geometry.vertexSet];
+                if (positions.find(vd) == positions.end())
+                {
+                    MeshUtils::getPositions(const_cast<VertexData*>(vd), positions[vd]);
+                }
+                geometry.positions = &positions[vd];
+                geometries.push_back(&geometry);
+            }
+        }
+
+        // Triangles are read per index data, then linked per LOD level. Linking walks
+        // triangles in order, so common vertex ids and edges match EdgeListBuilder's.
+        ThreadPool pool(numThreads);
+        pool.run(geometries.size(), [&geometries](size_t i) {
+            buildTriangles(*geometries[i]);
+            std::vector<uint32>().swap(geometries[i]->indices);
+        });
+        pool.run(lods.size(), [&lods](size_t i) {
+            lods[i].edgeData = buildEdgeData(lods[i]);
+        });
+
+        for (size_t l = 0; l < lods.size(); ++l)
+        {
+            const_cast<MeshLodUsage&>(mesh->getLodLevel(lods[l].lodIndex)).edgeData =
+                lods[l].edgeData;
+        }
+        (*mesh).*MeshEdgeListAccess::getBuiltFlag() = true;
+    }
+}
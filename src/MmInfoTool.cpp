@@ -19,6 +19,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "MmInfoTool.h"
 
+#include "MmMappedFileDataStream.h"
 #include "MmMeshUtils.h"
 #include "MmOgreEnvironment.h"
 #include "MmStatefulMeshSerializer.h"
@@ -33,6 +34,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <algorithm>
 #include <functional>
 #include <map>
+#include <set>
+#include <stdexcept>
 
 using namespace Ogre;
 
@@ -48,6 +51,511 @@ namespace meshmagick
     };
     //------------------------------------------------------------------------
 
+	namespace
+	{
+		// Chunk ids of the mesh and skeleton file formats, as far as the fast scan needs them.
+		const unsigned short HEADER_CHUNK_ID = 0x1000;
+		const unsigned short HEADER_CHUNK_ID_SWAPPED = 0x0010;
+		const size_t CHUNK_HEADER_SIZE = sizeof(uint16) + sizeof(uint32);
+
+		enum MeshChunkId
+		{
+			M_MESH = 0x3000,
+			M_SUBMESH = 0x4000,
+			M_SUBMESH_OPERATION = 0x4010,
+			M_SUBMESH_BONE_ASSIGNMENT = 0x4100,
+			M_SUBMESH_TEXTURE_ALIAS = 0x4200,
+			M_GEOMETRY = 0x5000,
+			M_GEOMETRY_VERTEX_DECLARATION = 0x5100,
+			M_GEOMETRY_VERTEX_ELEMENT = 0x5110,
+			M_GEOMETRY_VERTEX_BUFFER = 0x5200,
+			M_GEOMETRY_VERTEX_BUFFER_DATA = 0x5210,
+			M_MESH_SKELETON_LINK = 0x6000,
+			M_MESH_BONE_ASSIGNMENT = 0x7000,
+			M_MESH_LOD = 0x8000,
+			M_MESH_LOD_USAGE = 0x8100,
+			M_MESH_LOD_MANUAL = 0x8110,
+			M_MESH_LOD_GENERATED = 0x8120,
+			M_MESH_BOUNDS = 0x9000,
+			M_SUBMESH_NAME_TABLE = 0xA000,
+			M_SUBMESH_NAME_TABLE_ELEMENT = 0xA100,
+			M_EDGE_LISTS = 0xB000,
+			M_POSES = 0xC000,
+			M_POSE = 0xC100,
+			M_POSE_VERTEX = 0xC111,
+			M_ANIMATIONS = 0xD000,
+			M_ANIMATION = 0xD100,
+			M_ANIMATION_BASEINFO = 0xD105,
+			M_ANIMATION_TRACK = 0xD110,
+			M_ANIMATION_MORPH_KEYFRAME = 0xD111,
+			M_ANIMATION_POSE_KEYFRAME = 0xD112,
+			M_ANIMATION_POSE_REF = 0xD113
+		};
+
+		enum SkeletonChunkId
+		{
+			SKELETON_BONE = 0x2000,
+			SKELETON_ANIMATION = 0x4000,
+			SKELETON_ANIMATION_BASEINFO = 0x4010,
+			SKELETON_ANIMATION_TRACK = 0x4100,
+			SKELETON_ANIMATION_TRACK_KEYFRAME = 0x4110
+		};
+
+		// Mesh format versions the fast scan understands, oldest first.
+		enum MeshFormatVersion
+		{
+			MESH_VERSION_1_30,
+			MESH_VERSION_1_40,
+			MESH_VERSION_1_41,
+			MESH_VERSION_1_8,
+			MESH_VERSION_1_100
+		};
+
+		MeshFormatVersion getMeshFormatVersion(const String& version)
+		{
+			if (version == "[MeshSerializer_v1.100]") return MESH_VERSION_1_100;
+			if (version == "[MeshSerializer_v1.8]") return MESH_VERSION_1_8;
+			if (version == "[MeshSerializer_v1.41]") return MESH_VERSION_1_41;
+			if (version == "[MeshSerializer_v1.40]") return MESH_VERSION_1_40;
+			if (version == "[MeshSerializer_v1.30]") return MESH_VERSION_1_30;
+			throw std::runtime_error("mesh format " + version + " not supported by fast scan");
+		}
+
+		/// Reads the chunk stream of a mesh or skeleton file front to back.
+		/// Only chunk headers and the small fixed parts are read, payloads are seeked past.
+		/// Container chunk sizes written before Ogre 1.10 are not reliable, so containers
+		/// are walked the way the serializers read them and only leaf chunks are skipped
+		/// by their stated size.
+		class ChunkReader
+		{
+		public:
+			explicit ChunkReader(const String& fileName)
+				: mStream(MappedFileDataStream::open(fileName)), mFileName(fileName),
+				  mFlipEndian(false)
+			{
+			}
+
+			/// Reads the file header and determines the endianess. Returns the version string.
+			String readFileHeader()
+			{
+				unsigned short id = readShort();
+				if (id == HEADER_CHUNK_ID_SWAPPED)
+				{
+					mFlipEndian = true;
+				}
+				else if (id != HEADER_CHUNK_ID)
+				{
+					throw std::runtime_error("no valid file header in " + mFileName);
+				}
+				return readString();
+			}
+
+			bool isEndianFlipped() const
+			{
+				return mFlipEndian;
+			}
+
+			/// Reads the next chunk header. Returns false at the end of the file.
+			/// chunkEnd is set to the end of the chunk according to its stated size.
+			bool nextChunk(unsigned short& id, size_t& chunkEnd)
+			{
+				if (mStream->eof())
+				{
+					return false;
+				}
+				size_t start = mStream->tell();
+				id = readShort();
+				uint32 length = readInt();
+				if (length < CHUNK_HEADER_SIZE)
+				{
+					throw std::runtime_error("corrupt chunk in " + mFileName);
+				}
+				chunkEnd = start + length;
+				return true;
+			}
+
+			/// Like nextChunk, but the chunk has to be there and of the given id.
+			size_t expectChunk(unsigned short expectedId)
+			{
+				unsigned short id;
+				size_t chunkEnd;
+				if (!nextChunk(id, chunkEnd) || id != expectedId)
+				{
+					throw std::runtime_error("unexpected chunk layout in " + mFileName);
+				}
+				return chunkEnd;
+			}
+
+			/// Moves back before the chunk header just read.
+			void backpedal()
+			{
+				mStream->skip(-static_cast<long>(CHUNK_HEADER_SIZE));
+			}
+
+			void seek(size_t pos)
+			{
+				if (pos > mStream->size())
+				{
+					throw std::runtime_error("unexpected end of file " + mFileName);
+				}
+				mStream->seek(pos);
+			}
+
+			void skip(size_t bytes)
+			{
+				seek(mStream->tell() + bytes);
+			}
+
+			bool readBool()
+			{
+				unsigned char value;
+				readData(&value, sizeof(value));
+				return value != 0;
+			}
+
+			unsigned short readShort()
+			{
+				unsigned short value;
+				readData(&value, sizeof(value));
+				return value;
+			}
+
+			uint32 readInt()
+			{
+				uint32 value;
+				readData(&value, sizeof(value));
+				return value;
+			}
+
+			float readFloat()
+			{
+				float value;
+				readData(&value, sizeof(value));
+				return value;
+			}
+
+			String readString()
+			{
+				return mStream->getLine(false);
+			}
+
+		private:
+			DataStreamPtr mStream;
+			String mFileName;
+			bool mFlipEndian;
+
+			void readData(void* dest, size_t size)
+			{
+				if (mStream->read(dest, size) != size)
+				{
+					throw std::runtime_error("unexpected end of file " + mFileName);
+				}
+				if (mFlipEndian)
+				{
+					unsigned char* bytes = static_cast<unsigned char*>(dest);
+					std::reverse(bytes, bytes + size);
+				}
+			}
+		};
+
+		/// What the fast scan gathers about a vertex data block.
+		struct ScannedVertexData
+		{
+			size_t vertexCount;
+			VertexDeclaration::VertexElementList elements;
+			/// Binding index the mesh would give a new buffer.
+			unsigned short nextSource;
+			/// Number of bone assignments per vertex.
+			std::vector<unsigned short> assignmentCounts;
+			std::set<unsigned short> bones;
+
+			ScannedVertexData() : vertexCount(0), elements(), nextSource(0),
+				assignmentCounts(), bones() {}
+		};
+
+		void scanGeometry(ChunkReader& reader, ScannedVertexData& data)
+		{
+			data.vertexCount = reader.readInt();
+
+			unsigned short id;
+			size_t chunkEnd;
+			while (reader.nextChunk(id, chunkEnd))
+			{
+				if (id == M_GEOMETRY_VERTEX_DECLARATION)
+				{
+					while (reader.nextChunk(id, chunkEnd))
+					{
+						if (id != M_GEOMETRY_VERTEX_ELEMENT)
+						{
+							reader.backpedal();
+							break;
+						}
+						unsigned short source = reader.readShort();
+						VertexElementType type = static_cast<VertexElementType>(reader.readShort());
+						VertexElementSemantic semantic =
+							static_cast<VertexElementSemantic>(reader.readShort());
+						unsigned short offset = reader.readShort();
+						unsigned short index = reader.readShort();
+						data.elements.push_back(VertexElement(source, offset, type, semantic, index));
+					}
+				}
+				else if (id == M_GEOMETRY_VERTEX_BUFFER)
+				{
+					unsigned short bindIndex = reader.readShort();
+					unsigned short vertexSize = reader.readShort();
+					data.nextSource = std::max<unsigned short>(data.nextSource, bindIndex + 1);
+
+					reader.expectChunk(M_GEOMETRY_VERTEX_BUFFER_DATA);
+					reader.skip(data.vertexCount * vertexSize);
+				}
+				else
+				{
+					reader.backpedal();
+					break;
+				}
+			}
+		}
+
+		void scanBoneAssignment(ChunkReader& reader, ScannedVertexData& data)
+		{
+			uint32 vertexIndex = reader.readInt();
+			unsigned short boneIndex = reader.readShort();
+			if (vertexIndex < data.vertexCount)
+			{
+				data.assignmentCounts.resize(data.vertexCount, 0);
+				++data.assignmentCounts[vertexIndex];
+				data.bones.insert(boneIndex);
+			}
+		}
+
+		/// Does to the scanned declaration what Mesh::_updateCompiledBoneAssignments does
+		/// to the loaded one, so that the layout matches the full info report.
+		void compileBoneAssignments(ScannedVertexData& data)
+		{
+
+			unsigned short numWeights = std::min<unsigned short>(OGRE_MAX_BLEND_WEIGHTS,
+				*std::max_element(data.assignmentCounts.begin(), data.assignmentCounts.end()));
+
+			for (VertexDeclaration::VertexElementList::iterator it = data.elements.begin();
+				it != data.elements.end();)
+			{
+				if (it->getSemantic() == VES_BLEND_INDICES || it->getSemantic() == VES_BLEND_WEIGHTS)
+				{
+					it = data.elements.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+			data.elements.push_back(VertexElement(data.nextSource, 0,
+				VET_UBYTE4, VES_BLEND_INDICES));
+			data.elements.push_back(VertexElement(data.nextSource, sizeof(unsigned char) * 4,
+				VertexElement::multiplyTypeCount(VET_FLOAT1, numWeights), VES_BLEND_WEIGHTS));
+		}
+
+		/// Scanned counterpart of InfoTool::processBoneAssignmentData.
+		void processBoneAssignments(VertexInfo& info, ScannedVertexData& data, bool hasSkeleton)
+		{
+			// Assignments are only compiled into the vertex data if there is a skeleton.
+			const bool compiled = hasSkeleton && !data.bones.empty();
+			if (compiled)
+			{
+				compileBoneAssignments(data);
+			}
+
+			for (VertexDeclaration::VertexElementList::const_iterator it = data.elements.begin();
+				it != data.elements.end(); ++it)
+			{
+				if (it->getSemantic() == VES_BLEND_WEIGHTS)
+				{
+					info.numBoneAssignments = VertexElement::getTypeCount(it->getType());
+					info.numBonesReferenced = compiled ? data.bones.size() : 0;
+					break;
+				}
+			}
+		}
+
+		void scanSubMesh(ChunkReader& reader, SubMeshInfo& info, ScannedVertexData& data,
+			RenderOperation::OperationType& operationType, size_t& indexCount)
+		{
+			info.materialName = reader.readString();
+			info.usesSharedVertices = reader.readBool();
+			indexCount = reader.readInt();
+			bool indexes32Bit = reader.readBool();
+			info.indexBitWidth = indexes32Bit ? 32 : 16;
+			reader.skip(indexCount * (indexes32Bit ? sizeof(uint32) : sizeof(uint16)));
+
+			operationType = RenderOperation::OT_TRIANGLE_LIST;
+			unsigned short id;
+			size_t chunkEnd;
+			while (reader.nextChunk(id, chunkEnd))
+			{
+				if (id == M_GEOMETRY)
+				{
+					scanGeometry(reader, data);
+				}
+				else if (id == M_SUBMESH_OPERATION)
+				{
+					operationType = static_cast<RenderOperation::OperationType>(reader.readShort());
+					reader.seek(chunkEnd);
+				}
+				else if (id == M_SUBMESH_BONE_ASSIGNMENT)
+				{
+					scanBoneAssignment(reader, data);
+					reader.seek(chunkEnd);
+				}
+				else if (id == M_SUBMESH_TEXTURE_ALIAS)
+				{
+					reader.seek(chunkEnd);
+				}
+				else
+				{
+					reader.backpedal();
+					break;
+				}
+			}
+		}
+
+		/// Returns the number of LOD levels besides the full detail one.
+		unsigned short scanLodInfo(ChunkReader& reader, MeshFormatVersion version,
+			size_t numSubMeshes, size_t chunkEnd)
+		{
+			if (version >= MESH_VERSION_1_41)
+			{
+				// LOD strategy name
+				reader.readString();
+			}
+			unsigned short numLevels = reader.readShort();
+
+			if (version >= MESH_VERSION_1_100)
+			{
+				// Since this version chunk sizes are exact.
+				reader.seek(chunkEnd);
+			}
+			else
+			{
+				bool manual = reader.readBool();
+				for (unsigned short i = 1; i < numLevels; ++i)
+				{
+					reader.expectChunk(M_MESH_LOD_USAGE);
+					reader.readFloat();
+					if (manual)
+					{
+						reader.seek(reader.expectChunk(M_MESH_LOD_MANUAL));
+					}
+					else
+					{
+						for (size_t j = 0; j < numSubMeshes; ++j)
+						{
+							reader.expectChunk(M_MESH_LOD_GENERATED);
+							uint32 indexCount = reader.readInt();
+							bool indexes32Bit = reader.readBool();
+							reader.skip(indexCount *
+								(indexes32Bit ? sizeof(uint32) : sizeof(uint16)));
+						}
+					}
+				}
+			}
+
+			return numLevels > 0 ? numLevels - 1 : 0;
+		}
+
+		void scanPoses(ChunkReader& reader, MeshFormatVersion version, MeshInfo& info)
+		{
+			unsigned short id;
+			size_t chunkEnd;
+			while (reader.nextChunk(id, chunkEnd))
+			{
+				if (id != M_POSE)
+				{
+					reader.backpedal();
+					break;
+				}
+				info.poseNames.push_back(reader.readString());
+				// target
+				reader.readShort();
+				if (version >= MESH_VERSION_1_8)
+				{
+					// includes normals
+					reader.readBool();
+				}
+
+				while (reader.nextChunk(id, chunkEnd))
+				{
+					if (id != M_POSE_VERTEX)
+					{
+						reader.backpedal();
+						break;
+					}
+					reader.seek(chunkEnd);
+				}
+			}
+		}
+
+		void scanAnimations(ChunkReader& reader, MeshInfo& info)
+		{
+			unsigned short id;
+			size_t chunkEnd;
+			while (reader.nextChunk(id, chunkEnd))
+			{
+				if (id != M_ANIMATION)
+				{
+					reader.backpedal();
+					break;
+				}
+				String name = reader.readString();
+				float length = reader.readFloat();
+				info.morphAnimations.push_back(std::make_pair(name, length));
+
+				while (reader.nextChunk(id, chunkEnd))
+				{
+					if (id == M_ANIMATION_BASEINFO)
+					{
+						reader.seek(chunkEnd);
+					}
+					else if (id == M_ANIMATION_TRACK)
+					{
+						// type and target
+						reader.skip(2 * sizeof(uint16));
+						while (reader.nextChunk(id, chunkEnd))
+						{
+							if (id == M_ANIMATION_MORPH_KEYFRAME)
+							{
+								reader.seek(chunkEnd);
+							}
+							else if (id == M_ANIMATION_POSE_KEYFRAME)
+							{
+								// time
+								reader.readFloat();
+								while (reader.nextChunk(id, chunkEnd))
+								{
+									if (id != M_ANIMATION_POSE_REF)
+									{
+										reader.backpedal();
+										break;
+									}
+									reader.seek(chunkEnd);
+								}
+							}
+							else
+							{
+								reader.backpedal();
+								break;
+							}
+						}
+					}
+					else
+					{
+						reader.backpedal();
+						break;
+					}
+				}
+			}
+		}
+	}
+    //------------------------------------------------------------------------
+
     InfoTool::InfoTool()
     {
     }
@@ -92,16 +600,54 @@ namespace meshmagick
             warn("info tool doesn't write anything. Output files are ignored.");
         }
 
+		const bool fastScan = OptionsUtil::isOptionSet(toolOptions, "fast");
+
         for (size_t i = 0, end = inFileNames.size(); i < end; ++i)
         {
             if (StringUtil::endsWith(inFileNames[i], ".mesh", true))
             {
-				MeshInfo meshInfo = processMesh(inFileNames[i]);
+				MeshInfo meshInfo;
+				bool scanned = false;
+				if (fastScan)
+				{
+					try
+					{
+						meshInfo = scanMesh(inFileNames[i]);
+						scanned = true;
+					}
+					catch (std::exception& e)
+					{
+						warn(e.what());
+						warn("fast scan failed, loading the whole mesh.");
+					}
+				}
+				if (!scanned)
+				{
+					meshInfo = processMesh(inFileNames[i]);
+				}
 				printMeshInfo(toolOptions, meshInfo);
             }
             else if (StringUtil::endsWith(inFileNames[i], ".skeleton", true))
             {
-				SkeletonInfo skeletonInfo = processSkeleton(inFileNames[i]);
+				SkeletonInfo skeletonInfo;
+				bool scanned = false;
+				if (fastScan)
+				{
+					try
+					{
+						skeletonInfo = scanSkeleton(inFileNames[i]);
+						scanned = true;
+					}
+					catch (std::exception& e)
+					{
+						warn(e.what());
+						warn("fast scan failed, loading the whole skeleton.");
+					}
+				}
+				if (!scanned)
+				{
+					skeletonInfo = processSkeleton(inFileNames[i]);
+				}
 				printSkeletonInfo(toolOptions, skeletonInfo);
             }
             else
@@ -109,6 +655,8 @@ namespace meshmagick
                 warn("unrecognised name ending for file " + inFileNames[i]);
                 warn("file skipped.");
             }
+
+            releaseFileResources();
         }
     }
     //------------------------------------------------------------------------
@@ -119,6 +667,14 @@ namespace meshmagick
             OgreEnvironment::getSingleton().getMeshSerializer();
 
         MeshPtr mesh = meshSerializer->loadMesh(meshFileName);
+		return getLoadedMeshInfo(mesh, meshFileName);
+	}
+    //------------------------------------------------------------------------
+
+	MeshInfo InfoTool::getLoadedMeshInfo(MeshPtr mesh, const Ogre::String& meshFileName) const
+	{
+        StatefulMeshSerializer* meshSerializer =
+            OgreEnvironment::getSingleton().getMeshSerializer();
 
 		MeshInfo info;
 		info.name = meshFileName;
@@ -130,10 +686,35 @@ namespace meshmagick
 	}
     //------------------------------------------------------------------------
 
+	bool InfoTool::supportsLoadedMeshes() const
+	{
+		return true;
+	}
+    //------------------------------------------------------------------------
+
+	void InfoTool::doBeginLoadedMeshes(const OptionList& toolOptions)
+	{
+		mToolOptions = toolOptions;
+	}
+    //------------------------------------------------------------------------
+
+	bool InfoTool::doProcessLoadedMesh(MeshPtr mesh, const Ogre::String& inFileName,
+		const Ogre::String&)
+	{
+		// Version and endianness are those of the file the mesh has been loaded from.
+		printMeshInfo(mToolOptions, getLoadedMeshInfo(mesh, inFileName));
+		return false;
+	}
+    //------------------------------------------------------------------------
+
 	void InfoTool::processMesh(MeshInfo& info, MeshPtr mesh) const
     {
         info.storedBoundingBox = mesh->getBounds();
 		info.actualBoundingBox = MeshUtils::getMeshAabb(mesh);
+		info.actualBoundingBoxValid = true;
+
+		info.hasEdgeList = mesh->isEdgeListBuilt();
+		info.numLodLevels = mesh->getNumLodLevels() - 1;
 
         // Build metadata for bone assignments
 		if (mesh->hasSkeleton())
@@ -153,7 +734,7 @@ namespace meshmagick
 			processBoneAssignmentData(info.sharedVertices, mesh->sharedVertexData,
 				mesh->sharedBlendIndexToBoneIndexMap);
             processVertexDeclaration(info.sharedVertices,
-				mesh->sharedVertexData->vertexDeclaration);
+				mesh->sharedVertexData->vertexDeclaration->getElements());
 			info.maxNumBoneAssignments =
 				std::max(info.maxNumBoneAssignments, info.sharedVertices.numBoneAssignments);
 			info.maxNumBonesReferenced =
@@ -175,27 +756,7 @@ namespace meshmagick
 
             subMeshInfo.name = it == subMeshNames.end() ? String() : it->first;
             processSubMesh(subMeshInfo, mesh->getSubMesh(i));
-			info.submeshes.push_back(subMeshInfo);
-
-			info.maxNumBoneAssignments =
-				std::max(info.maxNumBoneAssignments, subMeshInfo.vertices.numBoneAssignments);
-			info.maxNumBonesReferenced =
-				std::max(info.maxNumBonesReferenced, subMeshInfo.vertices.numBonesReferenced);
-
-			if (subMeshInfo.elementType == "triangles")
-			{
-				info.numTrianlges += subMeshInfo.numElements;
-			}
-			else if (subMeshInfo.elementType == "lines")
-			{
-				info.numLines += subMeshInfo.numElements;
-			}
-			else if (subMeshInfo.elementType == "points")
-			{
-				info.numPoints += subMeshInfo.numElements;
-			}
-			info.numElements += subMeshInfo.numElements;
-			info.numVertices += subMeshInfo.vertices.numVertices;
+			addSubMeshTotals(info, subMeshInfo);
         }
 
         // Animation detection
@@ -247,7 +808,8 @@ namespace meshmagick
         {
 			info.vertices.numVertices = submesh->vertexData->vertexCount;
 			processBoneAssignmentData(info.vertices, submesh->vertexData, submesh->blendIndexToBoneIndexMap);
-            processVertexDeclaration(info.vertices, submesh->vertexData->vertexDeclaration);
+            processVertexDeclaration(info.vertices,
+				submesh->vertexData->vertexDeclaration->getElements());
         }
 
         // indices
@@ -263,44 +825,94 @@ namespace meshmagick
 				info.indexBitWidth = 32;
             }
 
-			size_t numIndices = indexBuffer->getNumIndexes();
-			switch(submesh->operationType)
+			// 32 bit indices are only needed if the vertex data has more than 65535 vertices.
+			const VertexData* vd = submesh->useSharedVertices ?
+				submesh->parent->sharedVertexData : submesh->vertexData;
+			if (MeshUtils::getIndexType(vd->vertexCount) == HardwareIndexBuffer::IT_16BIT)
 			{
-			case RenderOperation::OT_LINE_LIST:
-				info.operationType = "OT_LINE_LIST";
-				info.numElements = numIndices / 2;
-				info.elementType = "lines";
-				break;
-			case RenderOperation::OT_LINE_STRIP:
-				info.operationType = "OT_LINE_STRIP";
-				info.numElements = numIndices / 2;
-				info.elementType = "lines";
-				break;
-			case RenderOperation::OT_POINT_LIST:
-				info.operationType = "OT_POINT_LIST";
-				info.numElements = numIndices;
-				info.elementType = "points";
-				break;
-			case RenderOperation::OT_TRIANGLE_FAN:
-				info.operationType = "OT_TRIANGLE_FAN";
-				info.numElements = numIndices - 2;
-				info.elementType = "triangles";
-				break;
-			case RenderOperation::OT_TRIANGLE_LIST:
-				info.operationType = "OT_TRIANGLE_LIST";
-				info.numElements = numIndices / 3;
-				info.elementType = "triangles";
-				break;
-			case RenderOperation::OT_TRIANGLE_STRIP:
-				info.operationType = "OT_TRIANGLE_STRIP";
-				info.numElements = numIndices - 2;
-				info.elementType = "triangles";
-				break;
+				std::vector<IndexData*> indexDatas(1, submesh->indexData);
+				indexDatas.insert(indexDatas.end(),
+					submesh->mLodFaceList.begin(), submesh->mLodFaceList.end());
+				for (size_t i = 0; i < indexDatas.size(); ++i)
+				{
+					// Same condition as MeshUtils::changeIndexType, shared buffers are kept.
+					if (MeshUtils::coversIndexBuffer(indexDatas[i]) &&
+						indexDatas[i]->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT)
+					{
+						info.indexBytesSavable += indexDatas[i]->indexCount *
+							(sizeof(uint32) - sizeof(uint16));
+					}
+				}
 			}
+
+			processOperationType(info, submesh->operationType, indexBuffer->getNumIndexes());
         }
     }
     //------------------------------------------------------------------------
 
+	void InfoTool::processOperationType(SubMeshInfo& info,
+		RenderOperation::OperationType operationType, size_t numIndices) const
+	{
+		switch(operationType)
+		{
+		case RenderOperation::OT_LINE_LIST:
+			info.operationType = "OT_LINE_LIST";
+			info.numElements = numIndices / 2;
+			info.elementType = "lines";
+			break;
+		case RenderOperation::OT_LINE_STRIP:
+			info.operationType = "OT_LINE_STRIP";
+			info.numElements = numIndices / 2;
+			info.elementType = "lines";
+			break;
+		case RenderOperation::OT_POINT_LIST:
+			info.operationType = "OT_POINT_LIST";
+			info.numElements = numIndices;
+			info.elementType = "points";
+			break;
+		case RenderOperation::OT_TRIANGLE_FAN:
+			info.operationType = "OT_TRIANGLE_FAN";
+			info.numElements = numIndices - 2;
+			info.elementType = "triangles";
+			break;
+		case RenderOperation::OT_TRIANGLE_LIST:
+			info.operationType = "OT_TRIANGLE_LIST";
+			info.numElements = numIndices / 3;
+			info.elementType = "triangles";
+			break;
+		case RenderOperation::OT_TRIANGLE_STRIP:
+			info.operationType = "OT_TRIANGLE_STRIP";
+			info.numElements = numIndices - 2;
+			info.elementType = "triangles";
+			break;
+		}
+	}
+    //------------------------------------------------------------------------
+
+	void InfoTool::addSubMeshTotals(MeshInfo& info, const SubMeshInfo& subMeshInfo) const
+	{
+		info.maxNumBoneAssignments =
+			std::max(info.maxNumBoneAssignments, subMeshInfo.vertices.numBoneAssignments);
+		info.maxNumBonesReferenced =
+			std::max(info.maxNumBonesReferenced, subMeshInfo.vertices.numBonesReferenced);
+
+		if (subMeshInfo.elementType == "triangles")
+		{
+			info.numTrianlges += subMeshInfo.numElements;
+		}
+		else if (subMeshInfo.elementType == "lines")
+		{
+			info.numLines += subMeshInfo.numElements;
+		}
+		else if (subMeshInfo.elementType == "points")
+		{
+			info.numPoints += subMeshInfo.numElements;
+		}
+		info.numElements += subMeshInfo.numElements;
+		info.numVertices += subMeshInfo.vertices.numVertices;
+	}
+    //------------------------------------------------------------------------
+
     SkeletonInfo InfoTool::processSkeleton(const String& skeletonFileName) const
 	{
 		SkeletonInfo info;
@@ -344,6 +956,236 @@ namespace meshmagick
     }
     //------------------------------------------------------------------------
 
+	MeshInfo InfoTool::scanMesh(const String& meshFileName) const
+	{
+		ChunkReader reader(meshFileName);
+
+		MeshInfo info;
+		info.name = meshFileName;
+		info.version = reader.readFileHeader();
+		const MeshFormatVersion version = getMeshFormatVersion(info.version);
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+		info.endian = getEndianModeAsString(reader.isEndianFlipped() ?
+			MeshSerializer::ENDIAN_LITTLE : MeshSerializer::ENDIAN_BIG);
+#else
+		info.endian = getEndianModeAsString(reader.isEndianFlipped() ?
+			MeshSerializer::ENDIAN_BIG : MeshSerializer::ENDIAN_LITTLE);
+#endif
+
+		ScannedVertexData sharedData;
+		std::vector<ScannedVertexData> subMeshData;
+		std::vector<std::pair<RenderOperation::OperationType, size_t> > subMeshIndices;
+
+		unsigned short id;
+		size_t chunkEnd;
+		while (reader.nextChunk(id, chunkEnd))
+		{
+			switch (id)
+			{
+			case M_MESH:
+				// Skeletally animated flag. The mesh's chunks follow as its sub chunks.
+				reader.readBool();
+				break;
+			case M_GEOMETRY:
+				info.hasSharedVertices = true;
+				scanGeometry(reader, sharedData);
+				break;
+			case M_SUBMESH:
+				{
+					info.submeshes.push_back(SubMeshInfo());
+					subMeshData.push_back(ScannedVertexData());
+					subMeshIndices.push_back(
+						std::make_pair(RenderOperation::OT_TRIANGLE_LIST, size_t(0)));
+					scanSubMesh(reader, info.submeshes.back(), subMeshData.back(),
+						subMeshIndices.back().first, subMeshIndices.back().second);
+				}
+				break;
+			case M_MESH_SKELETON_LINK:
+				info.hasSkeleton = true;
+				info.skeletonName = reader.readString();
+				reader.seek(chunkEnd);
+				break;
+			case M_MESH_BONE_ASSIGNMENT:
+				scanBoneAssignment(reader, sharedData);
+				reader.seek(chunkEnd);
+				break;
+			case M_MESH_LOD:
+				info.numLodLevels = scanLodInfo(reader, version, info.submeshes.size(), chunkEnd);
+				break;
+			case M_MESH_BOUNDS:
+				{
+					Vector3 minimum, maximum;
+					minimum.x = reader.readFloat();
+					minimum.y = reader.readFloat();
+					minimum.z = reader.readFloat();
+					maximum.x = reader.readFloat();
+					maximum.y = reader.readFloat();
+					maximum.z = reader.readFloat();
+					info.storedBoundingBox.setExtents(minimum, maximum);
+					reader.seek(chunkEnd);
+				}
+				break;
+			case M_SUBMESH_NAME_TABLE:
+				while (reader.nextChunk(id, chunkEnd))
+				{
+					if (id != M_SUBMESH_NAME_TABLE_ELEMENT)
+					{
+						reader.backpedal();
+						break;
+					}
+					unsigned short index = reader.readShort();
+					String name = reader.readString();
+					if (index < info.submeshes.size())
+					{
+						info.submeshes[index].name = name;
+					}
+				}
+				break;
+			case M_EDGE_LISTS:
+				info.hasEdgeList = true;
+				reader.seek(chunkEnd);
+				break;
+			case M_POSES:
+				scanPoses(reader, version, info);
+				break;
+			case M_ANIMATIONS:
+				scanAnimations(reader, info);
+				break;
+			default:
+				reader.seek(chunkEnd);
+				break;
+			}
+		}
+
+		// All chunks are read, now the bone assignments can be evaluated like after loading.
+		if (info.hasSharedVertices)
+		{
+			info.sharedVertices.numVertices = sharedData.vertexCount;
+			processBoneAssignments(info.sharedVertices, sharedData, info.hasSkeleton);
+			processVertexDeclaration(info.sharedVertices, sharedData.elements);
+			info.maxNumBoneAssignments = info.sharedVertices.numBoneAssignments;
+			info.maxNumBonesReferenced = info.sharedVertices.numBonesReferenced;
+			info.numVertices += info.sharedVertices.numVertices;
+		}
+
+		for (size_t i = 0; i < info.submeshes.size(); ++i)
+		{
+			SubMeshInfo& subMeshInfo = info.submeshes[i];
+			ScannedVertexData& data = subMeshData[i];
+			if (!subMeshInfo.usesSharedVertices)
+			{
+				subMeshInfo.vertices.numVertices = data.vertexCount;
+				processBoneAssignments(subMeshInfo.vertices, data, info.hasSkeleton);
+				processVertexDeclaration(subMeshInfo.vertices, data.elements);
+			}
+
+			// LOD index buffers aren't looked at, only the full detail one counts here.
+			// A submesh's indices are stored as a block of their own and load into a
+			// buffer of exactly indexCount indices starting at 0, so they always pass the
+			// MeshUtils::coversIndexBuffer test changeIndexType applies.
+			size_t vertexCount = subMeshInfo.usesSharedVertices ?
+				sharedData.vertexCount : data.vertexCount;
+			if (subMeshInfo.indexBitWidth == 32 &&
+				MeshUtils::getIndexType(vertexCount) == HardwareIndexBuffer::IT_16BIT)
+			{
+				subMeshInfo.indexBytesSavable =
+					subMeshIndices[i].second * (sizeof(uint32) - sizeof(uint16));
+			}
+
+			processOperationType(subMeshInfo, subMeshIndices[i].first, subMeshIndices[i].second);
+			addSubMeshTotals(info, subMeshInfo);
+		}
+
+        if (mFollowSkeletonLink && info.hasSkeleton)
+        {
+			try
+			{
+				info.skeleton = scanSkeleton(info.skeletonName);
+				info.skeletonValid = true;
+			}
+			catch (std::exception& e)
+			{
+				warn(e.what());
+				warn("Error processing skeleton. skipped.");
+				info.skeletonValid = false;
+			}
+        }
+
+		return info;
+	}
+    //------------------------------------------------------------------------
+
+	SkeletonInfo InfoTool::scanSkeleton(const String& skeletonFileName) const
+	{
+		ChunkReader reader(skeletonFileName);
+		reader.readFileHeader();
+
+		SkeletonInfo info;
+		info.name = skeletonFileName;
+
+		// Bones are listed by handle, like Skeleton::getBone(unsigned short) does.
+		std::map<unsigned short, String> bones;
+
+		unsigned short id;
+		size_t chunkEnd;
+		while (reader.nextChunk(id, chunkEnd))
+		{
+			if (id == SKELETON_BONE)
+			{
+				String name = reader.readString();
+				unsigned short handle = reader.readShort();
+				bones[handle] = name;
+				reader.seek(chunkEnd);
+			}
+			else if (id == SKELETON_ANIMATION)
+			{
+				String name = reader.readString();
+				float length = reader.readFloat();
+				info.animations.push_back(std::make_pair(name, length));
+
+				while (reader.nextChunk(id, chunkEnd))
+				{
+					if (id == SKELETON_ANIMATION_BASEINFO)
+					{
+						reader.seek(chunkEnd);
+					}
+					else if (id == SKELETON_ANIMATION_TRACK)
+					{
+						// bone handle
+						reader.readShort();
+						while (reader.nextChunk(id, chunkEnd))
+						{
+							if (id != SKELETON_ANIMATION_TRACK_KEYFRAME)
+							{
+								reader.backpedal();
+								break;
+							}
+							reader.seek(chunkEnd);
+						}
+					}
+					else
+					{
+						reader.backpedal();
+						break;
+					}
+				}
+			}
+			else
+			{
+				reader.seek(chunkEnd);
+			}
+		}
+
+		for (std::map<unsigned short, String>::const_iterator it = bones.begin();
+			it != bones.end(); ++it)
+		{
+			info.boneNames.push_back(it->second);
+		}
+
+		return info;
+	}
+    //------------------------------------------------------------------------
+
     String InfoTool::getEndianModeAsString(MeshSerializer::Endian endian) const
     {
         if (endian == MeshSerializer::ENDIAN_BIG)
@@ -381,7 +1223,8 @@ namespace meshmagick
 
 	/// @todo externalise this function, when reorganise-tool is integrated,
     /// because both use the same format
-    void InfoTool::processVertexDeclaration(VertexInfo& info, const VertexDeclaration* vd) const
+    void InfoTool::processVertexDeclaration(VertexInfo& info,
+		const VertexDeclaration::VertexElementList& elementList) const
     {
         // First: source-ID, second: offset
         typedef std::pair<unsigned short, size_t> ElementPosition;
@@ -395,7 +1238,6 @@ namespace meshmagick
         // Iterate over declaration elements and put them into the map.
         // We do this, because we don't know in what order the elements are stored, but
         // in order to create the layout string we need them in order of their source and offset.
-        const VertexDeclaration::VertexElementList& elementList = vd->getElements();
         for (VertexDeclaration::VertexElementList::const_iterator it = elementList.begin(),
             end = elementList.end(); it != end; ++it)
         {
@@ -534,6 +1376,7 @@ namespace meshmagick
 		size_t numTriangles = 0;
 		size_t numLines = 0;
 		size_t numPoints = 0;
+		size_t indexBytesSavable = 0;
 
 		// formatting helpers
 		const String& indent = "    ";
@@ -545,7 +1388,12 @@ namespace meshmagick
 		print("");
 
 		// bounding box(es)
-		if (meshInfo.actualBoundingBox == meshInfo.storedBoundingBox)
+		if (!meshInfo.actualBoundingBoxValid)
+		{
+			print("Stored bounding box: "
+				+ ToolUtils::getPrettyAabbString(meshInfo.storedBoundingBox));
+		}
+		else if (meshInfo.actualBoundingBox == meshInfo.storedBoundingBox)
 		{
 			print("Bounding box: "
 				+ ToolUtils::getPrettyAabbString(meshInfo.actualBoundingBox));
@@ -612,6 +1460,12 @@ namespace meshmagick
 			print(indent + StringConverter::toString(info.numElements)
 				+ " " + info.elementType);
 			print(indent + StringConverter::toString(info.indexBitWidth) + " bit index width");
+			if (info.indexBytesSavable > 0)
+			{
+				print(indent + StringConverter::toString(info.indexBytesSavable)
+					+ " bytes can be saved with 16 bit indices.");
+				indexBytesSavable += info.indexBytesSavable;
+			}
 
 			// Discriminate element type for total element counts
 			if (info.elementType == "triangles")
@@ -643,6 +1497,11 @@ namespace meshmagick
 		{
 			print(StringConverter::toString(numPoints) + " points in total.");
 		}
+		if (indexBytesSavable > 0)
+		{
+			print(StringConverter::toString(indexBytesSavable)
+				+ " index bytes can be saved in total, run optimise to convert.");
+		}
 		print("");
 
 		// Other mesh properties
@@ -754,6 +1613,7 @@ namespace meshmagick
 		submeshLevelFields.push_back("submesh_operation_type");
 		submeshLevelFields.push_back("submesh_element_count");
 		submeshLevelFields.push_back("submesh_index_width");
+		submeshLevelFields.push_back("submesh_index_bytes_savable");
 		bool submeshLevel = std::find_first_of(listFields.begin(), listFields.end(),
 			submeshLevelFields.begin(), submeshLevelFields.end()) != listFields.end();
 		if (submeshLevel)
@@ -794,7 +1654,7 @@ namespace meshmagick
 			{
 				out += ToolUtils::getPrettyAabbString(info.storedBoundingBox);
 			}
-			else if (field == "actual_bounding_box")
+			else if (field == "actual_bounding_box" && info.actualBoundingBoxValid)
 			{
 				out += ToolUtils::getPrettyAabbString(info.actualBoundingBox);
 			}
@@ -802,7 +1662,7 @@ namespace meshmagick
 			{
 				out += ToolUtils::getPrettyVectorString(info.storedBoundingBox.getSize());
 			}
-			else if (field == "actual_mesh_extent")
+			else if (field == "actual_mesh_extent" && info.actualBoundingBoxValid)
 			{
 				out += ToolUtils::getPrettyVectorString(info.actualBoundingBox.getSize());
 			}
@@ -918,6 +1778,10 @@ namespace meshmagick
 			{
 				out += StringConverter::toString(info.submeshes[submeshIndex].indexBitWidth);
 			}
+			else if (field == "submesh_index_bytes_savable")
+			{
+				out += StringConverter::toString(info.submeshes[submeshIndex].indexBytesSavable);
+			}
 			else if (field == "morph_animation_count")
 			{
 				out += StringConverter::toString(info.morphAnimations.size());
@@ -42,6 +42,7 @@ namespace meshmagick
         OptionDefinitionSet optionDefs;
         optionDefs.insert(OptionDefinition("list", OT_STRING));
         optionDefs.insert(OptionDefinition("delim", OT_STRING));
+        optionDefs.insert(OptionDefinition("fast", OT_BOOL, false, false));
         return optionDefs;
     }
 
@@ -50,6 +51,9 @@ namespace meshmagick
         out << "Print information about the mesh" << std::endl
             << "without further options, info tool prints informations in report style" << std::endl
 			<< "-delim=<delimiter> : delimiter character used by the -list option. Default is tab." << std::endl
+			<< "-fast : only scan the file's chunk headers instead of loading the geometry." << std::endl
+			<< "    The actual bounding box isn't available then and savable index bytes" << std::endl
+			<< "    don't include LOD levels. Files the scan can't handle are loaded fully." << std::endl
 			<< "-list=<field-key1>/<field-key2>/.. : print delim separated fields" << std::endl
 			<< "    The following field-keys are available:" << std::endl
 			<< std::endl
@@ -83,6 +87,7 @@ namespace meshmagick
 			<< "         submesh_line_count" << std::endl
 			<< "         submesh_point_count" << std::endl
 			<< "         submesh_index_width" << std::endl
+			<< "         submesh_index_bytes_savable" << std::endl
 			<< std::endl
 			<< "         max_bone_assignments" << std::endl
 			<< "         max_bone_references" << std::endl
@@ -114,4 +119,9 @@ namespace meshmagick
     {
         return "print information about the mesh.";
     }
+
+    bool InfoToolFactory::isCacheable() const
+    {
+        return false;
+    }
 }
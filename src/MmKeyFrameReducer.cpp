@@ -0,0 +1,171 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmKeyFrameReducer.h"
+
+#ifdef __APPLE__
+#	include <Ogre/OgreBone.h>
+#	include <Ogre/OgreKeyFrame.h>
+#else
+#	include <OgreBone.h>
+#	include <OgreKeyFrame.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Ogre;
+
+namespace
+{
+    Real getChainLength(const Bone* bone, std::vector<Real>& lengths)
+    {
+        Real childLength = 0;
+        for (unsigned short i = 0; i < bone->numChildren(); ++i)
+        {
+            const Bone* child = static_cast<const Bone*>(bone->getChild(i));
+            childLength = std::max(childLength, getChainLength(child, lengths));
+        }
+        const Real length = bone->getInitialPosition().length() + childLength;
+        lengths[bone->getHandle()] = length;
+        return length;
+    }
+
+    /// Angle between two rotations in degrees.
+    Real getAngle(const Quaternion& a, const Quaternion& b)
+    {
+        const Real norms = std::sqrt(a.Norm() * b.Norm());
+        if (norms <= 0)
+        {
+            return 0;
+        }
+        // q and -q are the same rotation.
+        const Real cosHalf = std::min(Real(1), std::abs(a.Dot(b)) / norms);
+        return Radian(2 * std::acos(cosHalf)).valueDegrees();
+    }
+}
+
+namespace meshmagick
+{
+    KeyFrameReducer::KeyFrameReducer(Real rotationError, Real translationError,
+        Real scaleError)
+        : mRotationError(rotationError),
+          mTranslationError(translationError),
+          mScaleError(scaleError)
+    {
+    }
+
+    std::vector<Real> KeyFrameReducer::getChainLengths(Skeleton* skeleton)
+    {
+        std::vector<Real> lengths(skeleton->getNumBones(), 0);
+        Real longest = 0;
+        Skeleton::BoneIterator it = skeleton->getRootBoneIterator();
+        while (it.hasMoreElements())
+        {
+            longest = std::max(longest, ::getChainLength(it.getNext(), lengths));
+        }
+        if (longest <= 0)
+        {
+            longest = 1;
+        }
+        for (size_t i = 0; i < lengths.size(); ++i)
+        {
+            if (lengths[i] <= 0)
+            {
+                lengths[i] = longest;
+            }
+        }
+        return lengths;
+    }
+
+    void KeyFrameReducer::findRedundantKeys(const NodeAnimationTrack* track,
+        Animation::RotationInterpolationMode rotationMode, Real chainLength,
+        std::vector<unsigned short>& redundantKeys) const
+    {
+        redundantKeys.clear();
+        const unsigned short numKeys = track->getNumKeyFrames();
+        const Real translationError = mTranslationError * chainLength;
+
+        // Extend the segment starting at the last kept key as far as possible, then keep
+        // the key ending it and start over from there.
+        unsigned short first = 0;
+        for (unsigned short last = 2; last < numKeys; ++last)
+        {
+            if (!isSegmentRedundant(track, rotationMode, translationError, first, last))
+            {
+                for (unsigned short k = first + 1; k < last - 1; ++k)
+                {
+                    redundantKeys.push_back(k);
+                }
+                first = last - 1;
+            }
+        }
+        if (numKeys > 2)
+        {
+            for (unsigned short k = first + 1; k < numKeys - 1; ++k)
+            {
+                redundantKeys.push_back(k);
+            }
+        }
+    }
+
+    bool KeyFrameReducer::isSegmentRedundant(const NodeAnimationTrack* track,
+        Animation::RotationInterpolationMode rotationMode, Real translationError,
+        unsigned short first, unsigned short last) const
+    {
+        const TransformKeyFrame* k0 = track->getNodeKeyFrame(first);
+        const TransformKeyFrame* k1 = track->getNodeKeyFrame(last);
+        const Real duration = k1->getTime() - k0->getTime();
+        if (duration <= 0)
+        {
+            return false;
+        }
+        const bool shortestPath = track->getUseShortestRotationPath();
+
+        for (unsigned short k = first + 1; k < last; ++k)
+        {
+            const TransformKeyFrame* key = track->getNodeKeyFrame(k);
+            const Real t = (key->getTime() - k0->getTime()) / duration;
+
+            const Vector3 translate =
+                k0->getTranslate() + (k1->getTranslate() - k0->getTranslate()) * t;
+            if (translate.distance(key->getTranslate()) > translationError)
+            {
+                return false;
+            }
+
+            const Vector3 scale = k0->getScale() + (k1->getScale() - k0->getScale()) * t;
+            const Vector3 scaleDiff = scale - key->getScale();
+            if (std::max(std::abs(scaleDiff.x), std::max(std::abs(scaleDiff.y),
+                std::abs(scaleDiff.z))) > mScaleError)
+            {
+                return false;
+            }
+
+            const Quaternion rotation = rotationMode == Animation::RIM_LINEAR ?
+                Quaternion::nlerp(t, k0->getRotation(), k1->getRotation(), shortestPath) :
+                Quaternion::Slerp(t, k0->getRotation(), k1->getRotation(), shortestPath);
+            if (getAngle(rotation, key->getRotation()) > mRotationError)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,380 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmLodTool.h"
+
+#include <OgreHardwareBufferManager.h>
+#include <OgreLodStrategyManager.h>
+#include <OgreStringConverter.h>
+#include <OgreSubMesh.h>
+
+#include <algorithm>
+#include <functional>
+
+#include "MmEdgeDataBuilder.h"
+#include "MmMeshSimplifier.h"
+#include "MmMeshUtils.h"
+#include "MmOgreEnvironment.h"
+#include "MmStatefulMeshSerializer.h"
+#include "MmThreadPool.h"
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    LodTool::LodTool()
+        : mStrategy(LS_DISTANCE),
+          mValues(),
+          mNumLevels(3),
+          mReduction(0.5),
+          mNumThreads(1),
+          mStripEdgeLists(false)
+    {
+    }
+
+    Ogre::String LodTool::getName() const
+    {
+        return "lod";
+    }
+
+    void LodTool::setOptions(const OptionList& toolOptions)
+    {
+        mStrategy = OptionsUtil::getStringOption(toolOptions, "strategy", "distance") ==
+            "pixel_count" ? LS_PIXEL_COUNT : LS_DISTANCE;
+        mValues.clear();
+        mNumLevels = 3;
+        mReduction = 0.5;
+        mNumThreads = ThreadPool::getHardwareThreadCount();
+        mStripEdgeLists = OptionsUtil::isOptionSet(toolOptions, "no-edge-lists");
+        for (OptionList::const_iterator it = toolOptions.begin(); it != toolOptions.end(); ++it)
+        {
+            if (it->first == "levels")
+            {
+                int numLevels = any_cast<int>(it->second);
+                if (numLevels < 1)
+                {
+                    fail("levels must be at least 1.");
+                }
+                mNumLevels = static_cast<size_t>(numLevels);
+            }
+            else if (it->first == "reduction")
+            {
+                mReduction = any_cast<Real>(it->second);
+                if (mReduction <= 0 || mReduction >= 1)
+                {
+                    fail("reduction must be greater than 0 and less than 1.");
+                }
+            }
+            else if (it->first == "values")
+            {
+                StringVector values = StringUtil::split(any_cast<String>(it->second), "/");
+                for (size_t i = 0; i < values.size(); ++i)
+                {
+                    mValues.push_back(StringConverter::parseReal(values[i]));
+                }
+                if (mValues.empty())
+                {
+                    fail("values needs at least one value.");
+                }
+            }
+            else if (it->first == "threads")
+            {
+                int numThreads = any_cast<int>(it->second);
+                if (numThreads > 0)
+                {
+                    mNumThreads = static_cast<size_t>(numThreads);
+                }
+            }
+        }
+    }
+
+    void LodTool::doInvoke(const OptionList& toolOptions,
+        const StringVector& inFileNames, const StringVector& outFileNamesArg)
+    {
+        // Name count has to match, else we have no way to figure out how to apply output
+        // names to input files.
+        if (!(outFileNamesArg.empty() || inFileNames.size() == outFileNamesArg.size()))
+        {
+            fail("number of output files must match number of input files.");
+        }
+
+        setOptions(toolOptions);
+
+        StringVector outFileNames = outFileNamesArg.empty() ? inFileNames : outFileNamesArg;
+
+        for (size_t i = 0, end = inFileNames.size(); i < end; ++i)
+        {
+            if (StringUtil::endsWith(inFileNames[i], ".mesh", true))
+            {
+                processMeshFile(inFileNames[i], outFileNames[i]);
+            }
+            else
+            {
+                warn("unrecognised name ending for file " + inFileNames[i]);
+                warn("file skipped.");
+            }
+
+            releaseFileResources();
+        }
+    }
+
+    void LodTool::processMeshFile(Ogre::String inFile, Ogre::String outFile)
+    {
+        StatefulMeshSerializer* meshSerializer =
+            OgreEnvironment::getSingleton().getMeshSerializer();
+
+        print("Loading mesh " + inFile + "...");
+        MeshPtr mesh;
+        try
+        {
+            mesh = meshSerializer->loadMesh(inFile);
+        }
+        catch(std::exception& e)
+        {
+            warn(e.what());
+            warn("Unable to open mesh file " + inFile);
+            warn("file skipped.");
+            return;
+        }
+
+        print("Generating LOD levels...");
+        doProcessLoadedMesh(mesh, inFile, outFile);
+        meshSerializer->saveMesh(outFile, true);
+        print("Mesh saved as " + outFile + ".");
+    }
+
+    bool LodTool::supportsLoadedMeshes() const
+    {
+        return true;
+    }
+
+    void LodTool::doBeginLoadedMeshes(const OptionList& toolOptions)
+    {
+        setOptions(toolOptions);
+    }
+
+    bool LodTool::doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String&,
+        const Ogre::String&)
+    {
+        generateLods(mesh, mStrategy, mValues.empty() ? getDefaultValues(mesh) : mValues);
+        return true;
+    }
+
+    std::vector<Real> LodTool::getDefaultValues(MeshPtr mesh) const
+    {
+        std::vector<Real> values;
+        const Real radius = mesh->getBoundingSphereRadius() > 0 ?
+            mesh->getBoundingSphereRadius() : 1;
+        for (size_t i = 1; i <= mNumLevels; ++i)
+        {
+            if (mStrategy == LS_DISTANCE)
+            {
+                // Each level is used from twice the distance of the previous one.
+                values.push_back(radius * 10 * Real(1 << (i - 1)));
+            }
+            else
+            {
+                // Halving the distance quarters the pixel count.
+                values.push_back(Real(100000) / Real(1 << (2 * (i - 1))));
+            }
+        }
+        return values;
+    }
+
+    void LodTool::generateLods(MeshPtr mesh, LodStrategyType strategy,
+        const std::vector<Real>& valuesArg)
+    {
+        std::vector<Real> values = valuesArg;
+        if (strategy == LS_DISTANCE)
+        {
+            std::sort(values.begin(), values.end());
+        }
+        else
+        {
+            std::sort(values.begin(), values.end(), std::greater<Real>());
+        }
+        // The old names work with all supported Ogre versions.
+        LodStrategy* lodStrategy = LodStrategyManager::getSingleton().getStrategy(
+            strategy == LS_DISTANCE ? "Distance" : "PixelCount");
+        if (lodStrategy == 0)
+        {
+            fail("LOD strategy not available.");
+        }
+
+        if (mesh->isLodManual())
+        {
+            warn("Manual LOD levels are replaced by generated ones.");
+        }
+        const bool hadEdgeList = mesh->isEdgeListBuilt();
+        if (hadEdgeList)
+        {
+            // LOD levels can't be changed while edge lists exist.
+            mesh->freeEdgeList();
+        }
+        mesh->removeLodLevels();
+
+        // Read vertex data up front, locking buffers isn't thread safe.
+        VertexInput sharedInput;
+        if (mesh->sharedVertexData != 0)
+        {
+            readVertexInput(mesh->sharedVertexData, mesh->getBoneAssignments(), sharedInput);
+        }
+        std::vector<VertexInput> dedicatedInputs(mesh->getNumSubMeshes());
+        std::vector<SubMeshJob> jobs(mesh->getNumSubMeshes());
+        for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+        {
+            SubMesh* sm = mesh->getSubMesh(i);
+            SubMeshJob& job = jobs[i];
+            job.subMesh = sm;
+            if (sm->useSharedVertices)
+            {
+                job.input = &sharedInput;
+            }
+            else
+            {
+                readVertexInput(sm->vertexData, sm->getBoneAssignments(), dedicatedInputs[i]);
+                job.input = &dedicatedInputs[i];
+            }
+            MeshUtils::getIndices(sm->indexData, job.indices);
+        }
+
+        ThreadPool pool(std::max<size_t>(1, std::min(mNumThreads, jobs.size())));
+        print("Simplifying " + StringConverter::toString(jobs.size()) + " submeshes on " +
+            StringConverter::toString(pool.getNumThreads()) + " threads...", V_HIGH);
+        const size_t numLevels = values.size();
+        pool.run(jobs.size(), [this, &jobs, numLevels](size_t i) {
+            simplify(jobs[i], numLevels);
+        });
+
+        mesh->_setLodInfo(static_cast<unsigned short>(numLevels + 1)
+#if OGRE_VERSION < 0x10A00
+            , false
+#endif
+            );
+        mesh->setLodStrategy(lodStrategy);
+        for (size_t level = 1; level <= numLevels; ++level)
+        {
+            MeshLodUsage usage;
+            usage.userValue = values[level - 1];
+            usage.value = lodStrategy->transformUserValue(usage.userValue);
+            usage.edgeData = 0;
+            mesh->_setLodUsage(static_cast<unsigned short>(level), usage);
+        }
+
+        for (unsigned short i = 0; i < jobs.size(); ++i)
+        {
+            const SubMeshJob& job = jobs[i];
+            const HardwareIndexBufferSharedPtr& ib = job.subMesh->indexData->indexBuffer;
+            String counts = StringConverter::toString(job.indices.size() / 3);
+            for (size_t level = 1; level <= numLevels; ++level)
+            {
+                const std::vector<uint32>& indices = job.levels[level - 1];
+                IndexData* lodData = new IndexData();
+                lodData->indexStart = 0;
+                lodData->indexCount = indices.size();
+                if (!indices.empty())
+                {
+                    lodData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+                        ib->getType(), indices.size(), ib->getUsage(), ib->hasShadowBuffer());
+                    MeshUtils::setIndices(lodData, indices);
+                }
+                mesh->_setSubMeshLodFaceList(i, static_cast<unsigned short>(level), lodData);
+                counts += " / " + StringConverter::toString(indices.size() / 3);
+            }
+            print("    submesh " + StringConverter::toString(i) + ": " + counts + " triangles");
+        }
+
+        if (hadEdgeList && mStripEdgeLists)
+        {
+            print("Edge lists removed.");
+        }
+        else if (hadEdgeList)
+        {
+            EdgeDataBuilder::buildEdgeLists(mesh, mNumThreads);
+        }
+    }
+
+    void LodTool::readVertexInput(VertexData* vertexData,
+        const Mesh::VertexBoneAssignmentList& boneAssignments, VertexInput& input) const
+    {
+        MeshUtils::getPositions(vertexData, input.positions);
+
+        // Identify each vertex' set of influencing bones by a hash.
+        input.skinKeys.clear();
+        if (boneAssignments.empty())
+        {
+            return;
+        }
+        input.skinKeys.assign(vertexData->vertexCount, 0);
+        std::vector<unsigned short> bones;
+        Mesh::VertexBoneAssignmentList::const_iterator it = boneAssignments.begin();
+        while (it != boneAssignments.end())
+        {
+            const size_t vertex = it->first;
+            bones.clear();
+            for (; it != boneAssignments.end() && it->first == vertex; ++it)
+            {
+                if (it->second.weight > 0)
+                {
+                    bones.push_back(it->second.boneIndex);
+                }
+            }
+            std::sort(bones.begin(), bones.end());
+            // FNV-1a
+            uint32 key = 2166136261u;
+            for (size_t i = 0; i < bones.size(); ++i)
+            {
+                key = (key ^ bones[i]) * 16777619u;
+            }
+            if (vertex < input.skinKeys.size())
+            {
+                input.skinKeys[vertex] = key;
+            }
+        }
+    }
+
+    void LodTool::simplify(SubMeshJob& job, size_t numLevels) const
+    {
+        job.levels.resize(numLevels);
+        if (job.subMesh->operationType != RenderOperation::OT_TRIANGLE_LIST ||
+            job.input->positions.empty())
+        {
+            // Only triangle lists are simplified, other levels use the full detail indices.
+            for (size_t level = 0; level < numLevels; ++level)
+            {
+                job.levels[level] = job.indices;
+            }
+            return;
+        }
+
+        MeshSimplifier simplifier(job.input->positions, job.input->skinKeys, job.indices);
+        Real target = static_cast<Real>(simplifier.getTriangleCount());
+        for (size_t level = 0; level < numLevels; ++level)
+        {
+            target *= 1 - mReduction;
+            simplifier.simplify(static_cast<size_t>(target));
+            job.levels[level] = simplifier.getIndices();
+            if (job.levels[level].empty())
+            {
+                // Nothing left to show, keep the previous level.
+                job.levels[level] = level > 0 ? job.levels[level - 1] : job.indices;
+            }
+        }
+    }
+}
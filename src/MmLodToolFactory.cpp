@@ -0,0 +1,96 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmLodToolFactory.h"
+#include "MmLodTool.h"
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    //------------------------------------------------------------------------
+    Tool* LodToolFactory::createTool()
+    {
+        Tool* tool = new LodTool();
+        return tool;
+    }
+    //------------------------------------------------------------------------
+
+    void LodToolFactory::destroyTool(Tool* tool)
+    {
+        delete tool;
+    }
+    //------------------------------------------------------------------------
+
+    OptionDefinitionSet LodToolFactory::getOptionDefinitions() const
+    {
+        OptionDefinitionSet optionDefs;
+        optionDefs.insert(OptionDefinition("levels", OT_INT, false, false, Any(3)));
+        optionDefs.insert(OptionDefinition("reduction", OT_REAL, false, false, Any(Real(0.5))));
+        optionDefs.insert(OptionDefinition("strategy", OT_SELECTION, false, false,
+            Any(String("distance")), ";distance;pixel_count"));
+        optionDefs.insert(OptionDefinition("values", OT_STRING));
+        optionDefs.insert(OptionDefinition("threads", OT_INT, false, false, Any(0)));
+        optionDefs.insert(OptionDefinition("no-edge-lists", OT_BOOL, false, false));
+        return optionDefs;
+    }
+    //------------------------------------------------------------------------
+
+    void LodToolFactory::printToolHelp(std::ostream& out) const
+    {
+        out << std::endl;
+        out << "Generates LOD levels by simplifying the submeshes" << std::endl << std::endl;
+        out << "options:" << std::endl;
+        out << "   -levels=n - number of LOD levels below full detail (default 3)" << std::endl;
+        out << "   -reduction=val - fraction of the triangles removed per level (default 0.5)"
+            << std::endl;
+        out << "   -strategy=distance|pixel_count - LOD strategy (default distance)"
+            << std::endl;
+        out << "   -values=v1/v2/... - distances or pixel counts of the levels. Overrides"
+            << std::endl;
+        out << "       -levels. By default distances start at 10 times the bounding radius,"
+            << std::endl;
+        out << "       pixel counts at 100000, and each level doubles the distance."
+            << std::endl;
+        out << "   -no-edge-lists - remove edge lists instead of rebuilding them, for meshes"
+            << std::endl;
+        out << "       never casting stencil shadows." << std::endl;
+        out << "   -threads=n - number of threads simplifying submeshes concurrently."
+            << std::endl;
+        out << "       Defaults to the number of hardware threads, 1 disables threading."
+            << std::endl;
+        out << "UV seams, hard edges, open borders and skinning boundaries are preserved."
+            << std::endl;
+        out << "Existing LOD levels are replaced." << std::endl
+            << std::endl;
+    }
+    //------------------------------------------------------------------------
+
+    Ogre::String LodToolFactory::getToolName() const
+    {
+        return "lod";
+    }
+    //------------------------------------------------------------------------
+
+    Ogre::String LodToolFactory::getToolDescription() const
+    {
+        return "Generate LOD levels.";
+    }
+    //------------------------------------------------------------------------
+}
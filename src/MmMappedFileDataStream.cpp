@@ -0,0 +1,178 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmMappedFileDataStream.h"
+
+#include <fstream>
+#include <ios>
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    namespace
+    {
+        /// Maps the whole file read-only. Returns 0 and leaves size untouched if the
+        /// file exists but can't be mapped, throws if it can't be opened at all.
+        void* mapFile(const String& fileName, size_t& size)
+        {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+            HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                throw std::ios_base::failure(("cannot open file " + fileName).c_str());
+            }
+
+            void* mapping = 0;
+            LARGE_INTEGER fileSize;
+            if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+            {
+                HANDLE mappingHandle = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+                if (mappingHandle != 0)
+                {
+                    // The view keeps the mapping alive, so both handles can go right away.
+                    mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+                    CloseHandle(mappingHandle);
+                }
+                if (mapping != 0)
+                {
+                    size = static_cast<size_t>(fileSize.QuadPart);
+                }
+            }
+            CloseHandle(file);
+            return mapping;
+#else
+            int fd = ::open(fileName.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw std::ios_base::failure(("cannot open file " + fileName).c_str());
+            }
+
+            void* mapping = 0;
+            struct stat st;
+            if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+            {
+                void* p = mmap(0, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED)
+                {
+                    mapping = p;
+                    size = static_cast<size_t>(st.st_size);
+#ifdef MADV_SEQUENTIAL
+                    // Serializers read front to back, let the kernel read ahead aggressively.
+                    madvise(mapping, size, MADV_SEQUENTIAL);
+#endif
+                }
+            }
+            // The mapping holds its own reference to the file.
+            ::close(fd);
+            return mapping;
+#endif
+        }
+
+        void unmapFile(void* mapping, size_t size)
+        {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+            (void)size;
+            UnmapViewOfFile(mapping);
+#else
+            munmap(mapping, size);
+#endif
+        }
+    }
+
+    DataStreamPtr MappedFileDataStream::open(const String& fileName)
+    {
+        size_t size = 0;
+        void* mapping = mapFile(fileName, size);
+        if (mapping != 0)
+        {
+            return DataStreamPtr(new MappedFileDataStream(fileName, mapping, size));
+        }
+
+        // Not mappable. Read it into memory in one go, the serializer gets the same
+        // kind of stream either way.
+        std::ifstream ifs;
+        ifs.open(fileName.c_str(), std::ios_base::in | std::ios_base::binary);
+        if (!ifs)
+        {
+            throw std::ios_base::failure(("cannot open file " + fileName).c_str());
+        }
+        ifs.seekg(0, std::ios_base::end);
+        std::streamoff fileSize = ifs.tellg();
+        ifs.seekg(0, std::ios_base::beg);
+        if (fileSize < 0)
+        {
+            throw std::ios_base::failure(("cannot read file " + fileName).c_str());
+        }
+
+        MemoryDataStream* stream = new MemoryDataStream(fileName,
+            static_cast<size_t>(fileSize), true, false);
+        DataStreamPtr streamPtr(stream);
+        ifs.read(reinterpret_cast<char*>(stream->getPtr()), fileSize);
+        if (ifs.gcount() != fileSize)
+        {
+            throw std::ios_base::failure(("cannot read file " + fileName).c_str());
+        }
+        return streamPtr;
+    }
+
+    MappedFileDataStream::MappedFileDataStream(const String& fileName, void* mapping, size_t size)
+        : MemoryDataStream(fileName, mapping, size, false, true),
+          mMapping(mapping),
+          mMappingSize(size)
+    {
+    }
+
+    MappedFileDataStream::~MappedFileDataStream()
+    {
+        unmap();
+    }
+
+    void MappedFileDataStream::close()
+    {
+        MemoryDataStream::close();
+        unmap();
+    }
+
+    void MappedFileDataStream::unmap()
+    {
+        if (mMapping != 0)
+        {
+            unmapFile(mMapping, mMappingSize);
+            mMapping = 0;
+            mMappingSize = 0;
+        }
+    }
+}
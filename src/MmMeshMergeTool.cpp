@@ -19,14 +19,22 @@
 
 #include "MmMeshMergeTool.h"
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
 #include <stdexcept>
 #include <OgreAnimation.h>
 #include <OgreAxisAlignedBox.h>
 #include <OgreHardwareBufferManager.h>
 #include <OgreMeshManager.h>
 #include <OgreSkeletonManager.h>
+#include <OgreStringConverter.h>
 #include <OgreSubMesh.h>
 
+#include "MmBuildCache.h"
+#include "MmEdgeDataBuilder.h"
+#include "MmMeshUtils.h"
 #include "MmOgreEnvironment.h"
 
 using namespace Ogre;
@@ -44,10 +52,251 @@ using namespace Ogre;
 #define OGRE_GETPOINTER(_sharedPtr) ((_sharedPtr).getPointer())
 #endif
 
+namespace
+{
+	bool isMergeable(const SubMesh* sm)
+	{
+		// Shared vertices cannot be moved, strips and fans cannot simply be appended.
+		return !sm->useSharedVertices &&
+			sm->operationType == RenderOperation::OT_TRIANGLE_LIST &&
+			sm->indexData->indexCount > 0 &&
+			sm->mLodFaceList.empty();
+	}
+
+	bool isVertexLayoutEqual(const VertexData* a, const VertexData* b)
+	{
+		const VertexDeclaration::VertexElementList& elemsA = a->vertexDeclaration->getElements();
+		const VertexDeclaration::VertexElementList& elemsB = b->vertexDeclaration->getElements();
+		if (elemsA.size() != elemsB.size())
+		{
+			return false;
+		}
+		for (VertexDeclaration::VertexElementList::const_iterator ia = elemsA.begin(),
+			ib = elemsB.begin(); ia != elemsA.end(); ++ia, ++ib)
+		{
+			if (ia->getSource() != ib->getSource() || ia->getOffset() != ib->getOffset() ||
+				ia->getType() != ib->getType() || ia->getSemantic() != ib->getSemantic() ||
+				ia->getIndex() != ib->getIndex())
+			{
+				return false;
+			}
+		}
+
+		// Buffers may be padded, so their vertex sizes have to match as well.
+		const VertexBufferBinding::VertexBufferBindingMap& bindingsA =
+			a->vertexBufferBinding->getBindings();
+		if (bindingsA.size() != b->vertexBufferBinding->getBufferCount())
+		{
+			return false;
+		}
+		for (VertexBufferBinding::VertexBufferBindingMap::const_iterator it = bindingsA.begin();
+			it != bindingsA.end(); ++it)
+		{
+			if (!b->vertexBufferBinding->isBufferBound(it->first) ||
+				b->vertexBufferBinding->getBuffer(it->first)->getVertexSize() !=
+				it->second->getVertexSize())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// Maps a vertex track or pose target of a merged mesh to the target in the new mesh.
+	/// handle 0 targets the shared vertices, handle i > 0 targets submesh i - 1.
+	ushort retargetHandle(ushort handle, ushort subMeshBase)
+	{
+		return handle == 0 ? 0 : static_cast<ushort>(subMeshBase + handle);
+	}
+
+	/// Influence of each pose referenced by a pose keyframe, by pose index.
+	typedef std::map<ushort, Real> PoseInfluences;
+	typedef std::vector<std::pair<Real, PoseInfluences> > PoseKeyFrames;
+
+	/// Reads the keyframes of a pose track, mapping pose indices through poseIndices if given.
+	PoseKeyFrames getPoseKeyFrames(VertexAnimationTrack* track,
+		const std::vector<ushort>* poseIndices)
+	{
+		PoseKeyFrames keyFrames;
+		for (ushort k = 0; k < track->getNumKeyFrames(); ++k)
+		{
+			const VertexPoseKeyFrame* kf = track->getVertexPoseKeyFrame(k);
+			keyFrames.push_back(std::make_pair(kf->getTime(), PoseInfluences()));
+			const VertexPoseKeyFrame::PoseRefList& refs = kf->getPoseReferences();
+			for (VertexPoseKeyFrame::PoseRefList::const_iterator ref = refs.begin();
+				ref != refs.end(); ++ref)
+			{
+				const ushort poseIndex = poseIndices ? (*poseIndices)[ref->poseIndex] : ref->poseIndex;
+				keyFrames.back().second[poseIndex] += ref->influence;
+			}
+		}
+		return keyFrames;
+	}
+
+	/** Pose influences of keyFrames at time, interpolated the way Ogre plays pose tracks.
+	@remarks
+		Past the last keyframe Ogre wraps around to the first one at length. Times past
+		length are taken modulo length, as when the animation loops.
+	*/
+	PoseInfluences getPoseInfluences(const PoseKeyFrames& keyFrames, Real time, Real length)
+	{
+		if (length > 0 && time >= length)
+		{
+			time = std::fmod(time, length);
+		}
+
+		size_t next = 0;
+		while (next < keyFrames.size() && keyFrames[next].first <= time)
+		{
+			++next;
+		}
+		if (next == 0)
+		{
+			return keyFrames.empty() ? PoseInfluences() : keyFrames.front().second;
+		}
+
+		const std::pair<Real, PoseInfluences>& key1 = keyFrames[next - 1];
+		const std::pair<Real, PoseInfluences>& key2 =
+			next < keyFrames.size() ? keyFrames[next] : keyFrames.front();
+		const Real time2 = next < keyFrames.size() ? key2.first : length + key2.first;
+		if (key1.first == time || time2 <= key1.first)
+		{
+			return key1.second;
+		}
+
+		const Real t = (time - key1.first) / (time2 - key1.first);
+		PoseInfluences influences;
+		for (PoseInfluences::const_iterator it = key1.second.begin(); it != key1.second.end(); ++it)
+		{
+			influences[it->first] += (1 - t) * it->second;
+		}
+		for (PoseInfluences::const_iterator it = key2.second.begin(); it != key2.second.end(); ++it)
+		{
+			influences[it->first] += t * it->second;
+		}
+		return influences;
+	}
+
+	/** Adds the pose references of source to the pose track target.
+	@remarks
+		Both tracks animate the shared vertices, but through different poses. The merged
+		track has a keyframe at each time either track has one, holding the influences of
+		both tracks at that time.
+	@param poseIndices index in target's mesh of each pose source refers to.
+	@param targetLength length of target's animation.
+	@param sourceLength length of source's animation, each track wraps around at its own.
+	*/
+	void mergePoseTracks(VertexAnimationTrack* target, VertexAnimationTrack* source,
+		const std::vector<ushort>& poseIndices, Real targetLength, Real sourceLength)
+	{
+		const PoseKeyFrames targetKeyFrames = getPoseKeyFrames(target, NULL);
+		const PoseKeyFrames sourceKeyFrames = getPoseKeyFrames(source, &poseIndices);
+		std::set<Real> times;
+		for (size_t k = 0; k < targetKeyFrames.size(); ++k)
+		{
+			times.insert(targetKeyFrames[k].first);
+		}
+		for (size_t k = 0; k < sourceKeyFrames.size(); ++k)
+		{
+			times.insert(sourceKeyFrames[k].first);
+		}
+
+		target->removeAllKeyFrames();
+		for (std::set<Real>::const_iterator time = times.begin(); time != times.end(); ++time)
+		{
+			VertexPoseKeyFrame* kf = target->createVertexPoseKeyFrame(*time);
+			const PoseKeyFrames* tracks[] = { &targetKeyFrames, &sourceKeyFrames };
+			const Real lengths[] = { targetLength, sourceLength };
+			for (size_t i = 0; i < 2; ++i)
+			{
+				const PoseInfluences influences =
+					getPoseInfluences(*tracks[i], *time, lengths[i]);
+				for (PoseInfluences::const_iterator it = influences.begin();
+					it != influences.end(); ++it)
+				{
+					if (it->second != 0)
+					{
+						kf->addPoseReference(it->first, it->second);
+					}
+				}
+			}
+		}
+	}
+
+	/** Replaces the buffers of target by buffers holding the vertices of all sources in order.
+	@remarks
+		All sources must have target's vertex layout, target may be one of them.
+	*/
+	void concatenateVertexData(VertexData* target, const std::vector<const VertexData*>& sources)
+	{
+		size_t vertexCount = 0;
+		for (size_t i = 0; i < sources.size(); ++i)
+		{
+			vertexCount += sources[i]->vertexCount;
+		}
+
+		typedef std::map<unsigned short, HardwareVertexBufferSharedPtr> BufferMap;
+		BufferMap newBuffers;
+		const VertexBufferBinding::VertexBufferBindingMap& bindings =
+			target->vertexBufferBinding->getBindings();
+		for (VertexBufferBinding::VertexBufferBindingMap::const_iterator it = bindings.begin();
+			it != bindings.end(); ++it)
+		{
+			const size_t vertexSize = it->second->getVertexSize();
+			HardwareVertexBufferSharedPtr newBuffer =
+				HardwareBufferManager::getSingleton().createVertexBuffer(vertexSize, vertexCount,
+				it->second->getUsage(), it->second->hasShadowBuffer());
+			unsigned char* dest = static_cast<unsigned char*>(
+				newBuffer->lock(HardwareBuffer::HBL_DISCARD));
+			for (size_t i = 0; i < sources.size(); ++i)
+			{
+				const VertexData* src = sources[i];
+				src->vertexBufferBinding->getBuffer(it->first)->readData(
+					src->vertexStart * vertexSize, src->vertexCount * vertexSize, dest);
+				dest += src->vertexCount * vertexSize;
+			}
+			newBuffer->unlock();
+			newBuffers[it->first] = newBuffer;
+		}
+
+		// Rebind only now, target's own buffers may have been read above.
+		for (BufferMap::const_iterator it = newBuffers.begin(); it != newBuffers.end(); ++it)
+		{
+			target->vertexBufferBinding->setBinding(it->first, it->second);
+		}
+		target->vertexStart = 0;
+		target->vertexCount = vertexCount;
+	}
+
+	/// Adds offset to all indices, using a new index buffer wide enough for the result.
+	void offsetIndices(IndexData* id, size_t offset)
+	{
+		std::vector<uint32> indices;
+		meshmagick::MeshUtils::getIndices(id, indices);
+		uint32 maxIndex = 0;
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			indices[i] += static_cast<uint32>(offset);
+			maxIndex = std::max(maxIndex, indices[i]);
+		}
+
+		HardwareIndexBufferSharedPtr oldBuffer = id->indexBuffer;
+		HardwareIndexBuffer::IndexType type = oldBuffer->getType();
+		if (maxIndex > 0xffff)
+		{
+			type = HardwareIndexBuffer::IT_32BIT;
+		}
+		id->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+			type, id->indexCount, oldBuffer->getUsage(), oldBuffer->hasShadowBuffer());
+		id->indexStart = 0;
+		meshmagick::MeshUtils::setIndices(id, indices);
+	}
+}
+
 namespace meshmagick
 {
 	MeshMergeTool::MeshMergeTool()
-		: mBaseSkeleton(), mMeshes()
+		: mBaseSkeleton(), mMeshes(), mMergeSubmeshes(false), mBuildEdgeLists(true)
 	{
 	}
 
@@ -77,6 +326,9 @@ namespace meshmagick
 			return;
 		}
 
+		setMergeSubmeshes(OptionsUtil::isOptionSet(toolOptions, "merge-submeshes"));
+		setBuildEdgeLists(!OptionsUtil::isOptionSet(toolOptions, "no-edge-lists"));
+
 		StatefulMeshSerializer* meshSer = OgreEnvironment::getSingleton().getMeshSerializer();
 		StatefulSkeletonSerializer* skelSer =
 			OgreEnvironment::getSingleton().getSkeletonSerializer();
@@ -100,6 +352,7 @@ namespace meshmagick
 		}
 		Ogre::String outputfile = *outFileNames.begin();
 		meshSer->exportMesh(OGRE_GETPOINTER(merge(outputfile)), outputfile);
+		BuildCache::notifyFileWritten(outputfile);
 	}
 
 
@@ -163,10 +416,16 @@ namespace meshmagick
 		}
 
 		AxisAlignedBox totalBounds = AxisAlignedBox();
+		bool sharedBoneAssignmentsMerged = false;
 		for (std::vector<Ogre::MeshPtr>::iterator it = mMeshes.begin(); it != mMeshes.end(); ++it)
 		{
 			print("Baking: adding submeshes for " + (*it)->getName(), V_HIGH);
 
+			// This mesh's shared vertices are appended behind those of previous meshes,
+			// its submeshes behind the submeshes created so far.
+			const size_t sharedVertexBase = mp->sharedVertexData ? mp->sharedVertexData->vertexCount : 0;
+			const ushort subMeshBase = mp->getNumSubMeshes();
+
 			// insert all submeshes
 			for (Ogre::ushort sid = 0; sid < (*it)->getNumSubMeshes(); ++sid)
 			{
@@ -189,6 +448,10 @@ namespace meshmagick
 
 				// add index
 				newsub->indexData = sub->indexData->clone();
+				if (newsub->useSharedVertices && sharedVertexBase > 0)
+				{
+					offsetIndices(newsub->indexData, sharedVertexBase);
+				}
 
 				// add geometry
 				if (!newsub->useSharedVertices)
@@ -210,70 +473,6 @@ namespace meshmagick
 
 				newsub->setMaterialName(sub->getMaterialName());
 
-				// Add vertex animations for this submesh
-				Animation *anim = 0;
-				for (unsigned short i = 0; i < (*it)->getNumAnimations(); ++i)
-				{
-					anim = (*it)->getAnimation(i);
-
-					// get or create the animation for the new mesh
-					Animation *newanim;
-					if (mp->hasAnimation(anim->getName()))
-					{
-						newanim = mp->getAnimation(anim->getName());
-					}
-					else
-					{
-						newanim = mp->createAnimation(anim->getName(), anim->getLength());
-					}
-
-					print("Baking: adding vertex animation "
-						+ anim->getName() + " for " + (*it)->getName(), V_HIGH);
-
-					Animation::VertexTrackIterator vti=anim->getVertexTrackIterator();
-					while (vti.hasMoreElements())
-					{
-						VertexAnimationTrack *vt = vti.getNext();
-
-						// handle=0 targets the main mesh, handle i (where i>0) targets submesh i-1.
-						// In this case there are only submeshes so index 0 will not be used.
-						unsigned short handle = mp->getNumSubMeshes();
-						VertexAnimationTrack* newvt = newanim->createVertexTrack(
-								handle,
-								vt->getAssociatedVertexData()->clone(),
-								vt->getAnimationType());
-						for (int keyFrameIndex = 0; keyFrameIndex < vt->getNumKeyFrames();
-							++keyFrameIndex)
-						{
-							switch (vt->getAnimationType())
-							{
-								case VAT_MORPH:
-								{
-									// copy the keyframe vertex buffer
-									VertexMorphKeyFrame *kf =
-										vt->getVertexMorphKeyFrame(keyFrameIndex);
-									VertexMorphKeyFrame *newkf =
-										newvt->createVertexMorphKeyFrame(kf->getTime());
-									// This creates a ref to the buffer in the original model
-									// so don't delete it until the export is completed.
-									newkf->setVertexBuffer(kf->getVertexBuffer());
-									break;
-								}
-								case VAT_POSE:
-								{
-									/// @todo implement pose amination merge
-									break;
-								}
-								case VAT_NONE:
-								default:
-								{
-									break;
-								}
-							}
-						}
-					}
-				}
-
 				print("Baking: adding submesh '" +
 					name + "'  with material " + sub->getMaterialName(), V_HIGH);
 			}
@@ -281,11 +480,24 @@ namespace meshmagick
 			// sharedvertices
 			if ((*it)->sharedVertexData)
 			{
-				/// @todo merge with existing sharedVertexData
 				if (!mp->sharedVertexData)
 				{
 					mp->sharedVertexData = (*it)->sharedVertexData->clone();
 				}
+				else if (isVertexLayoutEqual(mp->sharedVertexData, (*it)->sharedVertexData))
+				{
+					print("Baking: appending shared vertices of " + (*it)->getName(), V_HIGH);
+					removeSharedMorphTracks(mp, (*it)->getName());
+					std::vector<const VertexData*> sources;
+					sources.push_back(mp->sharedVertexData);
+					sources.push_back((*it)->sharedVertexData);
+					concatenateVertexData(mp->sharedVertexData, sources);
+				}
+				else
+				{
+					throw std::logic_error("Shared vertex data of " + (*it)->getName() +
+						" has a different vertex layout, cannot merge.");
+				}
 
 				if (!OGRE_ISNULL(mBaseSkeleton))
 				{
@@ -295,11 +507,20 @@ namespace meshmagick
 						it_end = ba_list.end(); it != it_end; ++it)
 					{
 						VertexBoneAssignment vba = it->second;
+						vba.vertexIndex += static_cast<unsigned int>(sharedVertexBase);
 						mp->addBoneAssignment(vba);
 					}
+					if (sharedVertexBase > 0)
+					{
+						sharedBoneAssignmentsMerged = true;
+					}
 				}
 			}
 
+			// poses and vertex animations, after the geometry they target has been added
+			const std::vector<ushort> poseIndices = mergePoses(mp, *it, subMeshBase, sharedVertexBase);
+			mergeVertexAnimations(mp, *it, subMeshBase, sharedVertexBase, poseIndices);
+
 			print("Baking: adding bounds for " + (*it)->getName(), V_HIGH);
 
 			// add bounds
@@ -307,10 +528,28 @@ namespace meshmagick
 		}
 		mp->_setBounds(totalBounds);
 
-		/// @todo merge submeshes with same material
+		if (sharedBoneAssignmentsMerged)
+		{
+			// Blend indices in the shared vertices refer to each source mesh's own bone map.
+			mp->_compileBoneAssignments();
+		}
+
+		if (mMergeSubmeshes)
+		{
+			mergeSubmeshesByMaterial(mp);
+		}
+
+		widenIndexBuffers(mp);
+
+		if (mp->hasVertexAnimation())
+		{
+			mp->_determineAnimationTypes();
+		}
 
-		/// @todo add parameters
-		mp->buildEdgeList();
+		if (mBuildEdgeLists)
+		{
+			EdgeDataBuilder::buildEdgeLists(mp);
+		}
 
 		print("Baking: Finished", V_HIGH);
 
@@ -319,6 +558,321 @@ namespace meshmagick
 		return mp;
 	}
 
+	void MeshMergeTool::removeSharedMorphTracks(MeshPtr mesh, const String& appendedMeshName)
+	{
+		StringVector emptyAnimations;
+		for (ushort i = 0; i < mesh->getNumAnimations(); ++i)
+		{
+			Animation* anim = mesh->getAnimation(i);
+			if (!anim->hasVertexTrack(0) ||
+				anim->getVertexTrack(0)->getAnimationType() != VAT_MORPH)
+			{
+				continue;
+			}
+
+			// Morph keyframes hold a copy of every shared vertex, they'd be too short.
+			warn("Removed: morph animation " + anim->getName() + " on shared vertices, " +
+				appendedMeshName + " appends shared vertices to them.");
+			anim->destroyVertexTrack(0);
+			if (anim->getNumVertexTracks() == 0 && anim->getNumNodeTracks() == 0)
+			{
+				emptyAnimations.push_back(anim->getName());
+			}
+		}
+		for (size_t i = 0; i < emptyAnimations.size(); ++i)
+		{
+			mesh->removeAnimation(emptyAnimations[i]);
+		}
+	}
+
+	std::vector<ushort> MeshMergeTool::mergePoses(MeshPtr target, MeshPtr source,
+		ushort subMeshBase, size_t sharedVertexBase)
+	{
+		std::vector<ushort> poseIndices;
+		for (ushort p = 0; p < source->getPoseCount(); ++p)
+		{
+			const Pose* pose = source->getPose(p);
+			const ushort handle = retargetHandle(pose->getTarget(), subMeshBase);
+			// Pose offsets are sparse, they are copied by vertex index and rebased
+			// onto the concatenated shared vertices where needed.
+			const size_t vertexBase = handle == 0 ? sharedVertexBase : 0;
+
+			Pose* newPose = target->createPose(handle, pose->getName());
+			const Pose::VertexOffsetMap& offsets = pose->getVertexOffsets();
+			const Pose::NormalsMap& normals = pose->getNormals();
+			for (Pose::VertexOffsetMap::const_iterator it = offsets.begin();
+				it != offsets.end(); ++it)
+			{
+				Pose::NormalsMap::const_iterator normal = normals.find(it->first);
+				if (pose->getIncludesNormals() && normal != normals.end())
+				{
+					newPose->addVertex(vertexBase + it->first, it->second, normal->second);
+				}
+				else
+				{
+					newPose->addVertex(vertexBase + it->first, it->second);
+				}
+			}
+
+			poseIndices.push_back(static_cast<ushort>(target->getPoseCount() - 1));
+			print("Baking: adding pose " + pose->getName() + " for " + source->getName(), V_HIGH);
+		}
+		return poseIndices;
+	}
+
+	void MeshMergeTool::mergeVertexAnimations(MeshPtr target, MeshPtr source,
+		ushort subMeshBase, size_t sharedVertexBase, const std::vector<ushort>& poseIndices)
+	{
+		for (ushort i = 0; i < source->getNumAnimations(); ++i)
+		{
+			Animation* anim = source->getAnimation(i);
+
+			// get or create the animation for the new mesh
+			Animation *newanim;
+			if (target->hasAnimation(anim->getName()))
+			{
+				newanim = target->getAnimation(anim->getName());
+			}
+			else
+			{
+				newanim = target->createAnimation(anim->getName(), anim->getLength());
+			}
+
+			print("Baking: adding vertex animation "
+				+ anim->getName() + " for " + source->getName(), V_HIGH);
+
+			Animation::VertexTrackIterator vti = anim->getVertexTrackIterator();
+			while (vti.hasMoreElements())
+			{
+				VertexAnimationTrack* vt = vti.getNext();
+				const ushort handle = retargetHandle(vt->getHandle(), subMeshBase);
+				if (newanim->hasVertexTrack(handle))
+				{
+					// Only possible for the shared vertices. Pose tracks are joined, morph
+					// keyframes hold all shared vertices and cannot be.
+					VertexAnimationTrack* existing = newanim->getVertexTrack(handle);
+					if (vt->getAnimationType() == VAT_POSE &&
+						existing->getAnimationType() == VAT_POSE)
+					{
+						if (anim->getLength() != newanim->getLength())
+						{
+							warn("animation " + anim->getName() + " of " + source->getName() +
+								" is " + StringConverter::toString(anim->getLength()) +
+								" long, joining its poses to an animation of length " +
+								StringConverter::toString(newanim->getLength()) + ".");
+						}
+						mergePoseTracks(existing, vt, poseIndices, newanim->getLength(),
+							anim->getLength());
+					}
+					else
+					{
+						warn("Skipped: morph animation " + anim->getName() + " of " +
+							source->getName() + " animates shared vertices that already have a track.");
+					}
+					continue;
+				}
+				if (vt->getAnimationType() == VAT_MORPH && handle == 0 && sharedVertexBase > 0)
+				{
+					// Morph keyframes hold this mesh's shared vertices only.
+					warn("Skipped: morph animation " + anim->getName() + " of " + source->getName() +
+						" on appended shared vertices.");
+					continue;
+				}
+
+				VertexData* vd = handle == 0 ?
+					target->sharedVertexData : target->getSubMesh(handle - 1)->vertexData;
+				VertexAnimationTrack* newvt = newanim->createVertexTrack(
+						handle, vd, vt->getAnimationType());
+				for (ushort keyFrameIndex = 0; keyFrameIndex < vt->getNumKeyFrames();
+					++keyFrameIndex)
+				{
+					switch (vt->getAnimationType())
+					{
+						case VAT_MORPH:
+						{
+							// copy the keyframe vertex buffer
+							VertexMorphKeyFrame *kf =
+								vt->getVertexMorphKeyFrame(keyFrameIndex);
+							VertexMorphKeyFrame *newkf =
+								newvt->createVertexMorphKeyFrame(kf->getTime());
+							// This creates a ref to the buffer in the original model
+							// so don't delete it until the export is completed.
+							newkf->setVertexBuffer(kf->getVertexBuffer());
+							break;
+						}
+						case VAT_POSE:
+						{
+							// copy the pose references, pointing them at the merged poses
+							VertexPoseKeyFrame *kf =
+								vt->getVertexPoseKeyFrame(keyFrameIndex);
+							VertexPoseKeyFrame *newkf =
+								newvt->createVertexPoseKeyFrame(kf->getTime());
+							const VertexPoseKeyFrame::PoseRefList& refs = kf->getPoseReferences();
+							for (VertexPoseKeyFrame::PoseRefList::const_iterator ref = refs.begin();
+								ref != refs.end(); ++ref)
+							{
+								newkf->addPoseReference(poseIndices[ref->poseIndex], ref->influence);
+							}
+							break;
+						}
+						case VAT_NONE:
+						default:
+						{
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void MeshMergeTool::widenIndexBuffers(MeshPtr mesh)
+	{
+		for (Ogre::ushort sid = 0; sid < mesh->getNumSubMeshes(); ++sid)
+		{
+			SubMesh* sm = mesh->getSubMesh(sid);
+			const VertexData* vd = sm->useSharedVertices ? mesh->sharedVertexData : sm->vertexData;
+			if (MeshUtils::getIndexType(vd->vertexCount) != HardwareIndexBuffer::IT_32BIT)
+			{
+				continue;
+			}
+
+			if (MeshUtils::changeIndexType(sm->indexData, HardwareIndexBuffer::IT_32BIT))
+			{
+				print("Baking: submesh " + StringConverter::toString(sid) +
+					" index buffer widened to 32 bit", V_HIGH);
+			}
+			for (SubMesh::LODFaceList::iterator l = sm->mLodFaceList.begin();
+				l != sm->mLodFaceList.end(); ++l)
+			{
+				MeshUtils::changeIndexType(*l, HardwareIndexBuffer::IT_32BIT);
+			}
+		}
+	}
+
+	void MeshMergeTool::mergeSubmeshesByMaterial(MeshPtr mesh)
+	{
+		if (mesh->getNumAnimations() > 0 || mesh->getPoseCount() > 0)
+		{
+			// Vertex tracks and poses refer to submeshes by index.
+			warn("Mesh has vertex animations, submeshes not merged.");
+			return;
+		}
+
+		const ushort numSubMeshes = mesh->getNumSubMeshes();
+		std::vector<bool> mergedAway(numSubMeshes, false);
+		for (ushort target = 0; target < numSubMeshes; ++target)
+		{
+			SubMesh* targetSub = mesh->getSubMesh(target);
+			if (mergedAway[target] || !isMergeable(targetSub))
+			{
+				continue;
+			}
+
+			std::vector<SubMesh*> group(1, targetSub);
+			for (ushort sid = target + 1; sid < numSubMeshes; ++sid)
+			{
+				SubMesh* sm = mesh->getSubMesh(sid);
+				if (!mergedAway[sid] && isMergeable(sm) &&
+					sm->getMaterialName() == targetSub->getMaterialName() &&
+					isVertexLayoutEqual(sm->vertexData, targetSub->vertexData))
+				{
+					group.push_back(sm);
+					mergedAway[sid] = true;
+				}
+			}
+
+			if (group.size() > 1)
+			{
+				mergeSubmeshes(group);
+				print("Baking: merged " + StringConverter::toString(group.size()) +
+					" submeshes with material " + targetSub->getMaterialName(), V_HIGH);
+			}
+		}
+
+		// Destroy from the back, destroySubMesh shifts the indices of later submeshes.
+		for (ushort sid = numSubMeshes; sid > 0; --sid)
+		{
+			if (mergedAway[sid - 1])
+			{
+				mesh->destroySubMesh(sid - 1);
+			}
+		}
+	}
+
+	void MeshMergeTool::mergeSubmeshes(const std::vector<SubMesh*>& submeshes)
+	{
+		SubMesh* target = submeshes.front();
+
+		size_t indexCount = 0;
+		std::vector<const VertexData*> vertexSources;
+		for (size_t i = 0; i < submeshes.size(); ++i)
+		{
+			indexCount += submeshes[i]->indexData->indexCount;
+			vertexSources.push_back(submeshes[i]->vertexData);
+		}
+
+		// Rebase indices and bone assignments onto the concatenated vertices.
+		// Both are relative to vertexStart, which the concatenation resets to 0.
+		std::vector<uint32> indices;
+		indices.reserve(indexCount);
+		std::vector<VertexBoneAssignment> boneAssignments;
+		size_t baseVertex = 0;
+		for (size_t i = 0; i < submeshes.size(); ++i)
+		{
+			SubMesh* sm = submeshes[i];
+
+			std::vector<uint32> subIndices;
+			MeshUtils::getIndices(sm->indexData, subIndices);
+			for (size_t j = 0; j < subIndices.size(); ++j)
+			{
+				indices.push_back(static_cast<uint32>(subIndices[j] + baseVertex));
+			}
+
+			const SubMesh::VertexBoneAssignmentList& baList = sm->getBoneAssignments();
+			for (SubMesh::VertexBoneAssignmentList::const_iterator it = baList.begin();
+				it != baList.end(); ++it)
+			{
+				VertexBoneAssignment vba = it->second;
+				vba.vertexIndex += static_cast<unsigned int>(baseVertex);
+				boneAssignments.push_back(vba);
+			}
+
+			baseVertex += sm->vertexData->vertexCount;
+		}
+
+		concatenateVertexData(target->vertexData, vertexSources);
+
+		HardwareIndexBufferSharedPtr oldIndexBuffer = target->indexData->indexBuffer;
+		target->indexData->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+			MeshUtils::getIndexType(baseVertex), indexCount,
+			oldIndexBuffer->getUsage(), oldIndexBuffer->hasShadowBuffer());
+		target->indexData->indexStart = 0;
+		target->indexData->indexCount = indexCount;
+		MeshUtils::setIndices(target->indexData, indices);
+
+		target->clearBoneAssignments();
+		for (size_t i = 0; i < boneAssignments.size(); ++i)
+		{
+			target->addBoneAssignment(boneAssignments[i]);
+		}
+		if (!boneAssignments.empty())
+		{
+			// Blend indices in the copied vertices refer to each source submesh's own bone map.
+			target->_compileBoneAssignments();
+		}
+	}
+
+	void MeshMergeTool::setMergeSubmeshes(bool mergeSubmeshes)
+	{
+		mMergeSubmeshes = mergeSubmeshes;
+	}
+
+	void MeshMergeTool::setBuildEdgeLists(bool buildEdgeLists)
+	{
+		mBuildEdgeLists = buildEdgeLists;
+	}
+
 	void MeshMergeTool::reset()
 	{
 		mMeshes.clear();
@@ -43,12 +43,23 @@ namespace meshmagick
     OptionDefinitionSet MeshMergeToolFactory::getOptionDefinitions() const
     {
         OptionDefinitionSet optionDefs;
+        optionDefs.insert(OptionDefinition("merge-submeshes", OT_BOOL, false, false));
+        optionDefs.insert(OptionDefinition("no-edge-lists", OT_BOOL, false, false));
         return optionDefs;
     }
     //------------------------------------------------------------------------
 
     void MeshMergeToolFactory::printToolHelp(std::ostream& out) const
     {
+        out << std::endl;
+        out << "Merge all input meshes into the single output mesh." << std::endl << std::endl;
+        out << "Options:" << std::endl;
+        out << "   -merge-submeshes - Concatenate submeshes sharing a material and vertex"
+            << std::endl;
+        out << "       layout into one, to reduce draw calls. Triangle lists only." << std::endl;
+        out << "   -no-edge-lists - Don't build edge lists, for meshes never casting stencil"
+            << std::endl;
+        out << "       shadows." << std::endl;
     }
     //------------------------------------------------------------------------
 
@@ -63,4 +74,10 @@ namespace meshmagick
         return "Merge multiple submeshes into a single mesh.";
     }
     //------------------------------------------------------------------------
+
+    bool MeshMergeToolFactory::processesFilesIndependently(const OptionList&) const
+    {
+        return false;
+    }
+    //------------------------------------------------------------------------
 }
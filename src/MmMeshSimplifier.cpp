@@ -0,0 +1,556 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmMeshSimplifier.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+using namespace Ogre;
+
+namespace
+{
+    /// Weight of the planes keeping open borders in place, relative to face planes.
+    const double BORDER_WEIGHT = 10.0;
+
+    /// Collapses more expensive than this factor times the cost needed to reach the
+    /// target are left for the next pass, when cheaper ones might have become available.
+    const double PASS_ERROR_FACTOR = 1.5;
+
+    /// Collapses turning a triangle by more than 60 degrees are rejected, which also
+    /// catches triangles flipping over.
+    const Ogre::Real MAX_NORMAL_COS = 0.5f;
+
+    uint64 getEdgeKey(uint32 a, uint32 b)
+    {
+        return a < b ? (uint64(a) << 32) | b : (uint64(b) << 32) | a;
+    }
+
+    struct PositionLess
+    {
+        const std::vector<Vector3>& positions;
+
+        explicit PositionLess(const std::vector<Vector3>& p) : positions(p) {}
+
+        bool operator()(uint32 a, uint32 b) const
+        {
+            const Vector3& pa = positions[a];
+            const Vector3& pb = positions[b];
+            if (pa.x != pb.x) return pa.x < pb.x;
+            if (pa.y != pb.y) return pa.y < pb.y;
+            if (pa.z != pb.z) return pa.z < pb.z;
+            return a < b;
+        }
+    };
+
+    struct EdgeKeyLess
+    {
+        bool operator()(const std::pair<uint64, uint32>& a, uint64 b) const
+        {
+            return a.first < b;
+        }
+    };
+}
+
+namespace meshmagick
+{
+    MeshSimplifier::Quadric::Quadric()
+        : a00(0), a11(0), a22(0), a10(0), a20(0), a21(0), b0(0), b1(0), b2(0), c(0)
+    {
+    }
+
+    MeshSimplifier::Quadric::Quadric(const Vector3& n, double d, double w)
+        : a00(w * n.x * n.x), a11(w * n.y * n.y), a22(w * n.z * n.z),
+          a10(w * n.y * n.x), a20(w * n.z * n.x), a21(w * n.z * n.y),
+          b0(w * n.x * d), b1(w * n.y * d), b2(w * n.z * d),
+          c(w * d * d)
+    {
+    }
+
+    MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& o)
+    {
+        a00 += o.a00; a11 += o.a11; a22 += o.a22;
+        a10 += o.a10; a20 += o.a20; a21 += o.a21;
+        b0 += o.b0; b1 += o.b1; b2 += o.b2;
+        c += o.c;
+        return *this;
+    }
+
+    double MeshSimplifier::Quadric::evaluate(const Vector3& p) const
+    {
+        const double x = p.x, y = p.y, z = p.z;
+        // p^T A p + 2 b^T p + c
+        const double e = a00 * x * x + a11 * y * y + a22 * z * z
+            + 2 * (a10 * x * y + a20 * x * z + a21 * y * z)
+            + 2 * (b0 * x + b1 * y + b2 * z)
+            + c;
+        // Rounding can make it slightly negative.
+        return std::max(0.0, e);
+    }
+
+    MeshSimplifier::MeshSimplifier(const std::vector<Vector3>& positions,
+        const std::vector<uint32>& skinKeys, const std::vector<uint32>& indices)
+        : mPositions(positions), mSkinKeys(skinKeys), mIndices(indices)
+    {
+        assert(mIndices.size() % 3 == 0);
+        assert(mSkinKeys.empty() || mSkinKeys.size() == mPositions.size());
+
+        // Vertices with the same position get the lowest of their indices as id.
+        std::vector<uint32> order(mPositions.size());
+        for (uint32 i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), PositionLess(mPositions));
+        mCanonical.resize(mPositions.size());
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            mCanonical[order[i]] = i > 0 && mPositions[order[i]] == mPositions[order[i - 1]] ?
+                mCanonical[order[i - 1]] : order[i];
+        }
+
+        computeQuadrics();
+    }
+
+    const std::vector<uint32>& MeshSimplifier::getIndices() const
+    {
+        return mIndices;
+    }
+
+    size_t MeshSimplifier::getTriangleCount() const
+    {
+        return mIndices.size() / 3;
+    }
+
+    void MeshSimplifier::computeQuadrics()
+    {
+        mQuadrics.assign(mPositions.size(), Quadric());
+        buildTopology();
+
+        for (size_t t = 0; t < mIndices.size(); t += 3)
+        {
+            const uint32 c[3] = {mCanonical[mIndices[t]], mCanonical[mIndices[t + 1]],
+                mCanonical[mIndices[t + 2]]};
+            const Vector3& p0 = mPositions[c[0]];
+            Vector3 normal = (mPositions[c[1]] - p0).crossProduct(mPositions[c[2]] - p0);
+            const Real area = normal.normalise() * 0.5f;
+            if (area <= 0)
+            {
+                continue;
+            }
+
+            const Quadric face(normal, -normal.dotProduct(p0), area);
+            for (int k = 0; k < 3; ++k)
+            {
+                mQuadrics[c[k]] += face;
+            }
+
+            // Open borders get a plane through the edge, perpendicular to the face.
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32 a = c[k];
+                const uint32 b = c[(k + 1) % 3];
+                if (a == b || getEdgeCount(a, b) != 1)
+                {
+                    continue;
+                }
+                const Vector3 edge = mPositions[b] - mPositions[a];
+                Vector3 borderNormal = edge.crossProduct(normal);
+                if (borderNormal.normalise() <= 0)
+                {
+                    continue;
+                }
+                const Quadric border(borderNormal, -borderNormal.dotProduct(mPositions[a]),
+                    edge.squaredLength() * BORDER_WEIGHT);
+                mQuadrics[a] += border;
+                mQuadrics[b] += border;
+            }
+        }
+    }
+
+    void MeshSimplifier::buildTopology()
+    {
+        const size_t vertexCount = mPositions.size();
+        const size_t indexCount = mIndices.size();
+
+        // Referenced vertices grouped by position.
+        std::vector<bool> referenced(vertexCount, false);
+        mGroupStart.assign(vertexCount + 1, 0);
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            const uint32 v = mIndices[i];
+            if (!referenced[v])
+            {
+                referenced[v] = true;
+                ++mGroupStart[mCanonical[v] + 1];
+            }
+        }
+        for (size_t c = 0; c < vertexCount; ++c)
+        {
+            mGroupStart[c + 1] += mGroupStart[c];
+        }
+        mGroupVertices.resize(mGroupStart[vertexCount]);
+        std::vector<uint32> fill(mGroupStart.begin(), mGroupStart.end() - 1);
+        for (uint32 v = 0; v < vertexCount; ++v)
+        {
+            if (referenced[v])
+            {
+                mGroupVertices[fill[mCanonical[v]]++] = v;
+            }
+        }
+
+        // Triangles around each position, and edges.
+        mTriangleStart.assign(vertexCount + 1, 0);
+        std::vector<uint64> canonicalEdges;
+        canonicalEdges.reserve(indexCount);
+        mEdges.clear();
+        mEdges.reserve(indexCount);
+        for (size_t t = 0; t < indexCount; t += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32 a = mIndices[t + k];
+                const uint32 b = mIndices[t + (k + 1) % 3];
+                const uint32 ca = mCanonical[a];
+                const uint32 cb = mCanonical[b];
+                if (ca != cb)
+                {
+                    canonicalEdges.push_back(getEdgeKey(ca, cb));
+                    mEdges.push_back(getEdgeKey(a, b));
+                }
+                if (isFirstOfPosition(t, k))
+                {
+                    ++mTriangleStart[ca + 1];
+                }
+            }
+        }
+        for (size_t c = 0; c < vertexCount; ++c)
+        {
+            mTriangleStart[c + 1] += mTriangleStart[c];
+        }
+        mVertexTriangles.resize(mTriangleStart[vertexCount]);
+        fill.assign(mTriangleStart.begin(), mTriangleStart.end() - 1);
+        for (size_t t = 0; t < indexCount; t += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                if (isFirstOfPosition(t, k))
+                {
+                    const uint32 ca = mCanonical[mIndices[t + k]];
+                    mVertexTriangles[fill[ca]++] = static_cast<uint32>(t / 3);
+                }
+            }
+        }
+
+        std::sort(mEdges.begin(), mEdges.end());
+        mEdges.erase(std::unique(mEdges.begin(), mEdges.end()), mEdges.end());
+
+        std::sort(canonicalEdges.begin(), canonicalEdges.end());
+        mEdgeCounts.clear();
+        for (size_t i = 0; i < canonicalEdges.size(); ++i)
+        {
+            if (mEdgeCounts.empty() || mEdgeCounts.back().first != canonicalEdges[i])
+            {
+                mEdgeCounts.push_back(std::make_pair(canonicalEdges[i], uint32(0)));
+            }
+            ++mEdgeCounts.back().second;
+        }
+
+        // Classify positions by the edges around them.
+        std::vector<bool> border(vertexCount, false);
+        std::vector<bool> nonManifold(vertexCount, false);
+        for (size_t i = 0; i < mEdgeCounts.size(); ++i)
+        {
+            const uint32 a = static_cast<uint32>(mEdgeCounts[i].first >> 32);
+            const uint32 b = static_cast<uint32>(mEdgeCounts[i].first & 0xffffffff);
+            if (mEdgeCounts[i].second == 1)
+            {
+                border[a] = border[b] = true;
+            }
+            else if (mEdgeCounts[i].second > 2)
+            {
+                nonManifold[a] = nonManifold[b] = true;
+            }
+        }
+        mKinds.assign(vertexCount, VK_LOCKED);
+        for (uint32 c = 0; c < vertexCount; ++c)
+        {
+            const uint32 siblings = mGroupStart[c + 1] - mGroupStart[c];
+            if (siblings == 0 || nonManifold[c])
+            {
+                continue;
+            }
+            VertexKind kind = VK_LOCKED;
+            if (siblings == 1)
+            {
+                kind = border[c] ? VK_BORDER : VK_MANIFOLD;
+            }
+            else if (siblings == 2 && !border[c])
+            {
+                kind = VK_SEAM;
+            }
+            for (uint32 i = mGroupStart[c]; i < mGroupStart[c + 1]; ++i)
+            {
+                mKinds[mGroupVertices[i]] = kind;
+            }
+        }
+    }
+
+    bool MeshSimplifier::isFirstOfPosition(size_t t, int k) const
+    {
+        const uint32 c = mCanonical[mIndices[t + k]];
+        for (int i = 0; i < k; ++i)
+        {
+            if (mCanonical[mIndices[t + i]] == c)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32 MeshSimplifier::getEdgeCount(uint32 a, uint32 b) const
+    {
+        const uint64 key = getEdgeKey(a, b);
+        std::vector<std::pair<uint64, uint32> >::const_iterator it = std::lower_bound(
+            mEdgeCounts.begin(), mEdgeCounts.end(), key, EdgeKeyLess());
+        return it != mEdgeCounts.end() && it->first == key ? it->second : 0;
+    }
+
+    bool MeshSimplifier::hasEdge(uint32 a, uint32 b) const
+    {
+        return std::binary_search(mEdges.begin(), mEdges.end(), getEdgeKey(a, b));
+    }
+
+    bool MeshSimplifier::getCollapse(uint32 from, uint32 to, Collapse& collapse) const
+    {
+        const uint32 cu = mCanonical[from];
+        const uint32 cv = mCanonical[to];
+        if (cu == cv || (!mSkinKeys.empty() && mSkinKeys[from] != mSkinKeys[to]))
+        {
+            return false;
+        }
+
+        collapse.from = collapse.siblingFrom = from;
+        collapse.to = collapse.siblingTo = to;
+        switch (mKinds[from])
+        {
+        case VK_MANIFOLD:
+            break;
+        case VK_BORDER:
+            // Only along the border, else it would be pulled inwards.
+            if (getEdgeCount(cu, cv) != 1)
+            {
+                return false;
+            }
+            break;
+        case VK_SEAM:
+            {
+                // Only along the seam, which is an edge shared by two triangles using
+                // different vertices on either side. Both sides collapse together.
+                if (getEdgeCount(cu, cv) != 2)
+                {
+                    return false;
+                }
+                const uint32 sibling = mGroupVertices[mGroupStart[cu]] == from ?
+                    mGroupVertices[mGroupStart[cu] + 1] : mGroupVertices[mGroupStart[cu]];
+                bool found = false;
+                for (uint32 i = mGroupStart[cv]; i < mGroupStart[cv + 1] && !found; ++i)
+                {
+                    const uint32 candidate = mGroupVertices[i];
+                    if (hasEdge(sibling, candidate))
+                    {
+                        collapse.siblingFrom = sibling;
+                        collapse.siblingTo = candidate;
+                        found = true;
+                    }
+                }
+                if (!found ||
+                    (!mSkinKeys.empty() &&
+                        mSkinKeys[collapse.siblingFrom] != mSkinKeys[collapse.siblingTo]))
+                {
+                    return false;
+                }
+            }
+            break;
+        default:
+            return false;
+        }
+
+        Quadric q = mQuadrics[cu];
+        q += mQuadrics[cv];
+        collapse.cost = q.evaluate(mPositions[to]);
+        return true;
+    }
+
+    bool MeshSimplifier::hasTriangleFlip(const Collapse& collapse,
+        const std::vector<uint32>& remap) const
+    {
+        const uint32 cu = mCanonical[collapse.from];
+        const uint32 cv = mCanonical[collapse.to];
+        const Vector3& target = mPositions[collapse.to];
+
+        for (uint32 i = mTriangleStart[cu]; i < mTriangleStart[cu + 1]; ++i)
+        {
+            const size_t t = mVertexTriangles[i] * 3;
+            Vector3 before[3];
+            Vector3 after[3];
+            bool collapses = false;
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32 v = remap[mIndices[t + k]];
+                const uint32 c = mCanonical[v];
+                collapses |= c == cv;
+                before[k] = mPositions[v];
+                after[k] = c == cu ? target : before[k];
+            }
+            if (collapses)
+            {
+                // Becomes degenerate and is removed.
+                continue;
+            }
+
+            const Vector3 n0 = (before[1] - before[0]).crossProduct(before[2] - before[0]);
+            const Vector3 n1 = (after[1] - after[0]).crossProduct(after[2] - after[0]);
+            if (n0.squaredLength() > 0 &&
+                n0.dotProduct(n1) <= MAX_NORMAL_COS * n0.length() * n1.length())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t MeshSimplifier::applyCollapse(const Collapse& collapse, std::vector<uint32>& remap)
+    {
+        const uint32 cu = mCanonical[collapse.from];
+        const uint32 cv = mCanonical[collapse.to];
+
+        size_t removed = 0;
+        for (uint32 i = mTriangleStart[cu]; i < mTriangleStart[cu + 1]; ++i)
+        {
+            const size_t t = mVertexTriangles[i] * 3;
+            uint32 c[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                c[k] = mCanonical[remap[mIndices[t + k]]];
+            }
+            if (c[0] != c[1] && c[1] != c[2] && c[2] != c[0] &&
+                (c[0] == cv || c[1] == cv || c[2] == cv))
+            {
+                ++removed;
+            }
+        }
+
+        remap[collapse.from] = collapse.to;
+        remap[collapse.siblingFrom] = collapse.siblingTo;
+        mQuadrics[cv] += mQuadrics[cu];
+        return removed;
+    }
+
+    void MeshSimplifier::simplify(size_t targetTriangleCount)
+    {
+        std::vector<Collapse> collapses;
+        std::vector<uint32> remap;
+        std::vector<bool> locked;
+
+        while (getTriangleCount() > targetTriangleCount)
+        {
+            buildTopology();
+
+            collapses.clear();
+            for (size_t t = 0; t < mIndices.size(); t += 3)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    const uint32 a = mIndices[t + k];
+                    const uint32 b = mIndices[t + (k + 1) % 3];
+                    Collapse collapse;
+                    if (getCollapse(a, b, collapse))
+                    {
+                        collapses.push_back(collapse);
+                    }
+                    if (getCollapse(b, a, collapse))
+                    {
+                        collapses.push_back(collapse);
+                    }
+                }
+            }
+            if (collapses.empty())
+            {
+                break;
+            }
+            std::sort(collapses.begin(), collapses.end());
+
+            // A collapse removes about two triangles.
+            size_t triangleCount = getTriangleCount();
+            const size_t goal = std::max<size_t>(1, (triangleCount - targetTriangleCount) / 2);
+            const double errorLimit = goal < collapses.size() ?
+                collapses[goal].cost * PASS_ERROR_FACTOR : std::numeric_limits<double>::max();
+
+            remap.resize(mPositions.size());
+            for (uint32 v = 0; v < remap.size(); ++v)
+            {
+                remap[v] = v;
+            }
+            // Positions touched in this pass, their topology info is out of date.
+            locked.assign(mPositions.size(), false);
+            bool collapsed = false;
+            for (size_t i = 0; i < collapses.size() && triangleCount > targetTriangleCount; ++i)
+            {
+                const Collapse& collapse = collapses[i];
+                if (collapse.cost > errorLimit && collapsed)
+                {
+                    break;
+                }
+                const uint32 cu = mCanonical[collapse.from];
+                const uint32 cv = mCanonical[collapse.to];
+                if (locked[cu] || locked[cv] || hasTriangleFlip(collapse, remap))
+                {
+                    continue;
+                }
+                triangleCount -= applyCollapse(collapse, remap);
+                locked[cu] = locked[cv] = true;
+                collapsed = true;
+            }
+            if (!collapsed)
+            {
+                break;
+            }
+
+            // Rewrite the triangles, dropping the collapsed ones.
+            size_t out = 0;
+            for (size_t t = 0; t < mIndices.size(); t += 3)
+            {
+                const uint32 a = remap[mIndices[t]];
+                const uint32 b = remap[mIndices[t + 1]];
+                const uint32 c = remap[mIndices[t + 2]];
+                if (mCanonical[a] != mCanonical[b] && mCanonical[b] != mCanonical[c] &&
+                    mCanonical[c] != mCanonical[a])
+                {
+                    mIndices[out++] = a;
+                    mIndices[out++] = b;
+                    mIndices[out++] = c;
+                }
+            }
+            mIndices.resize(out);
+        }
+    }
+}
@@ -19,10 +19,457 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "MmMeshUtils.h"
 
+#include <OgreHardwareBufferManager.h>
+#include <OgreStringConverter.h>
 #include <OgreSubMesh.h>
 
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cstring>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#   define MM_HAS_X86_KERNELS
+#   include <immintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+// MSVC allows any instruction set's intrinsics anywhere.
+#       define MM_TARGET(_isa)
+#   else
+#       define MM_TARGET(_isa) __attribute__((target(_isa)))
+#   endif
+#endif
+
 using namespace Ogre;
 
+//New shared ptr API introduced in 1.10.1
+#if OGRE_VERSION >= 0x10A01
+#define OGRE_ISNULL(_sharedPtr) (!(_sharedPtr))
+#else
+#define OGRE_ISNULL(_sharedPtr) ((_sharedPtr).isNull())
+#endif
+
+// Normalised integer vertex element types were introduced with Ogre 1.10.
+#if OGRE_VERSION >= 0x10A00
+#define MM_HAS_NORMALISED_VERTEX_ELEMENTS
+#endif
+
+namespace
+{
+    /// Converts count components of type T, scaled by scale.
+    template <typename T>
+    void decodeComponents(const void* src, unsigned short count, float scale, float* out)
+    {
+        const T* p = static_cast<const T*>(src);
+        for (unsigned short i = 0; i < count; ++i)
+        {
+            out[i] = static_cast<float>(p[i]) * scale;
+        }
+    }
+
+    /// Signed normalised values have two encodings for -1, clamp to get one.
+    template <typename T>
+    void decodeSignedNormalised(const void* src, unsigned short count, float maxValue,
+        float* out)
+    {
+        decodeComponents<T>(src, count, 1.0f / maxValue, out);
+        for (unsigned short i = 0; i < count; ++i)
+        {
+            out[i] = std::max(-1.0f, out[i]);
+        }
+    }
+
+    /// Unpacks a 32 bit colour, shifts give the byte positions of r, g, b and a.
+    void decodeColour(const void* src, int rShift, int gShift, int bShift, int aShift,
+        float* out)
+    {
+        const uint32 c = *static_cast<const uint32*>(src);
+        const float scale = 1.0f / 255.0f;
+        out[0] = static_cast<float>((c >> rShift) & 0xff) * scale;
+        out[1] = static_cast<float>((c >> gShift) & 0xff) * scale;
+        out[2] = static_cast<float>((c >> bShift) & 0xff) * scale;
+        out[3] = static_cast<float>((c >> aShift) & 0xff) * scale;
+    }
+
+    /** Signature of the position transform kernels.
+    @param m the upper three rows of an affine transform, row-major
+    @param bounds receives min x, y, z followed by max x, y, z
+    */
+    typedef void (*PositionKernel)(unsigned char* data, size_t count, size_t stride,
+        const float m[12], bool store, float bounds[6]);
+
+// All kernels compute ((m0 * x + m1 * y) + m2 * z) + m3 with separate multiplies and adds,
+// so they give the same bits whichever one the CPU gets. Fusing them has to be prevented,
+// compilers do it on their own where FMA is available, even for the SSE intrinsics.
+#if defined(_MSC_VER)
+#   pragma fp_contract(off)
+#elif defined(__clang__)
+#   pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#   pragma GCC push_options
+#   pragma GCC optimize("fp-contract=off")
+#endif
+
+    void transformPositionsScalar(unsigned char* data, size_t count, size_t stride,
+        const float m[12], bool store, float bounds[6])
+    {
+        for (size_t i = 0; i < count; ++i, data += stride)
+        {
+            float* p = reinterpret_cast<float*>(data);
+            const float x = p[0];
+            const float y = p[1];
+            const float z = p[2];
+            for (int row = 0; row < 3; ++row)
+            {
+                const float* r = m + 4 * row;
+                float v = r[0] * x + r[1] * y;
+                v += r[2] * z;
+                v += r[3];
+                bounds[row] = std::min(bounds[row], v);
+                bounds[row + 3] = std::max(bounds[row + 3], v);
+                if (store)
+                {
+                    p[row] = v;
+                }
+            }
+        }
+    }
+
+#ifdef MM_HAS_X86_KERNELS
+    /// Loads x, y, z of a position without touching the bytes after it, w is 0.
+    MM_TARGET("sse2") inline __m128 loadPosition(const float* p)
+    {
+        __m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(p)));
+        return _mm_movelh_ps(xy, _mm_load_ss(p + 2));
+    }
+
+    MM_TARGET("sse2") inline void storePosition(float* p, __m128 v)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+    }
+
+    /// One position per iteration: the result is the sum of the matrix columns scaled by
+    /// x, y and z plus the translation column, in the order of the scalar kernel. Bounds
+    /// stay in registers until the end.
+    /// The new value goes first into min/max, so NaNs are skipped like AxisAlignedBox does.
+    MM_TARGET("sse2") void transformPositionsSse2(unsigned char* data, size_t count,
+        size_t stride, const float m[12], bool store, float bounds[6])
+    {
+        const __m128 c0 = _mm_setr_ps(m[0], m[4], m[8], 0.0f);
+        const __m128 c1 = _mm_setr_ps(m[1], m[5], m[9], 0.0f);
+        const __m128 c2 = _mm_setr_ps(m[2], m[6], m[10], 0.0f);
+        const __m128 c3 = _mm_setr_ps(m[3], m[7], m[11], 0.0f);
+        __m128 vmin = _mm_setr_ps(bounds[0], bounds[1], bounds[2], 0.0f);
+        __m128 vmax = _mm_setr_ps(bounds[3], bounds[4], bounds[5], 0.0f);
+
+        for (size_t i = 0; i < count; ++i, data += stride)
+        {
+            float* p = reinterpret_cast<float*>(data);
+            const __m128 v = loadPosition(p);
+            __m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(v, v, 0x00)),
+                _mm_mul_ps(c1, _mm_shuffle_ps(v, v, 0x55)));
+            r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, 0xaa)));
+            r = _mm_add_ps(r, c3);
+            vmin = _mm_min_ps(r, vmin);
+            vmax = _mm_max_ps(r, vmax);
+            if (store)
+            {
+                storePosition(p, r);
+            }
+        }
+
+        float result[8];
+        _mm_storeu_ps(result, vmin);
+        _mm_storeu_ps(result + 4, vmax);
+        std::copy(result, result + 3, bounds);
+        std::copy(result + 4, result + 7, bounds + 3);
+    }
+
+    /// As above, but two positions per iteration, one in each 128 bit lane.
+    MM_TARGET("avx") void transformPositionsAvx(unsigned char* data, size_t count,
+        size_t stride, const float m[12], bool store, float bounds[6])
+    {
+        const __m256 c0 = _mm256_setr_ps(m[0], m[4], m[8], 0.0f, m[0], m[4], m[8], 0.0f);
+        const __m256 c1 = _mm256_setr_ps(m[1], m[5], m[9], 0.0f, m[1], m[5], m[9], 0.0f);
+        const __m256 c2 = _mm256_setr_ps(m[2], m[6], m[10], 0.0f, m[2], m[6], m[10], 0.0f);
+        const __m256 c3 = _mm256_setr_ps(m[3], m[7], m[11], 0.0f, m[3], m[7], m[11], 0.0f);
+        __m256 vmin = _mm256_setr_ps(bounds[0], bounds[1], bounds[2], 0.0f,
+            bounds[0], bounds[1], bounds[2], 0.0f);
+        __m256 vmax = _mm256_setr_ps(bounds[3], bounds[4], bounds[5], 0.0f,
+            bounds[3], bounds[4], bounds[5], 0.0f);
+
+        size_t i = 0;
+        for (; i + 1 < count; i += 2, data += 2 * stride)
+        {
+            float* p0 = reinterpret_cast<float*>(data);
+            float* p1 = reinterpret_cast<float*>(data + stride);
+            const __m256 v = _mm256_insertf128_ps(
+                _mm256_castps128_ps256(loadPosition(p0)), loadPosition(p1), 1);
+            __m256 r = _mm256_add_ps(_mm256_mul_ps(c0, _mm256_permute_ps(v, 0x00)),
+                _mm256_mul_ps(c1, _mm256_permute_ps(v, 0x55)));
+            r = _mm256_add_ps(r, _mm256_mul_ps(c2, _mm256_permute_ps(v, 0xaa)));
+            r = _mm256_add_ps(r, c3);
+            vmin = _mm256_min_ps(r, vmin);
+            vmax = _mm256_max_ps(r, vmax);
+            if (store)
+            {
+                storePosition(p0, _mm256_castps256_ps128(r));
+                storePosition(p1, _mm256_extractf128_ps(r, 1));
+            }
+        }
+
+        __m128 min4 = _mm_min_ps(_mm256_castps256_ps128(vmin), _mm256_extractf128_ps(vmin, 1));
+        __m128 max4 = _mm_max_ps(_mm256_castps256_ps128(vmax), _mm256_extractf128_ps(vmax, 1));
+        // Leaving 256 bit code, avoids the transition penalty in the SSE code that follows.
+        _mm256_zeroupper();
+
+        float result[8];
+        _mm_storeu_ps(result, min4);
+        _mm_storeu_ps(result + 4, max4);
+        std::copy(result, result + 3, bounds);
+        std::copy(result + 4, result + 7, bounds + 3);
+
+        if (i < count)
+        {
+            transformPositionsSse2(data, count - i, stride, m, store, bounds);
+        }
+    }
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC pop_options
+#endif
+
+    /// Picks the fastest kernel the CPU (and OS, for the AVX register state) supports.
+    PositionKernel selectPositionKernel()
+    {
+#ifdef MM_HAS_X86_KERNELS
+#   if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        if (osxsave && avx && (_xgetbv(0) & 6) == 6)
+        {
+            return transformPositionsAvx;
+        }
+        if ((info[3] & (1 << 26)) != 0)
+        {
+            return transformPositionsSse2;
+        }
+#   else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx"))
+        {
+            return transformPositionsAvx;
+        }
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return transformPositionsSse2;
+        }
+#   endif
+#endif
+        return transformPositionsScalar;
+    }
+
+    /** Signature of the vertex element decoding kernels, see MeshUtils::decodeVertexElements.
+    @return false if the kernel doesn't handle type, nothing is decoded then.
+    */
+    typedef bool (*DecodeKernel)(VertexElementType type, const unsigned char* src,
+        size_t stride, size_t count, float* out);
+
+    bool decodeElementsScalar(VertexElementType type, const unsigned char* src,
+        size_t stride, size_t count, float* out)
+    {
+        for (size_t i = 0; i < count; ++i, src += stride, out += 4)
+        {
+            meshmagick::MeshUtils::decodeVertexElement(type, src, out);
+        }
+        return true;
+    }
+
+#ifdef MM_HAS_X86_KERNELS
+    /// Loads the Bytes bytes of an element into the low bytes of a register, the rest is 0.
+    template <int Bytes>
+    MM_TARGET("sse2") inline __m128i loadElement(const unsigned char* p);
+
+    template <>
+    MM_TARGET("sse2") inline __m128i loadElement<4>(const unsigned char* p)
+    {
+        int32 value;
+        memcpy(&value, p, sizeof(value));
+        return _mm_cvtsi32_si128(value);
+    }
+
+    template <>
+    MM_TARGET("sse2") inline __m128i loadElement<8>(const unsigned char* p)
+    {
+        return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    }
+
+    template <>
+    MM_TARGET("sse2") inline __m128i loadElement<12>(const unsigned char* p)
+    {
+        return _mm_castps_si128(loadPosition(reinterpret_cast<const float*>(p)));
+    }
+
+    template <>
+    MM_TARGET("sse2") inline __m128i loadElement<16>(const unsigned char* p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+
+    /// Widens the low four components of the given integer type to int32.
+    enum ComponentType { CT_INT8, CT_UINT8, CT_INT16, CT_UINT16 };
+
+    template <ComponentType Type>
+    MM_TARGET("sse2") inline __m128i widenComponents(__m128i v)
+    {
+        switch (Type)
+        {
+        case CT_INT8:
+            v = _mm_unpacklo_epi8(v, v);
+            return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 24);
+        case CT_UINT8:
+            v = _mm_unpacklo_epi8(v, _mm_setzero_si128());
+            return _mm_unpacklo_epi16(v, _mm_setzero_si128());
+        case CT_INT16:
+            return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        default:
+            return _mm_unpacklo_epi16(v, _mm_setzero_si128());
+        }
+    }
+
+    MM_TARGET("sse2") void decodeFloats(const unsigned char* src, size_t stride,
+        size_t count, size_t bytes, float* out)
+    {
+        for (size_t i = 0; i < count; ++i, src += stride, out += 4)
+        {
+            __m128i v;
+            switch (bytes)
+            {
+            case 4: v = loadElement<4>(src); break;
+            case 8: v = loadElement<8>(src); break;
+            case 12: v = loadElement<12>(src); break;
+            default: v = loadElement<16>(src); break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+        }
+    }
+
+    /** Converts integer components to float times scale, like decodeComponents.
+    @param clamp whether to clamp to -1, like decodeSignedNormalised.
+    @param swapRedBlue whether to swap components 0 and 2, for ARGB colours.
+    */
+    template <int Bytes, ComponentType Type>
+    MM_TARGET("sse2") void decodeIntegers(const unsigned char* src, size_t stride,
+        size_t count, float scale, bool clamp, bool swapRedBlue, float* out)
+    {
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128 minusOne = _mm_set1_ps(-1.0f);
+        for (size_t i = 0; i < count; ++i, src += stride, out += 4)
+        {
+            __m128 v = _mm_mul_ps(
+                _mm_cvtepi32_ps(widenComponents<Type>(loadElement<Bytes>(src))), vscale);
+            if (clamp)
+            {
+                v = _mm_max_ps(v, minusOne);
+            }
+            if (swapRedBlue)
+            {
+                v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));
+            }
+            _mm_storeu_ps(out, v);
+        }
+    }
+
+    /// Handles the float, 2 and 4 component 16 bit, and 4 component 8 bit types, which
+    /// cover nearly all meshes. Gives the same bits as the scalar code.
+    MM_TARGET("sse2") bool decodeElementsSse2(VertexElementType type, const unsigned char* src,
+        size_t stride, size_t count, float* out)
+    {
+        switch (type)
+        {
+        case VET_FLOAT1:
+        case VET_FLOAT2:
+        case VET_FLOAT3:
+        case VET_FLOAT4:
+            decodeFloats(src, stride, count, VertexElement::getTypeSize(type), out);
+            return true;
+        case VET_SHORT2:
+            decodeIntegers<4, CT_INT16>(src, stride, count, 1.0f, false, false, out);
+            return true;
+        case VET_SHORT4:
+            decodeIntegers<8, CT_INT16>(src, stride, count, 1.0f, false, false, out);
+            return true;
+        case VET_USHORT2:
+            decodeIntegers<4, CT_UINT16>(src, stride, count, 1.0f, false, false, out);
+            return true;
+        case VET_USHORT4:
+            decodeIntegers<8, CT_UINT16>(src, stride, count, 1.0f, false, false, out);
+            return true;
+        case VET_UBYTE4:
+            decodeIntegers<4, CT_UINT8>(src, stride, count, 1.0f, false, false, out);
+            return true;
+        case VET_COLOUR_ABGR:
+            decodeIntegers<4, CT_UINT8>(src, stride, count, 1.0f / 255.0f, false, false, out);
+            return true;
+        case VET_COLOUR:
+        case VET_COLOUR_ARGB:
+            decodeIntegers<4, CT_UINT8>(src, stride, count, 1.0f / 255.0f, false, true, out);
+            return true;
+#ifdef MM_HAS_NORMALISED_VERTEX_ELEMENTS
+        case VET_BYTE4:
+            decodeIntegers<4, CT_INT8>(src, stride, count, 1.0f, false, false, out);
+            return true;
+        case VET_BYTE4_NORM:
+            decodeIntegers<4, CT_INT8>(src, stride, count, 1.0f / 127.0f, true, false, out);
+            return true;
+        case VET_UBYTE4_NORM:
+            decodeIntegers<4, CT_UINT8>(src, stride, count, 1.0f / 255.0f, false, false, out);
+            return true;
+        case VET_SHORT2_NORM:
+            decodeIntegers<4, CT_INT16>(src, stride, count, 1.0f / 32767.0f, true, false, out);
+            return true;
+        case VET_SHORT4_NORM:
+            decodeIntegers<8, CT_INT16>(src, stride, count, 1.0f / 32767.0f, true, false, out);
+            return true;
+        case VET_USHORT2_NORM:
+            decodeIntegers<4, CT_UINT16>(src, stride, count, 1.0f / 65535.0f, false, false, out);
+            return true;
+        case VET_USHORT4_NORM:
+            decodeIntegers<8, CT_UINT16>(src, stride, count, 1.0f / 65535.0f, false, false, out);
+            return true;
+#endif
+        default:
+            return false;
+        }
+    }
+#endif
+
+    DecodeKernel selectDecodeKernel()
+    {
+#ifdef MM_HAS_X86_KERNELS
+#   if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        if ((info[3] & (1 << 26)) != 0)
+        {
+            return decodeElementsSse2;
+        }
+#   else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return decodeElementsSse2;
+        }
+#   endif
+#endif
+        return decodeElementsScalar;
+    }
+}
+
 namespace meshmagick
 {
     AxisAlignedBox MeshUtils::getMeshAabb(MeshPtr mesh, const Matrix4& transform)
@@ -46,7 +493,70 @@ namespace meshmagick
 
     AxisAlignedBox MeshUtils::getVertexDataAabb(VertexData* vd, const Matrix4& transform)
     {
-        AxisAlignedBox aabb;
+        const VertexElement* ve = vd->vertexDeclaration->findElementBySemantic(VES_POSITION);
+        HardwareVertexBufferSharedPtr vb = vd->vertexBufferBinding->getBuffer(ve->getSource());
+
+        unsigned char* data = static_cast<unsigned char*>(
+            vb->lock(Ogre::HardwareBuffer::HBL_READ_ONLY));
+        float* positions;
+        ve->baseVertexPointerToElement(data, &positions);
+        AxisAlignedBox aabb = transformPositions(positions, vd->vertexCount, vb->getVertexSize(),
+            transform, false);
+        vb->unlock();
+
+        return aabb;
+    }
+
+    AxisAlignedBox MeshUtils::transformPositions(float* positions, size_t count, size_t stride,
+        const Matrix4& transform, bool store)
+    {
+        if (count == 0)
+        {
+            return AxisAlignedBox();
+        }
+
+        unsigned char* data = reinterpret_cast<unsigned char*>(positions);
+        Vector3 min(FLT_MAX, FLT_MAX, FLT_MAX);
+        Vector3 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        if (transform.isAffine())
+        {
+            static const PositionKernel kernel = selectPositionKernel();
+            float m[12];
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int col = 0; col < 4; ++col)
+                {
+                    m[4 * row + col] = static_cast<float>(transform[row][col]);
+                }
+            }
+            float bounds[6] = {FLT_MAX, FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX};
+            kernel(data, count, stride, m, store, bounds);
+            min = Vector3(bounds[0], bounds[1], bounds[2]);
+            max = Vector3(bounds[3], bounds[4], bounds[5]);
+        }
+        else
+        {
+            // Projective transforms need the division by w, rare enough to stay scalar.
+            for (size_t i = 0; i < count; ++i, data += stride)
+            {
+                float* p = reinterpret_cast<float*>(data);
+                Vector3 v = transform * Vector3(p[0], p[1], p[2]);
+                min.makeFloor(v);
+                max.makeCeil(v);
+                if (store)
+                {
+                    p[0] = static_cast<float>(v.x);
+                    p[1] = static_cast<float>(v.y);
+                    p[2] = static_cast<float>(v.z);
+                }
+            }
+        }
+        return AxisAlignedBox(min, max);
+    }
+
+    void MeshUtils::getPositions(VertexData* vd, std::vector<Vector3>& positions)
+    {
+        positions.resize(vd->vertexCount);
 
         const VertexElement* ve = vd->vertexDeclaration->findElementBySemantic(VES_POSITION);
         HardwareVertexBufferSharedPtr vb = vd->vertexBufferBinding->getBuffer(ve->getSource());
@@ -54,16 +564,193 @@ namespace meshmagick
         unsigned char* data = static_cast<unsigned char*>(
             vb->lock(Ogre::HardwareBuffer::HBL_READ_ONLY));
 
+        void* v;
+        ve->baseVertexPointerToElement(data, &v);
+        std::vector<float> values(4 * vd->vertexCount);
+        if (!values.empty())
+        {
+            decodeVertexElements(ve->getType(), v, vb->getVertexSize(), vd->vertexCount,
+                &values[0]);
+        }
+        vb->unlock();
+
         for (size_t i = 0; i < vd->vertexCount; ++i)
         {
-            float* v;
-            ve->baseVertexPointerToElement(data, &v);
-            aabb.merge(transform * Vector3(v[0], v[1], v[2]));
+            positions[i] = Vector3(values[4 * i], values[4 * i + 1], values[4 * i + 2]);
+        }
+    }
 
-            data += vb->getVertexSize();
+    void MeshUtils::getIndices(const IndexData* id, std::vector<uint32>& indices)
+    {
+        indices.resize(id->indexCount);
+        if (id->indexCount == 0)
+        {
+            return;
         }
-        vb->unlock();
 
-        return aabb;
+        HardwareIndexBufferSharedPtr ib = id->indexBuffer;
+        void* data = ib->lock(id->indexStart * ib->getIndexSize(),
+            id->indexCount * ib->getIndexSize(), HardwareBuffer::HBL_READ_ONLY);
+        if (ib->getType() == HardwareIndexBuffer::IT_32BIT)
+        {
+            const uint32* p32 = static_cast<const uint32*>(data);
+            std::copy(p32, p32 + id->indexCount, indices.begin());
+        }
+        else
+        {
+            const uint16* p16 = static_cast<const uint16*>(data);
+            std::copy(p16, p16 + id->indexCount, indices.begin());
+        }
+        ib->unlock();
+    }
+
+    void MeshUtils::setIndices(IndexData* id, const std::vector<uint32>& indices)
+    {
+        assert(indices.size() == id->indexCount);
+        if (id->indexCount == 0)
+        {
+            return;
+        }
+
+        HardwareIndexBufferSharedPtr ib = id->indexBuffer;
+        void* data = ib->lock(id->indexStart * ib->getIndexSize(),
+            id->indexCount * ib->getIndexSize(), HardwareBuffer::HBL_NORMAL);
+        if (ib->getType() == HardwareIndexBuffer::IT_32BIT)
+        {
+            std::copy(indices.begin(), indices.end(), static_cast<uint32*>(data));
+        }
+        else
+        {
+            uint16* p16 = static_cast<uint16*>(data);
+            for (size_t i = 0; i < indices.size(); ++i)
+            {
+                assert(indices[i] <= 0xffff);
+                p16[i] = static_cast<uint16>(indices[i]);
+            }
+        }
+        ib->unlock();
+    }
+
+    HardwareIndexBuffer::IndexType MeshUtils::getIndexType(size_t vertexCount)
+    {
+        return vertexCount > 0xffff ? HardwareIndexBuffer::IT_32BIT : HardwareIndexBuffer::IT_16BIT;
+    }
+
+    bool MeshUtils::coversIndexBuffer(const IndexData* id)
+    {
+        return !OGRE_ISNULL(id->indexBuffer) && id->indexStart == 0 &&
+            id->indexCount == id->indexBuffer->getNumIndexes();
+    }
+
+    bool MeshUtils::changeIndexType(IndexData* id, HardwareIndexBuffer::IndexType type)
+    {
+        HardwareIndexBufferSharedPtr oldBuffer = id->indexBuffer;
+        if (!coversIndexBuffer(id) || oldBuffer->getType() == type)
+        {
+            return false;
+        }
+
+        std::vector<uint32> indices;
+        getIndices(id, indices);
+        id->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+            type, id->indexCount, oldBuffer->getUsage(), oldBuffer->hasShadowBuffer());
+        setIndices(id, indices);
+
+        return true;
+    }
+
+    unsigned short MeshUtils::decodeVertexElement(VertexElementType type,
+        const void* src, float out[4])
+    {
+        out[0] = out[1] = out[2] = out[3] = 0.0f;
+
+        const unsigned short count = VertexElement::getTypeCount(type);
+        switch (type)
+        {
+        case VET_FLOAT1:
+        case VET_FLOAT2:
+        case VET_FLOAT3:
+        case VET_FLOAT4:
+            decodeComponents<float>(src, count, 1.0f, out);
+            break;
+        case VET_DOUBLE1:
+        case VET_DOUBLE2:
+        case VET_DOUBLE3:
+        case VET_DOUBLE4:
+            decodeComponents<double>(src, count, 1.0f, out);
+            break;
+        case VET_SHORT1:
+        case VET_SHORT2:
+        case VET_SHORT3:
+        case VET_SHORT4:
+            decodeComponents<int16>(src, count, 1.0f, out);
+            break;
+        case VET_USHORT1:
+        case VET_USHORT2:
+        case VET_USHORT3:
+        case VET_USHORT4:
+            decodeComponents<uint16>(src, count, 1.0f, out);
+            break;
+        case VET_INT1:
+        case VET_INT2:
+        case VET_INT3:
+        case VET_INT4:
+            decodeComponents<int32>(src, count, 1.0f, out);
+            break;
+        case VET_UINT1:
+        case VET_UINT2:
+        case VET_UINT3:
+        case VET_UINT4:
+            decodeComponents<uint32>(src, count, 1.0f, out);
+            break;
+        case VET_UBYTE4:
+            decodeComponents<uint8>(src, 4, 1.0f, out);
+            break;
+        case VET_COLOUR_ABGR:
+            decodeColour(src, 0, 8, 16, 24, out);
+            break;
+        case VET_COLOUR:
+            // The layout depends on the render system, assume the Direct3D one. Only
+            // the channel order can be off, which does not matter for comparisons.
+        case VET_COLOUR_ARGB:
+            decodeColour(src, 16, 8, 0, 24, out);
+            break;
+#ifdef MM_HAS_NORMALISED_VERTEX_ELEMENTS
+        case VET_BYTE4:
+            decodeComponents<int8>(src, 4, 1.0f, out);
+            break;
+        case VET_BYTE4_NORM:
+            decodeSignedNormalised<int8>(src, 4, 127.0f, out);
+            break;
+        case VET_UBYTE4_NORM:
+            decodeComponents<uint8>(src, 4, 1.0f / 255.0f, out);
+            break;
+        case VET_SHORT2_NORM:
+        case VET_SHORT4_NORM:
+            decodeSignedNormalised<int16>(src, count, 32767.0f, out);
+            break;
+        case VET_USHORT2_NORM:
+        case VET_USHORT4_NORM:
+            decodeComponents<uint16>(src, count, 1.0f / 65535.0f, out);
+            break;
+#endif
+        default:
+            OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
+                "Unsupported vertex element type " + StringConverter::toString(type),
+                "MeshUtils::decodeVertexElement");
+        }
+
+        return count;
+    }
+
+    void MeshUtils::decodeVertexElements(VertexElementType type, const void* src,
+        size_t stride, size_t count, float* out)
+    {
+        static const DecodeKernel kernel = selectDecodeKernel();
+        const unsigned char* data = static_cast<const unsigned char*>(src);
+        if (!kernel(type, data, stride, count, out))
+        {
+            decodeElementsScalar(type, data, stride, count, out);
+        }
     }
 }
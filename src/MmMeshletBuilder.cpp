@@ -0,0 +1,248 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmMeshletBuilder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+using namespace Ogre;
+
+namespace
+{
+    /// Normal cones wider than this (the cosine of the half angle) don't cull anything.
+    const Real MIN_CONE_SPREAD = 0.1f;
+
+    const uint32 NO_MESHLET = std::numeric_limits<uint32>::max();
+}
+
+namespace meshmagick
+{
+    void MeshletBuilder::build(const std::vector<Vector3>& positions,
+        std::vector<uint32>& indices, size_t maxVertices, size_t maxTriangles,
+        std::vector<Meshlet>& meshlets)
+    {
+        assert(indices.size() % 3 == 0);
+        assert(maxVertices >= 3 && maxTriangles >= 1);
+
+        meshlets.clear();
+        const size_t triangleCount = indices.size() / 3;
+        const size_t vertexCount = positions.size();
+
+        // Triangles using each vertex.
+        std::vector<uint32> triangleStart(vertexCount + 1, 0);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            ++triangleStart[indices[i] + 1];
+        }
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            triangleStart[v + 1] += triangleStart[v];
+        }
+        std::vector<uint32> vertexTriangles(indices.size());
+        std::vector<uint32> fill(triangleStart.begin(), triangleStart.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            vertexTriangles[fill[indices[i]]++] = static_cast<uint32>(i / 3);
+        }
+        // Number of triangles not yet in a meshlet, per vertex.
+        std::vector<uint32> liveTriangles(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            liveTriangles[v] = triangleStart[v + 1] - triangleStart[v];
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+        // Meshlet each vertex was last added to.
+        std::vector<uint32> vertexMeshlet(vertexCount, NO_MESHLET);
+
+        std::vector<uint32> result;
+        result.reserve(indices.size());
+        std::vector<uint32> meshletVertices;
+        size_t seedCursor = 0;
+
+        Meshlet meshlet;
+        meshlet.indexStart = 0;
+        meshlet.triangleCount = 0;
+        meshlet.vertexCount = 0;
+
+        for (size_t done = 0; done < triangleCount; ++done)
+        {
+            const uint32 meshletId = static_cast<uint32>(meshlets.size());
+
+            // Pick the adjacent triangle adding the fewest vertices.
+            size_t best = triangleCount;
+            size_t bestNewVertices = 4;
+            uint32 bestLive = std::numeric_limits<uint32>::max();
+            for (size_t i = 0; i < meshletVertices.size(); ++i)
+            {
+                const uint32 v = meshletVertices[i];
+                for (uint32 j = triangleStart[v]; j < triangleStart[v + 1]; ++j)
+                {
+                    const uint32 t = vertexTriangles[j];
+                    if (emitted[t])
+                    {
+                        continue;
+                    }
+                    size_t newVertices = 0;
+                    uint32 live = 0;
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        const uint32 tv = indices[t * 3 + k];
+                        newVertices += vertexMeshlet[tv] != meshletId;
+                        live += liveTriangles[tv];
+                    }
+                    if (newVertices < bestNewVertices ||
+                        (newVertices == bestNewVertices && live < bestLive))
+                    {
+                        best = t;
+                        bestNewVertices = newVertices;
+                        bestLive = live;
+                    }
+                }
+            }
+
+            const bool fits = best != triangleCount &&
+                meshlet.triangleCount < maxTriangles &&
+                meshlet.vertexCount + bestNewVertices <= maxVertices;
+            if (!fits)
+            {
+                if (meshlet.triangleCount > 0)
+                {
+                    // Full or no neighbours left, start a new meshlet.
+                    computeBounds(positions, result, meshlet);
+                    meshlets.push_back(meshlet);
+                    meshlet.indexStart = result.size();
+                    meshlet.triangleCount = 0;
+                    meshlet.vertexCount = 0;
+                    meshletVertices.clear();
+                }
+                if (best == triangleCount)
+                {
+                    // Nothing adjacent, continue with the first triangle left over.
+                    while (emitted[seedCursor])
+                    {
+                        ++seedCursor;
+                    }
+                    best = seedCursor;
+                }
+                // Else continue next to the previous meshlet.
+            }
+
+            const uint32 id = static_cast<uint32>(meshlets.size());
+            emitted[best] = true;
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32 v = indices[best * 3 + k];
+                if (vertexMeshlet[v] != id)
+                {
+                    vertexMeshlet[v] = id;
+                    meshletVertices.push_back(v);
+                    ++meshlet.vertexCount;
+                }
+                --liveTriangles[v];
+                result.push_back(v);
+            }
+            ++meshlet.triangleCount;
+        }
+        if (meshlet.triangleCount > 0)
+        {
+            computeBounds(positions, result, meshlet);
+            meshlets.push_back(meshlet);
+        }
+
+        indices.swap(result);
+    }
+
+    void MeshletBuilder::computeBounds(const std::vector<Vector3>& positions,
+        const std::vector<uint32>& indices, Meshlet& meshlet)
+    {
+        const size_t begin = meshlet.indexStart;
+        const size_t end = begin + meshlet.triangleCount * 3;
+
+        // Sphere around the bounding box center.
+        Vector3 minimum = positions[indices[begin]];
+        Vector3 maximum = minimum;
+        for (size_t i = begin; i < end; ++i)
+        {
+            minimum.makeFloor(positions[indices[i]]);
+            maximum.makeCeil(positions[indices[i]]);
+        }
+        meshlet.center = (minimum + maximum) * 0.5f;
+        Real radiusSquared = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            radiusSquared = std::max(radiusSquared,
+                meshlet.center.squaredDistance(positions[indices[i]]));
+        }
+        meshlet.radius = std::sqrt(radiusSquared);
+
+        // Normal cone around the average triangle normal.
+        std::vector<Vector3> normals;
+        std::vector<size_t> normalIndices;
+        normals.reserve(meshlet.triangleCount);
+        normalIndices.reserve(meshlet.triangleCount);
+        Vector3 axis = Vector3::ZERO;
+        for (size_t i = begin; i < end; i += 3)
+        {
+            const Vector3& p0 = positions[indices[i]];
+            Vector3 normal = (positions[indices[i + 1]] - p0).crossProduct(
+                positions[indices[i + 2]] - p0);
+            if (normal.normalise() > 0)
+            {
+                normals.push_back(normal);
+                normalIndices.push_back(i);
+                axis += normal;
+            }
+        }
+        meshlet.coneAxis = Vector3::ZERO;
+        meshlet.coneApex = meshlet.center;
+        meshlet.coneCutoff = 1;
+        if (axis.normalise() <= 0)
+        {
+            return;
+        }
+
+        Real minDot = 1;
+        for (size_t i = 0; i < normals.size(); ++i)
+        {
+            minDot = std::min(minDot, normals[i].dotProduct(axis));
+        }
+        meshlet.coneAxis = axis;
+        if (minDot <= MIN_CONE_SPREAD)
+        {
+            return;
+        }
+
+        // Move the apex back until every triangle plane is in front of it, so the test
+        // is conservative for cameras close to the meshlet.
+        Real maxDistance = 0;
+        for (size_t i = 0; i < normals.size(); ++i)
+        {
+            const Vector3& p0 = positions[indices[normalIndices[i]]];
+            const Real distance = (meshlet.center - p0).dotProduct(normals[i]) /
+                axis.dotProduct(normals[i]);
+            maxDistance = std::max(maxDistance, distance);
+        }
+        meshlet.coneApex = meshlet.center - axis * maxDistance;
+        meshlet.coneCutoff = std::sqrt(1 - minDot * minDot);
+    }
+}
@@ -0,0 +1,284 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmMeshletTool.h"
+
+#include <OgreStringConverter.h>
+#include <OgreSubMesh.h>
+
+#include <fstream>
+#include <map>
+
+#include "MmBuildCache.h"
+#include "MmEdgeDataBuilder.h"
+#include "MmMeshUtils.h"
+#include "MmOgreEnvironment.h"
+#include "MmStatefulMeshSerializer.h"
+#include "MmToolUtils.h"
+
+using namespace Ogre;
+
+namespace
+{
+    const char MESHLET_FILE_MAGIC[4] = {'M', 'M', 'C', 'L'};
+    const uint32 MESHLET_FILE_VERSION = 1;
+
+    void writeUInt(std::ostream& out, size_t value)
+    {
+        const uint32 v = static_cast<uint32>(value);
+        out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    void writeFloats(std::ostream& out, const Real* values, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float f = static_cast<float>(values[i]);
+            out.write(reinterpret_cast<const char*>(&f), sizeof(f));
+        }
+    }
+}
+
+namespace meshmagick
+{
+    MeshletTool::MeshletTool()
+        : mMaxVertices(64),
+          mMaxTriangles(124),
+          mStripEdgeLists(false)
+    {
+    }
+
+    Ogre::String MeshletTool::getName() const
+    {
+        return "meshlet";
+    }
+
+    void MeshletTool::setOptions(const OptionList& toolOptions)
+    {
+        mMaxVertices = 64;
+        mMaxTriangles = 124;
+        mStripEdgeLists = OptionsUtil::isOptionSet(toolOptions, "no-edge-lists");
+        for (OptionList::const_iterator it = toolOptions.begin(); it != toolOptions.end(); ++it)
+        {
+            if (it->first == "max-vertices")
+            {
+                int maxVertices = any_cast<int>(it->second);
+                if (maxVertices < 3)
+                {
+                    fail("max-vertices must be at least 3.");
+                }
+                mMaxVertices = static_cast<size_t>(maxVertices);
+            }
+            else if (it->first == "max-triangles")
+            {
+                int maxTriangles = any_cast<int>(it->second);
+                if (maxTriangles < 1)
+                {
+                    fail("max-triangles must be at least 1.");
+                }
+                mMaxTriangles = static_cast<size_t>(maxTriangles);
+            }
+        }
+    }
+
+    void MeshletTool::doInvoke(const OptionList& toolOptions,
+        const StringVector& inFileNames, const StringVector& outFileNamesArg)
+    {
+        // Name count has to match, else we have no way to figure out how to apply output
+        // names to input files.
+        if (!(outFileNamesArg.empty() || inFileNames.size() == outFileNamesArg.size()))
+        {
+            fail("number of output files must match number of input files.");
+        }
+
+        setOptions(toolOptions);
+
+        StringVector outFileNames = outFileNamesArg.empty() ? inFileNames : outFileNamesArg;
+
+        for (size_t i = 0, end = inFileNames.size(); i < end; ++i)
+        {
+            if (StringUtil::endsWith(inFileNames[i], ".mesh", true))
+            {
+                processMeshFile(inFileNames[i], outFileNames[i]);
+            }
+            else
+            {
+                warn("unrecognised name ending for file " + inFileNames[i]);
+                warn("file skipped.");
+            }
+
+            releaseFileResources();
+        }
+    }
+
+    void MeshletTool::processMeshFile(Ogre::String inFile, Ogre::String outFile)
+    {
+        StatefulMeshSerializer* meshSerializer =
+            OgreEnvironment::getSingleton().getMeshSerializer();
+
+        print("Loading mesh " + inFile + "...");
+        MeshPtr mesh;
+        try
+        {
+            mesh = meshSerializer->loadMesh(inFile);
+        }
+        catch(std::exception& e)
+        {
+            warn(e.what());
+            warn("Unable to open mesh file " + inFile);
+            warn("file skipped.");
+            return;
+        }
+
+        print("Building meshlets...");
+        doProcessLoadedMesh(mesh, inFile, outFile);
+        meshSerializer->saveMesh(outFile, true);
+        print("Mesh saved as " + outFile + ".");
+    }
+
+    bool MeshletTool::supportsLoadedMeshes() const
+    {
+        return true;
+    }
+
+    bool MeshletTool::writesSidecarFiles() const
+    {
+        return true;
+    }
+
+    void MeshletTool::doBeginLoadedMeshes(const OptionList& toolOptions)
+    {
+        setOptions(toolOptions);
+    }
+
+    bool MeshletTool::doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String&,
+        const Ogre::String& outFile)
+    {
+        MeshletTable table;
+        buildMeshlets(mesh, table);
+
+        // foo.mesh -> foo.meshlets, other names get .meshlets appended
+        const String meshletFile = ToolUtils::getSidecarFileName(outFile, ".meshlets");
+        writeMeshletFile(meshletFile, table);
+        print("Meshlets saved as " + meshletFile + ".");
+        return true;
+    }
+
+    void MeshletTool::buildMeshlets(MeshPtr mesh, MeshletTable& table)
+    {
+        table.clear();
+
+        std::map<VertexData*, std::vector<Vector3> > positions;
+        bool reordered = false;
+        for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+        {
+            SubMesh* sm = mesh->getSubMesh(i);
+            if (sm->operationType != RenderOperation::OT_TRIANGLE_LIST)
+            {
+                warn("submesh " + StringConverter::toString(i) +
+                    " is no triangle list, skipped.");
+                continue;
+            }
+            if (sm->indexData->indexCount == 0)
+            {
+                continue;
+            }
+
+            VertexData* vertexData = sm->useSharedVertices ? mesh->sharedVertexData :
+                sm->vertexData;
+            if (positions.find(vertexData) == positions.end())
+            {
+                MeshUtils::getPositions(vertexData, positions[vertexData]);
+            }
+
+            std::vector<uint32> indices;
+            MeshUtils::getIndices(sm->indexData, indices);
+
+            SubMeshMeshlets subMeshMeshlets;
+            subMeshMeshlets.subMeshIndex = i;
+            MeshletBuilder::build(positions[vertexData], indices, mMaxVertices, mMaxTriangles,
+                subMeshMeshlets.meshlets);
+            MeshUtils::setIndices(sm->indexData, indices);
+            reordered = true;
+
+            // Make the ranges refer to the whole index buffer.
+            size_t vertices = 0;
+            for (size_t m = 0; m < subMeshMeshlets.meshlets.size(); ++m)
+            {
+                subMeshMeshlets.meshlets[m].indexStart += sm->indexData->indexStart;
+                vertices += subMeshMeshlets.meshlets[m].vertexCount;
+            }
+            const size_t count = subMeshMeshlets.meshlets.size();
+            print("    submesh " + StringConverter::toString(i) + ": " +
+                StringConverter::toString(count) + " meshlets, " +
+                StringConverter::toString(Real(vertices) / count) + " vertices and " +
+                StringConverter::toString(Real(indices.size() / 3) / count) +
+                " triangles on average");
+
+            table.push_back(subMeshMeshlets);
+        }
+
+        if (mStripEdgeLists && mesh->isEdgeListBuilt())
+        {
+            mesh->freeEdgeList();
+            print("Edge lists removed.");
+        }
+        else if (reordered && mesh->isEdgeListBuilt())
+        {
+            // Triangle order changed.
+            EdgeDataBuilder::buildEdgeLists(mesh);
+        }
+    }
+
+    void MeshletTool::writeMeshletFile(const Ogre::String& fileName, const MeshletTable& table)
+    {
+        std::ofstream out(fileName.c_str(), std::ios_base::out | std::ios_base::binary);
+        if (!out)
+        {
+            fail("cannot open file " + fileName);
+        }
+
+        out.write(MESHLET_FILE_MAGIC, sizeof(MESHLET_FILE_MAGIC));
+        writeUInt(out, MESHLET_FILE_VERSION);
+        writeUInt(out, table.size());
+        for (size_t i = 0; i < table.size(); ++i)
+        {
+            writeUInt(out, table[i].subMeshIndex);
+            writeUInt(out, table[i].meshlets.size());
+            for (size_t m = 0; m < table[i].meshlets.size(); ++m)
+            {
+                const Meshlet& meshlet = table[i].meshlets[m];
+                writeUInt(out, meshlet.indexStart);
+                writeUInt(out, meshlet.triangleCount);
+                writeUInt(out, meshlet.vertexCount);
+                writeFloats(out, meshlet.center.ptr(), 3);
+                writeFloats(out, &meshlet.radius, 1);
+                writeFloats(out, meshlet.coneApex.ptr(), 3);
+                writeFloats(out, meshlet.coneAxis.ptr(), 3);
+                writeFloats(out, &meshlet.coneCutoff, 1);
+            }
+        }
+
+        if (!out)
+        {
+            fail("failed writing " + fileName);
+        }
+        BuildCache::notifyFileWritten(fileName);
+    }
+}
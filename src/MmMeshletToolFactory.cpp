@@ -0,0 +1,83 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmMeshletToolFactory.h"
+#include "MmMeshletTool.h"
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    //------------------------------------------------------------------------
+    Tool* MeshletToolFactory::createTool()
+    {
+        Tool* tool = new MeshletTool();
+        return tool;
+    }
+    //------------------------------------------------------------------------
+
+    void MeshletToolFactory::destroyTool(Tool* tool)
+    {
+        delete tool;
+    }
+    //------------------------------------------------------------------------
+
+    OptionDefinitionSet MeshletToolFactory::getOptionDefinitions() const
+    {
+        OptionDefinitionSet optionDefs;
+        optionDefs.insert(OptionDefinition("max-vertices", OT_INT, false, false, Any(64)));
+        optionDefs.insert(OptionDefinition("max-triangles", OT_INT, false, false, Any(124)));
+        optionDefs.insert(OptionDefinition("no-edge-lists", OT_BOOL, false, false));
+        return optionDefs;
+    }
+    //------------------------------------------------------------------------
+
+    void MeshletToolFactory::printToolHelp(std::ostream& out) const
+    {
+        out << std::endl;
+        out << "Splits submeshes into meshlets for per cluster culling" << std::endl
+            << std::endl;
+        out << "options:" << std::endl;
+        out << "   -max-vertices=n - maximum vertices per meshlet (default 64)" << std::endl;
+        out << "   -max-triangles=n - maximum triangles per meshlet (default 124)"
+            << std::endl;
+        out << "   -no-edge-lists - remove edge lists instead of rebuilding them, for meshes"
+            << std::endl;
+        out << "       never casting stencil shadows." << std::endl;
+        out << "Triangles are reordered so each meshlet is a contiguous index range."
+            << std::endl;
+        out << "The meshlet table with ranges, bounding spheres and normal cones is written"
+            << std::endl;
+        out << "next to the output mesh, as foo.meshlets for foo.mesh." << std::endl
+            << std::endl;
+    }
+    //------------------------------------------------------------------------
+
+    Ogre::String MeshletToolFactory::getToolName() const
+    {
+        return "meshlet";
+    }
+    //------------------------------------------------------------------------
+
+    Ogre::String MeshletToolFactory::getToolDescription() const
+    {
+        return "Build meshlets for cluster culling.";
+    }
+    //------------------------------------------------------------------------
+}
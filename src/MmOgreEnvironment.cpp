@@ -26,8 +26,17 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <OgreMaterialManager.h>
 #include "OgreLodStrategyManager.h"
 
+#include <vector>
+
 using namespace Ogre;
 
+//New shared ptr API introduced in 1.10.1
+#if OGRE_VERSION >= 0x10A01
+#define OGRE_USECOUNT(_sharedPtr) ((_sharedPtr).use_count())
+#else
+#define OGRE_USECOUNT(_sharedPtr) ((_sharedPtr).useCount())
+#endif
+
 template<> meshmagick::OgreEnvironment* Singleton<meshmagick::OgreEnvironment>::msSingleton = NULL;
 
 namespace meshmagick
@@ -100,6 +109,55 @@ namespace meshmagick
 		return mLog;
 	}
 
+	void OgreEnvironment::releaseResources()
+	{
+		mMeshSerializer->clear();
+		mSkeletonSerializer->clear();
+
+		if (mStandalone)
+		{
+			mMeshMgr->removeAll();
+			mSkeletonMgr->removeAll();
+		}
+	}
+
+	void OgreEnvironment::releaseUnreferencedResources()
+	{
+		mMeshSerializer->clear();
+		mSkeletonSerializer->clear();
+
+		if (mStandalone)
+		{
+			// Meshes first, they hold references to their skeletons and materials.
+			removeUnreferencedResources(mMeshMgr);
+			removeUnreferencedResources(mSkeletonMgr);
+			removeUnreferencedResources(mMaterialMgr);
+		}
+	}
+
+	void OgreEnvironment::removeUnreferencedResources(ResourceManager* manager)
+	{
+		// Only the default group, Ogre's own materials live in the internal group.
+		std::vector<ResourceHandle> unreferenced;
+		ResourceManager::ResourceMapIterator it = manager->getResourceIterator();
+		while (it.hasMoreElements())
+		{
+			ResourcePtr resource = it.getNext();
+			// One more than the resource system holds, for the copy above.
+			if (resource->getGroup() == ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME
+				&& OGRE_USECOUNT(resource)
+					<= ResourceGroupManager::RESOURCE_SYSTEM_NUM_REFERENCE_COUNTS + 1)
+			{
+				unreferenced.push_back(resource->getHandle());
+			}
+		}
+
+		for (size_t i = 0; i < unreferenced.size(); ++i)
+		{
+			manager->remove(unreferenced[i]);
+		}
+	}
+
     StatefulMeshSerializer* OgreEnvironment::getMeshSerializer() const
     {
         return mMeshSerializer;
@@ -19,9 +19,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "MmOptimiseTool.h"
 
+#include "MmEdgeDataBuilder.h"
+#include "MmKeyFrameReducer.h"
+#include "MmMeshUtils.h"
 #include "MmOgreEnvironment.h"
 #include "MmStatefulMeshSerializer.h"
 #include "MmStatefulSkeletonSerializer.h"
+#include "MmThreadPool.h"
+#include "MmVertexCacheOptimiser.h"
 
 #ifdef __APPLE__
 #	include <Ogre/OgreStringConverter.h>
@@ -32,14 +37,41 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #endif
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
+#include <set>
 
 using namespace Ogre;
 
+//New shared ptr API introduced in 1.10.1
+#if OGRE_VERSION >= 0x10A01
+#define OGRE_GETPOINTER(_sharedPtr) ((_sharedPtr).get())
+#else
+#define OGRE_GETPOINTER(_sharedPtr) ((_sharedPtr).getPointer())
+#endif
+
+namespace
+{
+	/// Colours and blend weights are welded if they are within half an 8 bit step,
+	/// so values that only differ by quantisation noise still match.
+	const Ogre::Real COLOUR_TOLERANCE = 0.5f / 255.0f;
+}
+
 namespace meshmagick
 {
 	//------------------------------------------------------------------------
 	OptimiseTool::OptimiseTool()
+		: mKeepIdentityTracks(false),
+		  mStripEdgeLists(false),
+		  mReduceKeyFrames(false),
+		  mKeyRotationError(0.1f),
+		  mKeyTranslationError(0.001f),
+		  mKeyScaleError(0.001f),
+		  mUseWeldMap(false),
+		  mOptimiseVertexCache(false),
+		  mReorderVertexFetch(false),
+		  mNarrowIndexBuffers(true),
+		  mNumThreads(1)
 	{
 	}
 	//------------------------------------------------------------------------
@@ -48,18 +80,20 @@ namespace meshmagick
         return "optimise";
     }
 	//------------------------------------------------------------------------
-	void OptimiseTool::doInvoke(const OptionList& toolOptions,
-		const Ogre::StringVector& inFileNames, const Ogre::StringVector& outFileNamesArg)
+	void OptimiseTool::setOptions(const OptionList& toolOptions)
 	{
-		// Name count has to match, else we have no way to figure out how to apply output
-		// names to input files.
-		if (!(outFileNamesArg.empty() || inFileNames.size() == outFileNamesArg.size()))
-		{
-			fail("number of output files must match number of input files.");
-		}
-
 		mPosTolerance = mNormTolerance = mUVTolerance = 1e-06f;
 		mKeepIdentityTracks = OptionsUtil::isOptionSet(toolOptions, "keep-identity-tracks");
+		mStripEdgeLists = OptionsUtil::isOptionSet(toolOptions, "no-edge-lists");
+		mReduceKeyFrames = OptionsUtil::isOptionSet(toolOptions, "reduce-keys");
+		mKeyRotationError = 0.1f;
+		mKeyTranslationError = 0.001f;
+		mKeyScaleError = 0.001f;
+		mUseWeldMap = OptionsUtil::getStringOption(toolOptions, "weld-index", "hash") == "map";
+		mOptimiseVertexCache = OptionsUtil::isOptionSet(toolOptions, "vcache");
+		mReorderVertexFetch = OptionsUtil::isOptionSet(toolOptions, "vfetch");
+		mNarrowIndexBuffers = !OptionsUtil::isOptionSet(toolOptions, "keep-index-width");
+		mNumThreads = ThreadPool::getHardwareThreadCount();
 		for (OptionList::const_iterator it = toolOptions.begin(); it != toolOptions.end(); ++it)
 		{
 			if (it->first == "tolerance")
@@ -78,10 +112,47 @@ namespace meshmagick
 			{
 				mUVTolerance = static_cast<float>(any_cast<Real>(it->second));
 			}
+			else if (it->first == "threads")
+			{
+				int numThreads = any_cast<int>(it->second);
+				if (numThreads > 0)
+				{
+					mNumThreads = static_cast<size_t>(numThreads);
+				}
+			}
+			// Giving any of the keyframe tolerances implies -reduce-keys.
+			else if (it->first == "key_rotation_error")
+			{
+				mKeyRotationError = any_cast<Real>(it->second);
+				mReduceKeyFrames = true;
+			}
+			else if (it->first == "key_translation_error")
+			{
+				mKeyTranslationError = any_cast<Real>(it->second);
+				mReduceKeyFrames = true;
+			}
+			else if (it->first == "key_scale_error")
+			{
+				mKeyScaleError = any_cast<Real>(it->second);
+				mReduceKeyFrames = true;
+			}
+		}
+	}
+	//------------------------------------------------------------------------
+	void OptimiseTool::doInvoke(const OptionList& toolOptions,
+		const Ogre::StringVector& inFileNames, const Ogre::StringVector& outFileNamesArg)
+	{
+		// Name count has to match, else we have no way to figure out how to apply output
+		// names to input files.
+		if (!(outFileNamesArg.empty() || inFileNames.size() == outFileNamesArg.size()))
+		{
+			fail("number of output files must match number of input files.");
 		}
 
+		setOptions(toolOptions);
 
 		StringVector outFileNames = outFileNamesArg.empty() ? inFileNames : outFileNamesArg;
+		mLinkedSkeletons.clear();
 
 		// Process the meshes
 		for (size_t i = 0, end = inFileNames.size(); i < end; ++i)
@@ -99,7 +170,11 @@ namespace meshmagick
 				warn("unrecognised name ending for file " + inFileNames[i]);
 				warn("file skipped.");
 			}
+
+			releaseFileResources();
 		}
+
+		processLinkedSkeletons(inFileNames);
 	}
 	//---------------------------------------------------------------------
 	void OptimiseTool::processMeshFile(Ogre::String file, Ogre::String outFile)
@@ -121,19 +196,86 @@ namespace meshmagick
 			return;
 		}
 		print("Optimising mesh...");
-		processMesh(mesh);
+		doProcessLoadedMesh(mesh, file, outFile);
 		meshSerializer->saveMesh(outFile, true);
 		print("Mesh saved as " + outFile + ".");
+	}
+	//---------------------------------------------------------------------
+	bool OptimiseTool::supportsLoadedMeshes() const
+	{
+		return true;
+	}
+	//---------------------------------------------------------------------
+	void OptimiseTool::doBeginLoadedMeshes(const OptionList& toolOptions)
+	{
+		setOptions(toolOptions);
+		mLinkedSkeletons.clear();
+	}
+	//---------------------------------------------------------------------
+	bool OptimiseTool::doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String&,
+		const Ogre::String&)
+	{
+		processMesh(mesh);
 
 		if (mFollowSkeletonLink && mesh->hasSkeleton())
 		{
-			// In this case keep file name.
-			processSkeletonFile(mesh->getSkeletonName(), mesh->getSkeletonName());
+			// Skeletons are often shared, they are optimised once after all meshes.
+			bool conflict;
+			mLinkedSkeletons.add(mesh->getSkeletonName(), StringUtil::BLANK, conflict);
 		}
+		return true;
+	}
+	//---------------------------------------------------------------------
+	void OptimiseTool::doEndLoadedMeshes()
+	{
+		processLinkedSkeletons(StringVector());
+	}
+	//---------------------------------------------------------------------
+	void OptimiseTool::processLinkedSkeletons(const StringVector& inFileNames)
+	{
+		std::set<String> inputSkeletons;
+		for (size_t i = 0; i < inFileNames.size(); ++i)
+		{
+			if (StringUtil::endsWith(inFileNames[i], ".skeleton", true))
+			{
+				inputSkeletons.insert(SkeletonRegistry::resolvePath(inFileNames[i]));
+			}
+		}
+
+		StatefulSkeletonSerializer* skeletonSerializer =
+			OgreEnvironment::getSingleton().getSkeletonSerializer();
+		for (size_t i = 0; i < mLinkedSkeletons.getNumEntries(); ++i)
+		{
+			// Skeletons given as input file have been optimised already.
+			StringVector fileNames;
+			const StringVector& entryFileNames = mLinkedSkeletons.getEntry(i).fileNames;
+			for (size_t j = 0; j < entryFileNames.size(); ++j)
+			{
+				if (inputSkeletons.count(SkeletonRegistry::resolvePath(entryFileNames[j])) == 0)
+				{
+					fileNames.push_back(entryFileNames[j]);
+				}
+			}
+			if (fileNames.empty())
+			{
+				continue;
+			}
+
+			// In this case keep file names.
+			if (processSkeletonFile(fileNames[0], fileNames[0]))
+			{
+				for (size_t j = 1; j < fileNames.size(); ++j)
+				{
+					skeletonSerializer->saveSkeleton(fileNames[j], true);
+					print("Skeleton saved as " + fileNames[j] + ".");
+				}
+			}
 
+			releaseFileResources();
+		}
 	}
 	//---------------------------------------------------------------------
-	void OptimiseTool::processSkeletonFile(Ogre::String file, Ogre::String outFile)
+	bool OptimiseTool::processSkeletonFile(Ogre::String file, Ogre::String outFile)
 	{
 		StatefulSkeletonSerializer* skeletonSerializer =
 			OgreEnvironment::getSingleton().getSkeletonSerializer();
@@ -149,140 +291,227 @@ namespace meshmagick
 			warn(e.what());
 			warn("Unable to open skeleton file " + file);
 			warn("file skipped.");
-			return;
+			return false;
 		}
 		print("Optimising skeleton...");
 		processSkeleton(skeleton);
 		skeletonSerializer->saveSkeleton(outFile, true);
 		print("Skeleton saved as " + outFile + ".");
-
+		return true;
 	}
 	//---------------------------------------------------------------------
 	void OptimiseTool::processMesh(Ogre::MeshPtr mesh)
 	{
-		bool rebuildEdgeList = false;
-		// Shared geometry
+		// One job for the shared geometry and one for each submesh's dedicated geometry.
+		// Jobs touch disjoint buffers, so they can be run concurrently.
+		std::vector<GeometryJob> jobs;
+		std::vector<int> jobSubMesh;
 		if (mesh->sharedVertexData)
 		{
-			print("Optimising mesh shared vertex data...");
-			setTargetVertexData(mesh->sharedVertexData);
-
+			jobs.push_back(GeometryJob(mesh->sharedVertexData));
+			jobSubMesh.push_back(-1);
 			for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
 			{
 				SubMesh* sm = mesh->getSubMesh(i);
 				if (sm->useSharedVertices)
 				{
-					addIndexData(sm->indexData);
+					jobs.back().subMeshes.push_back(sm);
 				}
 			}
-
-			if (optimiseGeometry())
+		}
+		for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+		{
+			SubMesh* sm = mesh->getSubMesh(i);
+			if (!sm->useSharedVertices)
 			{
-                if (mesh->getSkeletonName() != "")
-				{
-					print("    fixing bone assignments...");
-					Mesh::BoneAssignmentIterator currentIt = mesh->getBoneAssignmentIterator();
-					Mesh::VertexBoneAssignmentList newList =
-						getAdjustedBoneAssignments(currentIt);
-					mesh->clearBoneAssignments();
-					for (Mesh::VertexBoneAssignmentList::iterator bi = newList.begin();
-						bi != newList.end(); ++bi)
-					{
-						mesh->addBoneAssignment(bi->second);
-					}
+				jobs.push_back(GeometryJob(sm->vertexData));
+				jobSubMesh.push_back(i);
+				jobs.back().subMeshes.push_back(sm);
+			}
+		}
 
-				}
+		ThreadPool pool(std::max<size_t>(1, std::min(mNumThreads, jobs.size())));
+		print("Optimising " + StringConverter::toString(jobs.size()) + " vertex data sets on " +
+			StringConverter::toString(pool.getNumThreads()) + " threads...", V_HIGH);
+		pool.run(jobs.size(), [this, &jobs](size_t i) { optimiseGeometry(jobs[i]); });
+
+		// Print the output and fix up bone assignments in job order, so the result
+		// doesn't depend on how the jobs were scheduled.
+		bool rebuildEdgeList = false;
+		const bool fixBones = mesh->getSkeletonName() != "";
+		for (size_t i = 0; i < jobs.size(); ++i)
+		{
+			GeometryJob& job = jobs[i];
+			if (jobSubMesh[i] < 0)
+			{
+				print("Optimising mesh shared vertex data...");
+			}
+			else
+			{
+				print("Optimising submesh " +
+					StringConverter::toString(jobSubMesh[i]) + " dedicated vertex data ");
+			}
+			for (size_t m = 0; m < job.messages.size(); ++m)
+			{
+				print(job.messages[m].first, job.messages[m].second);
+			}
 
-				for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+			if (job.optimised)
+			{
+				if (fixBones)
 				{
-					SubMesh* sm = mesh->getSubMesh(i);
-                    if (mesh->getSkeletonName() != "")
+					// Shared vertices are referenced by the mesh level bone assignments.
+					print("    fixing bone assignments...");
+					if (jobSubMesh[i] < 0)
 					{
-                        print("    fixing bone assignments...");
-						Mesh::BoneAssignmentIterator currentIt = sm->getBoneAssignmentIterator();
-						Mesh::VertexBoneAssignmentList newList =
-							getAdjustedBoneAssignments(currentIt);
-						sm->clearBoneAssignments();
-						for (Mesh::VertexBoneAssignmentList::iterator bi = newList.begin();
-							bi != newList.end(); ++bi)
-						{
-							sm->addBoneAssignment(bi->second);
-						}
-
+						fixBoneAssignments(job, OGRE_GETPOINTER(mesh));
 					}
-					if (sm->useSharedVertices)
+					else
 					{
-						fixLOD(sm->mLodFaceList);
+						fixBoneAssignments(job, job.subMeshes.front());
 					}
 				}
+				// Poses and vertex animation tracks refer to their vertex data by target
+				// handle, which is 0 for shared vertex data, else submesh index + 1.
+				const unsigned short target = static_cast<unsigned short>(jobSubMesh[i] + 1);
+				fixPoses(job, OGRE_GETPOINTER(mesh), target);
+				fixMorphKeyFrames(job, OGRE_GETPOINTER(mesh), target);
+			}
+			if (job.optimised || job.reordered)
+			{
 				rebuildEdgeList = true;
-
 			}
 		}
 
-		// Dedicated geometry
-		for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+		if (mStripEdgeLists && mesh->isEdgeListBuilt())
 		{
-			SubMesh* sm = mesh->getSubMesh(i);
-			if (!sm->useSharedVertices)
-			{
-				print("Optimising submesh " +
-					StringConverter::toString(i) + " dedicated vertex data ");
-				setTargetVertexData(sm->vertexData);
-				addIndexData(sm->indexData);
-				if (optimiseGeometry())
-				{
-                    if (mesh->getSkeletonName() != "")
-					{
-						print("    fixing bone assignments...");
-						Mesh::BoneAssignmentIterator currentIt = sm->getBoneAssignmentIterator();
-						Mesh::VertexBoneAssignmentList newList =
-							getAdjustedBoneAssignments(currentIt);
-						sm->clearBoneAssignments();
-						for (Mesh::VertexBoneAssignmentList::iterator bi = newList.begin();
-							bi != newList.end(); ++bi)
-						{
-							sm->addBoneAssignment(bi->second);
-						}
-
-					}
-
-					fixLOD(sm->mLodFaceList);
-					rebuildEdgeList = true;
-				}
-			}
+			mesh->freeEdgeList();
+			print("Edge lists removed.");
 		}
-
-		if (rebuildEdgeList && mesh->isEdgeListBuilt())
+		else if (rebuildEdgeList && mesh->isEdgeListBuilt())
 		{
 			// force rebuild of edge list
-			mesh->freeEdgeList();
-			mesh->buildEdgeList();
+			EdgeDataBuilder::buildEdgeLists(mesh, mNumThreads);
 		}
 
 
 	}
 	//---------------------------------------------------------------------
-	void OptimiseTool::fixLOD(SubMesh::LODFaceList lodFaces)
+	void OptimiseTool::fixBoneAssignments(const GeometryJob& job, Mesh* mesh)
+	{
+		Mesh::BoneAssignmentIterator currentIt = mesh->getBoneAssignmentIterator();
+		Mesh::VertexBoneAssignmentList newList =
+			getAdjustedBoneAssignments(job, currentIt);
+		mesh->clearBoneAssignments();
+		for (Mesh::VertexBoneAssignmentList::iterator bi = newList.begin();
+			bi != newList.end(); ++bi)
+		{
+			mesh->addBoneAssignment(bi->second);
+		}
+	}
+	//---------------------------------------------------------------------
+	void OptimiseTool::fixBoneAssignments(const GeometryJob& job, SubMesh* sm)
 	{
-		for (SubMesh::LODFaceList::iterator l = lodFaces.begin();
-			l != lodFaces.end(); ++l)
+		Mesh::BoneAssignmentIterator currentIt = sm->getBoneAssignmentIterator();
+		Mesh::VertexBoneAssignmentList newList =
+			getAdjustedBoneAssignments(job, currentIt);
+		sm->clearBoneAssignments();
+		for (Mesh::VertexBoneAssignmentList::iterator bi = newList.begin();
+			bi != newList.end(); ++bi)
 		{
-			IndexData* idata = *l;
-			print("    fixing LOD...");
-			remapIndexes(idata);
+			sm->addBoneAssignment(bi->second);
+		}
+	}
+	//---------------------------------------------------------------------
+	void OptimiseTool::fixPoses(const GeometryJob& job, Mesh* mesh, unsigned short target)
+	{
+		for (size_t p = 0; p < mesh->getPoseCount(); ++p)
+		{
+			Pose* pose = mesh->getPose(static_cast<unsigned short>(p));
+			if (pose->getTarget() != target)
+			{
+				continue;
+			}
+
+			print("    fixing pose " + pose->getName() + "...");
+			const bool includesNormals = pose->getIncludesNormals();
+			Pose::VertexOffsetMap offsets = pose->getVertexOffsets();
+			Pose::NormalsMap normals = pose->getNormals();
+			pose->clearVertices();
+			for (Pose::VertexOffsetMap::iterator it = offsets.begin(); it != offsets.end(); ++it)
+			{
+				// Like bone assignments, only keep the offsets of the originating vertex.
+				if (it->first >= job.indexRemap.size() || !job.indexRemap[it->first].isOriginal)
+				{
+					continue;
+				}
+				const IndexInfo& ii = job.indexRemap[it->first];
+
+				if (includesNormals)
+				{
+					pose->addVertex(ii.targetIndex, it->second, normals[it->first]);
+				}
+				else
+				{
+					pose->addVertex(ii.targetIndex, it->second);
+				}
+			}
 		}
+	}
+	//---------------------------------------------------------------------
+	void OptimiseTool::fixMorphKeyFrames(const GeometryJob& job, Mesh* mesh, unsigned short target)
+	{
+		for (unsigned short a = 0; a < mesh->getNumAnimations(); ++a)
+		{
+			Animation* anim = mesh->getAnimation(a);
+			if (!anim->hasVertexTrack(target))
+			{
+				continue;
+			}
+			VertexAnimationTrack* track = anim->getVertexTrack(target);
+			if (track->getAnimationType() != VAT_MORPH)
+			{
+				continue;
+			}
+
+			print("    fixing morph animation " + anim->getName() + "...");
+			for (unsigned short k = 0; k < track->getNumKeyFrames(); ++k)
+			{
+				// Morph key frames hold a full copy of the vertex positions, so they are
+				// rebuilt from the unique vertex list just like the vertex buffers.
+				VertexMorphKeyFrame* kf = track->getVertexMorphKeyFrame(k);
+				HardwareVertexBufferSharedPtr srcBuf = kf->getVertexBuffer();
+				const size_t vertexSize = srcBuf->getVertexSize();
+				HardwareVertexBufferSharedPtr newBuf =
+					HardwareBufferManager::getSingleton().createVertexBuffer(
+						vertexSize, job.uniqueVertexList.size(),
+						srcBuf->getUsage(), srcBuf->hasShadowBuffer());
+
+				const char* pSrc = static_cast<const char*>(
+					srcBuf->lock(HardwareBuffer::HBL_READ_ONLY));
+				char* pDest = static_cast<char*>(newBuf->lock(HardwareBuffer::HBL_DISCARD));
+				for (UniqueVertexList::const_iterator ui = job.uniqueVertexList.begin();
+					ui != job.uniqueVertexList.end(); ++ui)
+				{
+					memcpy(pDest, pSrc + vertexSize * ui->oldIndex, vertexSize);
+					pDest += vertexSize;
+				}
+				newBuf->unlock();
+				srcBuf->unlock();
 
+				kf->setVertexBuffer(newBuf);
+			}
+		}
 	}
 	//---------------------------------------------------------------------
 	Mesh::VertexBoneAssignmentList OptimiseTool::getAdjustedBoneAssignments(
-		Mesh::BoneAssignmentIterator& it)
+		const GeometryJob& job, Mesh::BoneAssignmentIterator& it)
 	{
 		Mesh::VertexBoneAssignmentList newList;
 		while (it.hasMoreElements())
 		{
 			VertexBoneAssignment ass = it.getNext();
-			IndexInfo& ii = mIndexRemap[ass.vertexIndex];
+			const IndexInfo& ii = job.indexRemap[ass.vertexIndex];
 
 			// If this is the originating vertex index  we want to add the (adjusted)
 			// bone assignments. If it's another vertex that was collapsed onto another
@@ -290,7 +519,7 @@ namespace meshmagick
 			if (ii.isOriginal)
 			{
 				ass.vertexIndex = static_cast<unsigned int>(ii.targetIndex);
-				assert (ass.vertexIndex < mUniqueVertexMap.size());
+				assert (ass.vertexIndex < job.uniqueVertexList.size());
 				newList.insert(Mesh::VertexBoneAssignmentList::value_type(
 					ass.vertexIndex, ass));
 
@@ -305,160 +534,299 @@ namespace meshmagick
 	void OptimiseTool::processSkeleton(Ogre::SkeletonPtr skeleton)
 	{
 		skeleton->optimiseAllAnimations(mKeepIdentityTracks);
+		if (mReduceKeyFrames)
+		{
+			reduceKeyFrames(skeleton);
+		}
 	}
 	//---------------------------------------------------------------------
-	void OptimiseTool::setTargetVertexData(Ogre::VertexData* vd)
-	{
-		mTargetVertexData = vd;
-		mUniqueVertexMap.clear();
-		mUniqueVertexList.clear();
-		mIndexDataList.clear();
-		mIndexRemap.clear();
-	}
-	//---------------------------------------------------------------------
-	void OptimiseTool::addIndexData(Ogre::IndexData* id)
+	void OptimiseTool::reduceKeyFrames(Ogre::SkeletonPtr skeleton)
 	{
-		mIndexDataList.push_back(id);
+		struct TrackJob
+		{
+			Animation* animation;
+			NodeAnimationTrack* track;
+			Real chainLength;
+			std::vector<unsigned short> redundantKeys;
+		};
+
+		const std::vector<Real> chainLengths =
+			KeyFrameReducer::getChainLengths(OGRE_GETPOINTER(skeleton));
+		std::vector<TrackJob> jobs;
+		for (unsigned short a = 0; a < skeleton->getNumAnimations(); ++a)
+		{
+			Animation* anim = skeleton->getAnimation(a);
+			if (anim->getInterpolationMode() != Animation::IM_LINEAR)
+			{
+				// Dropping keys would change the spline through the remaining ones.
+				print("    animation " + anim->getName() +
+					" uses spline interpolation, keyframes kept.", V_HIGH);
+				continue;
+			}
+			Animation::NodeTrackIterator it = anim->getNodeTrackIterator();
+			while (it.hasMoreElements())
+			{
+				TrackJob job;
+				job.animation = anim;
+				job.track = it.getNext();
+				const unsigned short handle = job.track->getHandle();
+				job.chainLength = handle < chainLengths.size() ? chainLengths[handle] : 1;
+				jobs.push_back(job);
+			}
+		}
+
+		// Tracks are only read concurrently, removing keys marks the animation dirty.
+		const KeyFrameReducer reducer(mKeyRotationError, mKeyTranslationError, mKeyScaleError);
+		ThreadPool pool(std::max<size_t>(1, std::min(mNumThreads, jobs.size())));
+		print("Reducing keyframes of " + StringConverter::toString(jobs.size()) +
+			" tracks on " + StringConverter::toString(pool.getNumThreads()) + " threads...",
+			V_HIGH);
+		pool.run(jobs.size(), [&reducer, &jobs](size_t i) {
+			TrackJob& job = jobs[i];
+			reducer.findRedundantKeys(job.track, job.animation->getRotationInterpolationMode(),
+				job.chainLength, job.redundantKeys);
+		});
+
+		// Jobs are grouped by animation, report each one's total.
+		size_t i = 0;
+		while (i < jobs.size())
+		{
+			Animation* anim = jobs[i].animation;
+			size_t keysBefore = 0;
+			size_t keysRemoved = 0;
+			for (; i < jobs.size() && jobs[i].animation == anim; ++i)
+			{
+				TrackJob& job = jobs[i];
+				keysBefore += job.track->getNumKeyFrames();
+				keysRemoved += job.redundantKeys.size();
+				for (size_t k = job.redundantKeys.size(); k > 0; --k)
+				{
+					job.track->removeKeyFrame(job.redundantKeys[k - 1]);
+				}
+			}
+			print("    animation " + anim->getName() + ": " +
+				StringConverter::toString(keysBefore) + " keyframes, " +
+				StringConverter::toString(keysRemoved) + " removed.");
+		}
 	}
 	//---------------------------------------------------------------------
-	bool OptimiseTool::optimiseGeometry()
+	bool OptimiseTool::optimiseGeometry(GeometryJob& job)
 	{
-		if (calculateDuplicateVertices())
+		const bool duplicates = calculateDuplicateVertices(job);
+		// Welding can turn triangles degenerate, and removing those can leave vertices
+		// unreferenced, so this order matters.
+		const size_t numDegenerates = removeDegenerateTriangles(job);
+		const size_t numUnreferenced = removeUnreferencedVertices(job);
+		if (numDegenerates > 0)
+		{
+			job.print("    " + StringConverter::toString(numDegenerates) +
+				" degenerate triangles removed.");
+			job.reordered = true;
+		}
+		if (duplicates || numUnreferenced > 0)
 		{
-			size_t numDupes = mTargetVertexData->vertexCount -
-				mUniqueVertexMap.size();
-			print("    " + StringConverter::toString(mTargetVertexData->vertexCount) +
+			size_t numDupes = job.targetVertexData->vertexCount -
+				job.uniqueVertexList.size() - numUnreferenced;
+			job.print("    " + StringConverter::toString(job.targetVertexData->vertexCount) +
 				" source vertices.");
-			print("    " + StringConverter::toString(numDupes) +
+			job.print("    " + StringConverter::toString(numDupes) +
 				" duplicate vertices to be removed.");
-			print("    " + StringConverter::toString(mUniqueVertexMap.size()) +
+			job.print("    " + StringConverter::toString(numUnreferenced) +
+				" unreferenced vertices to be removed.");
+			job.print("    " + StringConverter::toString(job.uniqueVertexList.size()) +
 				" vertices will remain.");
-			print("    rebuilding vertex buffers...");
-			rebuildVertexBuffers();
-			print("    re-indexing faces...");
-			remapIndexDataList();
-			print("    done.");
-			return true;
+			job.print("    rebuilding vertex buffers...");
+			rebuildVertexBuffers(job);
+			job.print("    re-indexing faces...");
+			remapIndexDataList(job);
+			job.optimised = true;
 		}
-		else
+
+		if (mOptimiseVertexCache)
+		{
+			job.print("    optimising triangle order for the vertex cache...");
+			optimiseVertexCache(job);
+		}
+		// Has to come last, as it depends on the final triangle order.
+		if (mReorderVertexFetch)
+		{
+			job.print("    reordering vertices by first use...");
+			if (reorderVertexFetch(job))
+			{
+				job.optimised = true;
+			}
+			else
+			{
+				job.print("    vertices already in order.", V_HIGH);
+			}
+		}
+		// Welding usually brings the vertex count below the 16 bit limit.
+		const bool narrowed = mNarrowIndexBuffers && narrowIndexBuffers(job);
+
+		if (!job.optimised && !job.reordered && !narrowed)
 		{
-			print("    no optimisation required.");
+			job.print("    no optimisation required.");
 			return false;
 		}
+		job.print("    done.");
+		return true;
 	}
 	//---------------------------------------------------------------------
-	bool OptimiseTool::calculateDuplicateVertices()
+	bool OptimiseTool::calculateDuplicateVertices(GeometryJob& job)
 	{
 		bool duplicates = false;
+		Timer timer;
 
 		// Lock all the buffers first
 		typedef std::vector<char*> BufferLocks;
 		BufferLocks bufferLocks;
 		const VertexBufferBinding::VertexBufferBindingMap& bindings =
-			mTargetVertexData->vertexBufferBinding->getBindings();
+			job.targetVertexData->vertexBufferBinding->getBindings();
 		VertexBufferBinding::VertexBufferBindingMap::const_iterator bindi;
-		bufferLocks.resize(mTargetVertexData->vertexBufferBinding->getLastBoundIndex()+1);
+		bufferLocks.resize(job.targetVertexData->vertexBufferBinding->getLastBoundIndex()+1);
 		for (bindi = bindings.begin(); bindi != bindings.end(); ++bindi)
 		{
 			char* lock = static_cast<char*>(bindi->second->lock(HardwareBuffer::HBL_READ_ONLY));
 			bufferLocks[bindi->first] = lock;
 		}
 
-		for (uint32 v = 0; v < mTargetVertexData->vertexCount; ++v)
+		const VertexDeclaration::VertexElementList& elemList =
+			job.targetVertexData->vertexDeclaration->getElements();
+		VertexDeclaration::VertexElementList::const_iterator elemi;
+		// Elements are decoded a chunk of vertices at a time, four floats each.
+		const uint32 decodeChunkSize = 256;
+		std::vector<float> decoded(elemList.size() * decodeChunkSize * 4);
+
+		const uint32 vertexCount = static_cast<uint32>(job.targetVertexData->vertexCount);
+		for (uint32 v = 0; v < vertexCount; ++v)
 		{
+			const uint32 chunkIndex = v % decodeChunkSize;
+			if (chunkIndex == 0)
+			{
+				// decode whatever the element's type is, so packed and
+				// compressed formats compare the same as floats
+				size_t e = 0;
+				for (elemi = elemList.begin(); elemi != elemList.end(); ++elemi, ++e)
+				{
+					void* pElem;
+					elemi->baseVertexPointerToElement(
+						bufferLocks[elemi->getSource()], &pElem);
+					MeshUtils::decodeVertexElements(elemi->getType(), pElem,
+						job.targetVertexData->vertexBufferBinding->getBuffer(
+							elemi->getSource())->getVertexSize(),
+						std::min(decodeChunkSize, vertexCount - v),
+						&decoded[e * decodeChunkSize * 4]);
+				}
+			}
+
 			UniqueVertex uniqueVertex;
-			const VertexDeclaration::VertexElementList& elemList =
-				mTargetVertexData->vertexDeclaration->getElements();
-			VertexDeclaration::VertexElementList::const_iterator elemi;
 			unsigned short uvSets = 0;
-			for (elemi = elemList.begin(); elemi != elemList.end(); ++elemi)
+			size_t e = 0;
+			for (elemi = elemList.begin(); elemi != elemList.end(); ++elemi, ++e)
 			{
-				// all float pointers for the moment
-				float *pFloat;
-				elemi->baseVertexPointerToElement(
-					bufferLocks[elemi->getSource()], &pFloat);
+				const float* values = &decoded[(e * decodeChunkSize + chunkIndex) * 4];
+				const Vector3 value3(values[0], values[1], values[2]);
+				const Vector4 value(values[0], values[1], values[2], values[3]);
 
 				switch(elemi->getSemantic())
 				{
 				case VES_POSITION:
-					uniqueVertex.position.x = *pFloat++;
-					uniqueVertex.position.y = *pFloat++;
-					uniqueVertex.position.z = *pFloat++;
+					uniqueVertex.position = value3;
 					break;
 				case VES_NORMAL:
-					uniqueVertex.normal.x = *pFloat++;
-					uniqueVertex.normal.y = *pFloat++;
-					uniqueVertex.normal.z = *pFloat++;
+					uniqueVertex.normal = value3;
 					break;
 				case VES_TANGENT:
-					uniqueVertex.tangent.x = *pFloat++;
-					uniqueVertex.tangent.y = *pFloat++;
-					uniqueVertex.tangent.z = *pFloat++;
-					// support w-component on tangent if present
-					if (VertexElement::getTypeCount(elemi->getType()) == 4)
-					{
-						uniqueVertex.tangent.w = *pFloat++;
-					}
+					// w holds the handedness if present, 0 otherwise
+					uniqueVertex.tangent = value;
 					break;
 				case VES_BINORMAL:
-					uniqueVertex.binormal.x = *pFloat++;
-					uniqueVertex.binormal.y = *pFloat++;
-					uniqueVertex.binormal.z = *pFloat++;
+					uniqueVertex.binormal = value3;
 					break;
 				case VES_TEXTURE_COORDINATES:
 					// supports up to 4 dimensions
-					for (unsigned short dim = 0;
-						dim < VertexElement::getTypeCount(elemi->getType()); ++dim)
-					{
-						uniqueVertex.uv[elemi->getIndex()][dim] = *pFloat++;
-					}
+					uniqueVertex.uv[elemi->getIndex()] = value;
 					++uvSets;
 					break;
-				case VES_BLEND_INDICES:
-				case VES_BLEND_WEIGHTS:
 				case VES_DIFFUSE:
+					uniqueVertex.diffuse = value;
+					break;
 				case VES_SPECULAR:
-					// No action needed for these semantics.
+					uniqueVertex.specular = value;
+					break;
+				case VES_BLEND_WEIGHTS:
+					uniqueVertex.blendWeights = value;
+					break;
+				case VES_BLEND_INDICES:
+					uniqueVertex.blendIndices = value;
 					break;
 				};
 			}
 
 			if (v == 0)
 			{
-				// set up comparator
-				UniqueVertexLess lessObj;
-				lessObj.pos_tolerance = mPosTolerance;
-				lessObj.norm_tolerance = mNormTolerance;
-				lessObj.uv_tolerance = mUVTolerance;
-				lessObj.uvSets = uvSets;
-				mUniqueVertexMap = UniqueVertexMap(lessObj);
+				if (mUseWeldMap)
+				{
+					// set up comparator
+					UniqueVertexLess lessObj;
+					lessObj.pos_tolerance = mPosTolerance;
+					lessObj.norm_tolerance = mNormTolerance;
+					lessObj.uv_tolerance = mUVTolerance;
+					lessObj.uvSets = uvSets;
+					job.uniqueVertexMap = UniqueVertexMap(lessObj);
+				}
+				else
+				{
+					job.uniqueVertexGrid.reset(mPosTolerance, mNormTolerance, mUVTolerance,
+						uvSets, job.targetVertexData->vertexCount);
+				}
 			}
 
 			// try to locate equivalent vertex in the list already
 			uint32 indexUsed;
-			UniqueVertexMap::iterator ui = mUniqueVertexMap.find(uniqueVertex);
+			bool found;
+			if (mUseWeldMap)
+			{
+				UniqueVertexMap::iterator ui = job.uniqueVertexMap.find(uniqueVertex);
+				found = ui != job.uniqueVertexMap.end();
+				if (found)
+				{
+					indexUsed = ui->second.newIndex;
+				}
+			}
+			else
+			{
+				found = job.uniqueVertexGrid.find(uniqueVertex, indexUsed);
+			}
+
 			bool isOrig = false;
-			if (ui != mUniqueVertexMap.end())
+			if (found)
 			{
 				// re-use vertex, remap
-				indexUsed = ui->second.newIndex;
 				duplicates = true;
 			}
 			else
 			{
 				// new vertex
 				isOrig = true;
-				indexUsed = static_cast<uint32>(mUniqueVertexMap.size());
+				indexUsed = static_cast<uint32>(job.uniqueVertexList.size());
 				// store the originating and new vertex index in the unique map
 				VertexInfo newInfo(v, indexUsed);
 				// lookup
-				mUniqueVertexMap[uniqueVertex] = newInfo;
+				if (mUseWeldMap)
+				{
+					job.uniqueVertexMap[uniqueVertex] = newInfo;
+				}
+				else
+				{
+					job.uniqueVertexGrid.insert(uniqueVertex, indexUsed);
+				}
 				// ordered
-				mUniqueVertexList.push_back(newInfo);
+				job.uniqueVertexList.push_back(newInfo);
 
 			}
 			// Insert remap entry (may map to itself)
-			mIndexRemap.push_back(IndexInfo(indexUsed, isOrig));
+			job.indexRemap.push_back(IndexInfo(indexUsed, isOrig));
 
 
 			// increment buffer lock pointers
@@ -476,38 +844,187 @@ namespace meshmagick
 			bindi->second->unlock();
 		}
 
+		job.print("    duplicate search (" + String(mUseWeldMap ? "map" : "hash grid") + ") took " +
+			StringConverter::toString(timer.getMicroseconds() / 1000.0f) + " ms.", V_HIGH);
+
 		// Were there duplicates?
 		return duplicates;
 
 	}
 	//---------------------------------------------------------------------
-	void OptimiseTool::rebuildVertexBuffers()
+	size_t OptimiseTool::removeDegenerateTriangles(GeometryJob& job)
+	{
+		std::vector<Vector3> positions;
+		MeshUtils::getPositions(job.targetVertexData, positions);
+
+		size_t removed = 0;
+		std::vector<uint32> indices;
+		std::vector<uint32> kept;
+		for (SubMeshList::iterator i = job.subMeshes.begin(); i != job.subMeshes.end(); ++i)
+		{
+			SubMesh* sm = *i;
+			// Strips and fans need degenerate triangles to connect their parts.
+			if (sm->operationType != RenderOperation::OT_TRIANGLE_LIST)
+			{
+				continue;
+			}
+
+			std::vector<IndexData*> indexDatas(1, sm->indexData);
+			indexDatas.insert(indexDatas.end(), sm->mLodFaceList.begin(), sm->mLodFaceList.end());
+			for (size_t l = 0; l < indexDatas.size(); ++l)
+			{
+				IndexData* idata = indexDatas[l];
+				MeshUtils::getIndices(idata, indices);
+				kept.clear();
+				for (size_t t = 0; t + 2 < indices.size(); t += 3)
+				{
+					// Compare the welded vertices, the indices are remapped later.
+					const uint32 a = job.indexRemap[indices[t]].targetIndex;
+					const uint32 b = job.indexRemap[indices[t + 1]].targetIndex;
+					const uint32 c = job.indexRemap[indices[t + 2]].targetIndex;
+					if (a == b || b == c || c == a)
+					{
+						continue;
+					}
+					const Vector3& pa = positions[job.uniqueVertexList[a].oldIndex];
+					const Vector3& pb = positions[job.uniqueVertexList[b].oldIndex];
+					const Vector3& pc = positions[job.uniqueVertexList[c].oldIndex];
+					if ((pb - pa).crossProduct(pc - pa) == Vector3::ZERO)
+					{
+						continue;
+					}
+					kept.insert(kept.end(), indices.begin() + t, indices.begin() + t + 3);
+				}
+
+				if (kept.size() == indices.size())
+				{
+					continue;
+				}
+				if (kept.empty())
+				{
+					// An empty index data would draw the vertex data without indices.
+					job.print("    all triangles of an index data are degenerate, kept.",
+						V_HIGH);
+					continue;
+				}
+				removed += (indices.size() - kept.size()) / 3;
+				HardwareIndexBufferSharedPtr buffer = idata->indexBuffer;
+				if (MeshUtils::coversIndexBuffer(idata))
+				{
+					// The index data uses the whole buffer, so shrink it. Otherwise the
+					// unused tail is saved too and changeIndexType can't narrow it.
+					std::lock_guard<std::mutex> managerLock(mBufferManagerMutex);
+					idata->indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+						buffer->getType(), kept.size(), buffer->getUsage(),
+						buffer->hasShadowBuffer());
+				}
+				idata->indexCount = kept.size();
+				MeshUtils::setIndices(idata, kept);
+			}
+		}
+		return removed;
+	}
+	//---------------------------------------------------------------------
+	size_t OptimiseTool::removeUnreferencedVertices(GeometryJob& job)
+	{
+		if (job.subMeshes.empty())
+		{
+			return 0;
+		}
+
+		std::vector<bool> referenced(job.uniqueVertexList.size(), false);
+		std::vector<uint32> indices;
+		for (SubMeshList::iterator i = job.subMeshes.begin(); i != job.subMeshes.end(); ++i)
+		{
+			SubMesh* sm = *i;
+			if (sm->indexData->indexCount == 0)
+			{
+				// Drawn without indices, so every vertex is used.
+				return 0;
+			}
+
+			std::vector<IndexData*> indexDatas(1, sm->indexData);
+			indexDatas.insert(indexDatas.end(), sm->mLodFaceList.begin(), sm->mLodFaceList.end());
+			for (size_t l = 0; l < indexDatas.size(); ++l)
+			{
+				MeshUtils::getIndices(indexDatas[l], indices);
+				for (size_t j = 0; j < indices.size(); ++j)
+				{
+					referenced[job.indexRemap[indices[j]].targetIndex] = true;
+				}
+			}
+		}
+
+		const size_t removed = std::count(referenced.begin(), referenced.end(), false);
+		if (removed == 0)
+		{
+			return 0;
+		}
+
+		// Compact the unique vertex list and point the remap at the new positions.
+		std::vector<uint32> newIndices(job.uniqueVertexList.size());
+		UniqueVertexList keptVertices;
+		keptVertices.reserve(job.uniqueVertexList.size() - removed);
+		for (size_t v = 0; v < job.uniqueVertexList.size(); ++v)
+		{
+			if (referenced[v])
+			{
+				newIndices[v] = static_cast<uint32>(keptVertices.size());
+				keptVertices.push_back(
+					VertexInfo(job.uniqueVertexList[v].oldIndex, newIndices[v]));
+			}
+		}
+		job.uniqueVertexList.swap(keptVertices);
+
+		for (IndexRemap::iterator ii = job.indexRemap.begin(); ii != job.indexRemap.end(); ++ii)
+		{
+			if (referenced[ii->targetIndex])
+			{
+				ii->targetIndex = newIndices[ii->targetIndex];
+			}
+			else
+			{
+				// Not copied, so bone assignments, poses and morph frames drop it.
+				ii->targetIndex = 0;
+				ii->isOriginal = false;
+			}
+		}
+		return removed;
+	}
+	//---------------------------------------------------------------------
+	void OptimiseTool::rebuildVertexBuffers(GeometryJob& job)
 	{
 		// We need to build new vertex buffers of the new, reduced size
-		VertexBufferBinding* newBind =
-			HardwareBufferManager::getSingleton().createVertexBufferBinding();
+		VertexBufferBinding* newBind;
+		{
+			std::lock_guard<std::mutex> lock(mBufferManagerMutex);
+			newBind = HardwareBufferManager::getSingleton().createVertexBufferBinding();
+		}
 
 		// Lock source buffers
 		typedef std::vector<char*> BufferLocks;
 		BufferLocks srcbufferLocks;
 		BufferLocks destbufferLocks;
 		const VertexBufferBinding::VertexBufferBindingMap& srcBindings =
-			mTargetVertexData->vertexBufferBinding->getBindings();
+			job.targetVertexData->vertexBufferBinding->getBindings();
 		VertexBufferBinding::VertexBufferBindingMap::const_iterator bindi;
-		srcbufferLocks.resize(mTargetVertexData->vertexBufferBinding->getLastBoundIndex()+1);
-		destbufferLocks.resize(mTargetVertexData->vertexBufferBinding->getLastBoundIndex()+1);
+		srcbufferLocks.resize(job.targetVertexData->vertexBufferBinding->getLastBoundIndex()+1);
+		destbufferLocks.resize(job.targetVertexData->vertexBufferBinding->getLastBoundIndex()+1);
 		for (bindi = srcBindings.begin(); bindi != srcBindings.end(); ++bindi)
 		{
 			char* lock = static_cast<char*>(bindi->second->lock(HardwareBuffer::HBL_READ_ONLY));
 			srcbufferLocks[bindi->first] = lock;
 
 			// Add a new vertex buffer and binding
-			HardwareVertexBufferSharedPtr newBuf =
-				HardwareBufferManager::getSingleton().createVertexBuffer(
+			HardwareVertexBufferSharedPtr newBuf;
+			{
+				std::lock_guard<std::mutex> managerLock(mBufferManagerMutex);
+				newBuf = HardwareBufferManager::getSingleton().createVertexBuffer(
 					bindi->second->getVertexSize(),
-					mUniqueVertexList.size(),
+					job.uniqueVertexList.size(),
 					bindi->second->getUsage(),
 					bindi->second->hasShadowBuffer());
+			}
 			newBind->setBinding(bindi->first, newBuf);
 			lock = static_cast<char*>(newBuf->lock(HardwareBuffer::HBL_DISCARD));
 			destbufferLocks[bindi->first] = lock;
@@ -517,8 +1034,8 @@ namespace meshmagick
 
 
 		// Iterate over the new vertices
-		for (UniqueVertexList::iterator ui = mUniqueVertexList.begin();
-			ui != mUniqueVertexList.end(); ++ui)
+		for (UniqueVertexList::iterator ui = job.uniqueVertexList.begin();
+			ui != job.uniqueVertexList.end(); ++ui)
 		{
 			uint32 origVertexIndex = ui->oldIndex;
 			// copy vertex from each buffer in turn
@@ -552,28 +1069,230 @@ namespace meshmagick
 		}
 
 		// now switch over the bindings, and thus the buffers
-		VertexBufferBinding* oldBind = mTargetVertexData->vertexBufferBinding;
-		mTargetVertexData->vertexBufferBinding = newBind;
-		HardwareBufferManager::getSingleton().destroyVertexBufferBinding(oldBind);
+		VertexBufferBinding* oldBind = job.targetVertexData->vertexBufferBinding;
+		job.targetVertexData->vertexBufferBinding = newBind;
+		{
+			// Releasing the old buffers unregisters them from the manager as well.
+			std::lock_guard<std::mutex> lock(mBufferManagerMutex);
+			HardwareBufferManager::getSingleton().destroyVertexBufferBinding(oldBind);
+		}
 
 		// Update vertex count in data
-		mTargetVertexData->vertexCount = mUniqueVertexList.size();
+		job.targetVertexData->vertexCount = job.uniqueVertexList.size();
+
+
+	}
+	//---------------------------------------------------------------------
+	void OptimiseTool::remapIndexDataList(GeometryJob& job)
+	{
+		for (SubMeshList::iterator i = job.subMeshes.begin(); i != job.subMeshes.end(); ++i)
+		{
+			SubMesh* sm = *i;
+			remapIndexes(job, sm->indexData);
+
+			for (SubMesh::LODFaceList::iterator l = sm->mLodFaceList.begin();
+				l != sm->mLodFaceList.end(); ++l)
+			{
+				job.print("    fixing LOD...");
+				remapIndexes(job, *l);
+			}
+		}
+
+	}
+	//---------------------------------------------------------------------
+	void OptimiseTool::optimiseVertexCache(GeometryJob& job)
+	{
+		const size_t vertexCount = job.targetVertexData->vertexCount;
+		size_t triangles[2] = {0, 0};
+		size_t missesBefore[2] = {0, 0};
+		size_t missesAfter[2] = {0, 0};
+		std::vector<uint32> indices;
+
+		for (SubMeshList::iterator i = job.subMeshes.begin(); i != job.subMeshes.end(); ++i)
+		{
+			SubMesh* sm = *i;
+			// Strips and fans depend on the order, only lists can be reordered.
+			if (sm->operationType != RenderOperation::OT_TRIANGLE_LIST)
+			{
+				continue;
+			}
+
+			// Index data of the full detail level first, then the LOD levels.
+			std::vector<IndexData*> indexDatas(1, sm->indexData);
+			indexDatas.insert(indexDatas.end(), sm->mLodFaceList.begin(), sm->mLodFaceList.end());
+			for (size_t l = 0; l < indexDatas.size(); ++l)
+			{
+				IndexData* idata = indexDatas[l];
+				const size_t stat = l == 0 ? 0 : 1;
+				MeshUtils::getIndices(idata, indices);
+				if (indices.size() < 6 ||
+					*std::max_element(indices.begin(), indices.end()) >= vertexCount)
+				{
+					continue;
+				}
+
+				const size_t before = VertexCacheOptimiser::countCacheMisses(indices, vertexCount);
+				VertexCacheOptimiser::optimise(indices, vertexCount);
+				const size_t after = VertexCacheOptimiser::countCacheMisses(indices, vertexCount);
+				triangles[stat] += indices.size() / 3;
+				missesBefore[stat] += before;
+				if (after < before)
+				{
+					MeshUtils::setIndices(idata, indices);
+					missesAfter[stat] += after;
+					job.reordered = true;
+				}
+				else
+				{
+					// Keep the original order if it already was as good.
+					missesAfter[stat] += before;
+				}
+			}
+		}
+
+		const char* names[2] = {"faces", "LOD faces"};
+		for (size_t stat = 0; stat < 2; ++stat)
+		{
+			if (triangles[stat] > 0)
+			{
+				job.print("    ACMR of " + String(names[stat]) + " " +
+					StringConverter::toString(Real(missesBefore[stat]) / triangles[stat], 3) +
+					" before, " +
+					StringConverter::toString(Real(missesAfter[stat]) / triangles[stat], 3) +
+					" after.");
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	bool OptimiseTool::reorderVertexFetch(GeometryJob& job)
+	{
+		// Number vertices in the order the index data first references them, full detail
+		// levels before LOD levels. Unreferenced vertices go last, in their current order.
+		const uint32 unused = 0xffffffff;
+		const size_t vertexCount = job.targetVertexData->vertexCount;
+		std::vector<uint32> fetchIndex(vertexCount, unused);
+		std::vector<uint32> fetchOrder;
+		fetchOrder.reserve(vertexCount);
+		std::vector<IndexData*> indexDatas;
+		for (SubMeshList::iterator i = job.subMeshes.begin(); i != job.subMeshes.end(); ++i)
+		{
+			indexDatas.push_back((*i)->indexData);
+		}
+		for (SubMeshList::iterator i = job.subMeshes.begin(); i != job.subMeshes.end(); ++i)
+		{
+			indexDatas.insert(indexDatas.end(),
+				(*i)->mLodFaceList.begin(), (*i)->mLodFaceList.end());
+		}
+
+		std::vector<uint32> indices;
+		for (size_t i = 0; i < indexDatas.size(); ++i)
+		{
+			MeshUtils::getIndices(indexDatas[i], indices);
+			for (size_t j = 0; j < indices.size(); ++j)
+			{
+				const uint32 v = indices[j];
+				if (v < vertexCount && fetchIndex[v] == unused)
+				{
+					fetchIndex[v] = static_cast<uint32>(fetchOrder.size());
+					fetchOrder.push_back(v);
+				}
+			}
+		}
+		for (uint32 v = 0; v < vertexCount; ++v)
+		{
+			if (fetchIndex[v] == unused)
+			{
+				fetchIndex[v] = static_cast<uint32>(fetchOrder.size());
+				fetchOrder.push_back(v);
+			}
+		}
+
+		bool identity = true;
+		for (uint32 v = 0; v < vertexCount && identity; ++v)
+		{
+			identity = fetchIndex[v] == v;
+		}
+		if (identity)
+		{
+			return false;
+		}
+
+		// Rebuild buffers and indexes with the permutation as the job's remap, then
+		// compose it with the welding remap, so that fixing up bone assignments, poses
+		// and morph animations maps from the original vertices in one step.
+		IndexRemap weldRemap;
+		weldRemap.swap(job.indexRemap);
+		UniqueVertexList weldList;
+		weldList.swap(job.uniqueVertexList);
+		job.indexRemap.reserve(vertexCount);
+		job.uniqueVertexList.reserve(vertexCount);
+		for (uint32 v = 0; v < vertexCount; ++v)
+		{
+			job.indexRemap.push_back(IndexInfo(fetchIndex[v], true));
+			job.uniqueVertexList.push_back(VertexInfo(fetchOrder[v], v));
+		}
+
+		rebuildVertexBuffers(job);
+		for (size_t i = 0; i < indexDatas.size(); ++i)
+		{
+			remapIndexes(job, indexDatas[i]);
+		}
 
+		for (size_t v = 0; v < weldRemap.size(); ++v)
+		{
+			weldRemap[v].targetIndex = fetchIndex[weldRemap[v].targetIndex];
+		}
+		job.indexRemap.swap(weldRemap);
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			job.uniqueVertexList[v].oldIndex = weldList[fetchOrder[v]].oldIndex;
+		}
 
+		return true;
 	}
 	//---------------------------------------------------------------------
-	void OptimiseTool::remapIndexDataList()
+	bool OptimiseTool::narrowIndexBuffers(GeometryJob& job)
 	{
-		for (IndexDataList::iterator i = mIndexDataList.begin(); i != mIndexDataList.end(); ++i)
+		if (MeshUtils::getIndexType(job.targetVertexData->vertexCount) !=
+			HardwareIndexBuffer::IT_16BIT)
 		{
-			IndexData* idata = *i;
-			remapIndexes(idata);
+			return false;
+		}
+
+		size_t numBuffers = 0;
+		size_t bytesSaved = 0;
+		for (SubMeshList::iterator i = job.subMeshes.begin(); i != job.subMeshes.end(); ++i)
+		{
+			SubMesh* sm = *i;
+			std::vector<IndexData*> indexDatas(1, sm->indexData);
+			indexDatas.insert(indexDatas.end(), sm->mLodFaceList.begin(), sm->mLodFaceList.end());
+			for (size_t l = 0; l < indexDatas.size(); ++l)
+			{
+				IndexData* idata = indexDatas[l];
+				if (idata->indexBuffer->getType() != HardwareIndexBuffer::IT_32BIT)
+				{
+					continue;
+				}
 
+				std::lock_guard<std::mutex> lock(mBufferManagerMutex);
+				if (MeshUtils::changeIndexType(idata, HardwareIndexBuffer::IT_16BIT))
+				{
+					++numBuffers;
+					bytesSaved += idata->indexCount * (sizeof(uint32) - sizeof(uint16));
+				}
+			}
 		}
 
+		if (numBuffers > 0)
+		{
+			job.print("    " + StringConverter::toString(numBuffers) +
+				" index buffers converted to 16 bit, " +
+				StringConverter::toString(bytesSaved) + " bytes saved.");
+		}
+		return numBuffers > 0;
 	}
 	//---------------------------------------------------------------------
-	void OptimiseTool::remapIndexes(IndexData* idata)
+	void OptimiseTool::remapIndexes(const GeometryJob& job, IndexData* idata)
 	{
 		// Time to repoint indexes at the new shared vertices
 		uint16* p16 = 0;
@@ -592,8 +1311,8 @@ namespace meshmagick
 		for (size_t j = 0; j < idata->indexCount; ++j)
 		{
 			uint32 oldIndex = p32? *p32 : *p16;
-			uint32 newIndex = static_cast<uint32>(mIndexRemap[oldIndex].targetIndex);
-			assert(newIndex < mUniqueVertexMap.size());
+			uint32 newIndex = static_cast<uint32>(job.indexRemap[oldIndex].targetIndex);
+			assert(newIndex < job.uniqueVertexList.size());
 			if (newIndex != oldIndex)
 			{
 				if (p32)
@@ -626,10 +1345,10 @@ namespace meshmagick
 		// no built-in position equals
 		for (int i = 0; i < 4; ++i)
 		{
-			if (Math::RealEqual(a[i], b[i], tolerance))
-				return true;
+			if (!Math::RealEqual(a[i], b[i], tolerance))
+				return false;
 		}
-		return false;
+		return true;
 	}
 	//---------------------------------------------------------------------
 	bool OptimiseTool::UniqueVertexLess::less(
@@ -678,9 +1397,25 @@ namespace meshmagick
 		{
 			return less(a.binormal, b.binormal, norm_tolerance);
 		}
+		else if (!equals(a.diffuse, b.diffuse, COLOUR_TOLERANCE))
+		{
+			return less(a.diffuse, b.diffuse, COLOUR_TOLERANCE);
+		}
+		else if (!equals(a.specular, b.specular, COLOUR_TOLERANCE))
+		{
+			return less(a.specular, b.specular, COLOUR_TOLERANCE);
+		}
+		else if (!equals(a.blendIndices, b.blendIndices, 0))
+		{
+			return less(a.blendIndices, b.blendIndices, 0);
+		}
+		else if (!equals(a.blendWeights, b.blendWeights, COLOUR_TOLERANCE))
+		{
+			return less(a.blendWeights, b.blendWeights, COLOUR_TOLERANCE);
+		}
 		else
 		{
-			// position, normal, tangent and binormal are all the same, try UVs
+			// all other components are the same, try UVs
 			for (unsigned short i = 0; i < uvSets; ++i)
 			{
 				if (!equals(a.uv[i], b.uv[i], uv_tolerance))
@@ -694,4 +1429,156 @@ namespace meshmagick
 		}
 
 	}
+	//---------------------------------------------------------------------
+	OptimiseTool::UniqueVertexGrid::UniqueVertexGrid()
+		: mPosTolerance(0), mNormTolerance(0), mUVTolerance(0), mUVSets(0),
+		  mInvCellSize(1.0), mCells(), mCellMask(0), mVertices(), mNext()
+	{
+	}
+	//---------------------------------------------------------------------
+	void OptimiseTool::UniqueVertexGrid::reset(float posTolerance, float normTolerance,
+		float uvTolerance, unsigned short uvSets, size_t vertexCount)
+	{
+		mPosTolerance = posTolerance;
+		mNormTolerance = normTolerance;
+		mUVTolerance = uvTolerance;
+		mUVSets = uvSets;
+		// Cells must not be smaller than the tolerance, else equal vertices could be more
+		// than one cell apart. With zero tolerance any cell size works.
+		mInvCellSize = 1.0 / (posTolerance > 0 ? posTolerance : 1e-06);
+
+		// There can't be more occupied cells than vertices, so a table twice that size
+		// keeps the load factor at or below 0.5 without ever having to grow.
+		size_t numCells = 16;
+		while (numCells < vertexCount * 2)
+		{
+			numCells <<= 1;
+		}
+		Cell emptyCell;
+		emptyCell.key.x = emptyCell.key.y = emptyCell.key.z = 0;
+		emptyCell.head = emptyCell.tail = NO_VERTEX;
+		mCells.assign(numCells, emptyCell);
+		mCellMask = numCells - 1;
+
+		mVertices.clear();
+		mVertices.reserve(vertexCount);
+		mNext.clear();
+		mNext.reserve(vertexCount);
+	}
+	//---------------------------------------------------------------------
+	OptimiseTool::UniqueVertexGrid::CellKey OptimiseTool::UniqueVertexGrid::getCellKey(
+		const Vector3& pos) const
+	{
+		CellKey key;
+		key.x = static_cast<int64>(std::floor(pos.x * mInvCellSize));
+		key.y = static_cast<int64>(std::floor(pos.y * mInvCellSize));
+		key.z = static_cast<int64>(std::floor(pos.z * mInvCellSize));
+		return key;
+	}
+	//---------------------------------------------------------------------
+	size_t OptimiseTool::UniqueVertexGrid::findCell(const CellKey& key) const
+	{
+		// 64 bit mix of the three coordinates, linear probing from there.
+		uint64 h = static_cast<uint64>(key.x) * 0x9E3779B97F4A7C15ULL;
+		h ^= static_cast<uint64>(key.y) * 0xC2B2AE3D27D4EB4FULL;
+		h ^= static_cast<uint64>(key.z) * 0x165667B19E3779F9ULL;
+		h ^= h >> 29;
+		size_t slot = static_cast<size_t>(h) & mCellMask;
+		while (mCells[slot].head != NO_VERTEX && !(mCells[slot].key == key))
+		{
+			slot = (slot + 1) & mCellMask;
+		}
+		return slot;
+	}
+	//---------------------------------------------------------------------
+	bool OptimiseTool::UniqueVertexGrid::find(const UniqueVertex& v, uint32& newIndex) const
+	{
+		const CellKey centre = getCellKey(v.position);
+		uint32 best = NO_VERTEX;
+		for (int64 dx = -1; dx <= 1; ++dx)
+		{
+			for (int64 dy = -1; dy <= 1; ++dy)
+			{
+				for (int64 dz = -1; dz <= 1; ++dz)
+				{
+					CellKey key = {centre.x + dx, centre.y + dy, centre.z + dz};
+					const Cell& cell = mCells[findCell(key)];
+					// Chains are in ascending index order, so the first match in a cell
+					// is the oldest one there.
+					for (uint32 i = cell.head; i != NO_VERTEX && i < best; i = mNext[i])
+					{
+						if (equals(mVertices[i], v))
+						{
+							best = i;
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		if (best != NO_VERTEX)
+		{
+			newIndex = best;
+			return true;
+		}
+		return false;
+	}
+	//---------------------------------------------------------------------
+	void OptimiseTool::UniqueVertexGrid::insert(const UniqueVertex& v, uint32 newIndex)
+	{
+		assert(newIndex == mVertices.size());
+		mVertices.push_back(v);
+		mNext.push_back(NO_VERTEX);
+
+		const CellKey key = getCellKey(v.position);
+		Cell& cell = mCells[findCell(key)];
+		if (cell.head == NO_VERTEX)
+		{
+			cell.key = key;
+			cell.head = newIndex;
+		}
+		else
+		{
+			mNext[cell.tail] = newIndex;
+		}
+		cell.tail = newIndex;
+	}
+	//---------------------------------------------------------------------
+	bool OptimiseTool::UniqueVertexGrid::equals(
+		const UniqueVertex& a, const UniqueVertex& b) const
+	{
+		// Unlike UniqueVertexLess all components have to be within tolerance.
+		if (!a.position.positionEquals(b.position, mPosTolerance) ||
+			!a.normal.positionEquals(b.normal, mNormTolerance) ||
+			!a.binormal.positionEquals(b.binormal, mNormTolerance))
+		{
+			return false;
+		}
+		if (!equals(a.tangent, b.tangent, mNormTolerance) ||
+			!equals(a.diffuse, b.diffuse, COLOUR_TOLERANCE) ||
+			!equals(a.specular, b.specular, COLOUR_TOLERANCE) ||
+			!equals(a.blendIndices, b.blendIndices, 0) ||
+			!equals(a.blendWeights, b.blendWeights, COLOUR_TOLERANCE))
+		{
+			return false;
+		}
+		for (unsigned short i = 0; i < mUVSets; ++i)
+		{
+			if (!equals(a.uv[i], b.uv[i], mUVTolerance))
+				return false;
+		}
+		return true;
+	}
+	//---------------------------------------------------------------------
+	bool OptimiseTool::UniqueVertexGrid::equals(
+		const Vector4& a, const Vector4& b, Real tolerance)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			if (!Math::RealEqual(a[i], b[i], tolerance))
+				return false;
+		}
+		return true;
+	}
 }
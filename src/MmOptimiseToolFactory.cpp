@@ -46,6 +46,17 @@ namespace meshmagick
 		optionDefs.insert(OptionDefinition("norm_tolerance", OT_REAL, false, false, Ogre::Any(1e-06)));
 		optionDefs.insert(OptionDefinition("uv_tolerance", OT_REAL, false, false, Ogre::Any(1e-06)));
 		optionDefs.insert(OptionDefinition("keep-identity-tracks", OT_BOOL, false, false));
+		optionDefs.insert(OptionDefinition("no-edge-lists", OT_BOOL, false, false));
+		optionDefs.insert(OptionDefinition("reduce-keys", OT_BOOL, false, false));
+		optionDefs.insert(OptionDefinition("key_rotation_error", OT_REAL, false, false, Ogre::Any(Ogre::Real(0.1))));
+		optionDefs.insert(OptionDefinition("key_translation_error", OT_REAL, false, false, Ogre::Any(Ogre::Real(0.001))));
+		optionDefs.insert(OptionDefinition("key_scale_error", OT_REAL, false, false, Ogre::Any(Ogre::Real(0.001))));
+		optionDefs.insert(OptionDefinition("weld-index", OT_SELECTION, false, false,
+			Ogre::Any(Ogre::String("hash")), ";hash;map"));
+		optionDefs.insert(OptionDefinition("threads", OT_INT, false, false, Ogre::Any(0)));
+		optionDefs.insert(OptionDefinition("vcache", OT_BOOL, false, false));
+		optionDefs.insert(OptionDefinition("vfetch", OT_BOOL, false, false));
+		optionDefs.insert(OptionDefinition("keep-index-width", OT_BOOL, false, false));
 
 		return optionDefs;
 	}
@@ -53,7 +64,9 @@ namespace meshmagick
 	void OptimiseToolFactory::printToolHelp(std::ostream& out) const
 	{
 		out << std::endl;
-		out << "Allows you to optimise meshes and skeletons" << std::endl << std::endl;
+		out << "Allows you to optimise meshes and skeletons" << std::endl;
+		out << "Duplicate and unreferenced vertices and degenerate triangles are removed."
+			<< std::endl << std::endl;
 		out << "Options:" << std::endl;
 		out << "   -tolerance=val - Tolerance value for treating vertices as equal (all components)"
 			<< std::endl;
@@ -63,8 +76,56 @@ namespace meshmagick
 			<< std::endl;
 		out << "   -uv_tolerance=val - Tolerance value for treating uvs as equal"
 			<< std::endl;
+		out << "       Colours and blend weights are equal within half an 8 bit step,"
+			<< std::endl;
+		out << "       blend indices have to match exactly."
+			<< std::endl;
 		out << "   -keep-identity-tracks - When optimising skeletons, keep tracks which do nothing"
 			<< std::endl;
+		out << "   -reduce-keys - When optimising skeletons, remove keyframes which can be"
+			<< std::endl;
+		out << "       interpolated from their neighbours within the following tolerances."
+			<< std::endl;
+		out << "       Only done for animations with linear interpolation."
+			<< std::endl;
+		out << "   -key_rotation_error=degrees - Maximum rotation error (default 0.1)"
+			<< std::endl;
+		out << "   -key_translation_error=val - Maximum translation error, relative to the"
+			<< std::endl;
+		out << "       length of the bone chain animated by the track (default 0.001)"
+			<< std::endl;
+		out << "   -key_scale_error=val - Maximum scale error (default 0.001)"
+			<< std::endl;
+		out << "       Giving any of these tolerances implies -reduce-keys."
+			<< std::endl;
+		out << "   -weld-index=hash|map - Lookup structure used to find duplicate vertices."
+			<< std::endl;
+		out << "       hash (default) is a spatial hash grid, map is the old ordered map."
+			<< std::endl;
+		out << "       Use with -verbose to compare the time spent on the duplicate search."
+			<< std::endl;
+		out << "   -no-edge-lists - Remove edge lists, for meshes never casting stencil shadows."
+			<< std::endl;
+		out << "   -threads=n - Number of threads used to optimise the vertex data of a mesh."
+			<< std::endl;
+		out << "       Shared and dedicated submesh vertex data are optimised, and edge lists"
+			<< std::endl;
+		out << "       built, concurrently."
+			<< std::endl;
+		out << "       Defaults to the number of hardware threads, 1 disables threading."
+			<< std::endl;
+		out << "   -vcache - Reorder triangles for better use of the post-transform vertex cache"
+			<< std::endl;
+		out << "       Reports the average cache miss ratio (ACMR) before and after."
+			<< std::endl;
+		out << "   -vfetch - Renumber vertices in the order the faces first use them"
+			<< std::endl;
+		out << "       Improves memory locality of vertex fetches. Applied after -vcache."
+			<< std::endl;
+		out << "   -keep-index-width - Don't convert 32 bit index buffers to 16 bit"
+			<< std::endl;
+		out << "       By default this is done for all vertex data with less than 65536 vertices."
+			<< std::endl;
 
 	}
 
@@ -77,4 +138,9 @@ namespace meshmagick
 	{
 		return "Optimise meshes and skeletons.";
 	}
+
+	bool OptimiseToolFactory::processesFilesIndependently(const OptionList& globalOptions) const
+	{
+		return OptionsUtil::isOptionSet(globalOptions, "no-follow-skeleton");
+	}
 }
@@ -0,0 +1,207 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmPipelineTool.h"
+
+#include <OgreStringConverter.h>
+
+#include <stdexcept>
+
+#include "MmOgreEnvironment.h"
+#include "MmStatefulMeshSerializer.h"
+#include "MmToolManager.h"
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    PipelineTool::PipelineTool(ToolManager& toolManager)
+        : Tool(),
+          mToolManager(toolManager)
+    {
+    }
+
+    Ogre::String PipelineTool::getName() const
+    {
+        return "pipeline";
+    }
+
+    void PipelineTool::doInvoke(const OptionList& toolOptions,
+        const StringVector& inFileNames, const StringVector& outFileNamesArg)
+    {
+        // The first argument is the stage description, the remaining ones are the meshes.
+        if (inFileNames.size() < 2)
+        {
+            fail("pipeline needs the stages followed by at least one input file.");
+        }
+        StringVector meshFileNames(inFileNames.begin() + 1, inFileNames.end());
+
+        // Name count has to match, else we have no way to figure out how to apply output
+        // names to input files.
+        if (!(outFileNamesArg.empty() || meshFileNames.size() == outFileNamesArg.size()))
+        {
+            fail("number of output files must match number of input files.");
+        }
+
+        StringVector outFileNames = outFileNamesArg.empty() ? meshFileNames : outFileNamesArg;
+
+        StageList stages;
+        try
+        {
+            createStages(inFileNames[0], stages);
+
+            for (size_t i = 0; i < stages.size(); ++i)
+            {
+                stages[i].tool->beginLoadedMeshes(mGlobalOptions, stages[i].options);
+                // Files written next to the mesh describe it as it is at that stage, later
+                // stages would change the mesh without updating them.
+                if (i + 1 < stages.size() && stages[i].tool->writesSidecarFiles())
+                {
+                    fail("stage " + stages[i].name + " writes files describing the mesh, "
+                        "it has to be the last stage.");
+                }
+            }
+
+            for (size_t i = 0, end = meshFileNames.size(); i < end; ++i)
+            {
+                if (StringUtil::endsWith(meshFileNames[i], ".mesh", true))
+                {
+                    processMeshFile(stages, meshFileNames[i], outFileNames[i]);
+                }
+                else
+                {
+                    warn("unrecognised name ending for file " + meshFileNames[i]);
+                    warn("file skipped.");
+                }
+
+                releaseFileResources();
+            }
+
+            for (size_t i = 0; i < stages.size(); ++i)
+            {
+                stages[i].tool->endLoadedMeshes();
+            }
+        }
+        catch (...)
+        {
+            destroyStages(stages);
+            throw;
+        }
+        destroyStages(stages);
+    }
+
+    void PipelineTool::processMeshFile(const StageList& stages, const String& inFile,
+        const String& outFile)
+    {
+        StatefulMeshSerializer* meshSerializer =
+            OgreEnvironment::getSingleton().getMeshSerializer();
+
+        print("Loading mesh " + inFile + "...");
+        MeshPtr mesh;
+        try
+        {
+            mesh = meshSerializer->loadMesh(inFile);
+        }
+        catch(std::exception& e)
+        {
+            warn(e.what());
+            warn("Unable to open mesh file " + inFile);
+            warn("file skipped.");
+            return;
+        }
+
+        bool modified = false;
+        for (size_t i = 0; i < stages.size(); ++i)
+        {
+            print("Running " + stages[i].name + "...");
+            if (stages[i].tool->processLoadedMesh(mesh, inFile, outFile))
+            {
+                modified = true;
+            }
+        }
+
+        if (modified || outFile != inFile)
+        {
+            meshSerializer->saveMesh(outFile, true);
+            print("Mesh saved as " + outFile + ".");
+        }
+        else
+        {
+            print("Mesh unchanged, not saved.", V_HIGH);
+        }
+    }
+
+    void PipelineTool::createStages(const String& description, StageList& stages)
+    {
+        StringVector stageDescriptions = StringUtil::split(description, "|");
+        for (size_t i = 0; i < stageDescriptions.size(); ++i)
+        {
+            StringVector args = StringUtil::split(stageDescriptions[i], " \t\r\n");
+            if (args.empty())
+            {
+                fail("empty stage in pipeline \"" + description + "\".");
+            }
+
+            Stage stage;
+            stage.name = args[0];
+            stage.tool = NULL;
+            if (stage.name == getName())
+            {
+                fail("pipelines can't be nested.");
+            }
+
+            std::vector<const char*> argv;
+            for (size_t j = 1; j < args.size(); ++j)
+            {
+                if (args[j].empty() || args[j][0] != '-')
+                {
+                    fail("stage " + stage.name + " takes options only, got " + args[j] + ".");
+                }
+                argv.push_back(args[j].c_str());
+            }
+
+            Tool* tool = mToolManager.createTool(stage.name);
+            if (tool == NULL)
+            {
+                fail("no such tool: " + stage.name);
+            }
+            if (!tool->supportsLoadedMeshes())
+            {
+                mToolManager.destroyTool(tool);
+                fail(stage.name + " can't be a pipeline stage.");
+            }
+            stage.tool = tool;
+            stages.push_back(stage);
+
+            stages.back().options = mToolManager.parseToolOptions(stage.name,
+                static_cast<int>(argv.size()), argv.empty() ? NULL : &argv[0]);
+        }
+
+        print("Pipeline of " + StringConverter::toString(stages.size()) + " stages.", V_HIGH);
+    }
+
+    void PipelineTool::destroyStages(StageList& stages)
+    {
+        for (size_t i = 0; i < stages.size(); ++i)
+        {
+            mToolManager.destroyTool(stages[i].tool);
+        }
+        stages.clear();
+    }
+}
@@ -0,0 +1,99 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmPipelineToolFactory.h"
+#include "MmPipelineTool.h"
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    //------------------------------------------------------------------------
+    PipelineToolFactory::PipelineToolFactory(ToolManager& toolManager)
+        : mToolManager(toolManager)
+    {
+    }
+    //------------------------------------------------------------------------
+
+    Tool* PipelineToolFactory::createTool()
+    {
+        Tool* tool = new PipelineTool(mToolManager);
+        return tool;
+    }
+    //------------------------------------------------------------------------
+
+    void PipelineToolFactory::destroyTool(Tool* tool)
+    {
+        delete tool;
+    }
+    //------------------------------------------------------------------------
+
+    OptionDefinitionSet PipelineToolFactory::getOptionDefinitions() const
+    {
+        return OptionDefinitionSet();
+    }
+    //------------------------------------------------------------------------
+
+    void PipelineToolFactory::printToolHelp(std::ostream& out) const
+    {
+        out << std::endl;
+        out << "Runs several tools on each mesh, loading and saving it only once" << std::endl
+            << std::endl;
+        out << "Usage: MeshMagick pipeline \"stage | stage ...\" infile(s) -- [outfile(s)]"
+            << std::endl << std::endl;
+        out << "Each stage is a tool name followed by its options, e.g." << std::endl;
+        out << "    \"transform -scale=2/2/2 | optimise -vcache | rename -material=/a/b/ | info\""
+            << std::endl;
+        out << "Option values can't contain spaces or '|'." << std::endl;
+        out << "Stages: compress, info, lod, meshlet, optimise, rename, reorganise, transform."
+            << std::endl;
+        out << "meshlet and compress -positions=short4 write files next to the mesh and have"
+            << std::endl;
+        out << "to be the last stage." << std::endl;
+        out << "Meshes no stage modified are not saved. Skeletons linked by the meshes are"
+            << std::endl;
+        out << "processed by each stage after all meshes are done." << std::endl
+            << std::endl;
+    }
+    //------------------------------------------------------------------------
+
+    Ogre::String PipelineToolFactory::getToolName() const
+    {
+        return "pipeline";
+    }
+    //------------------------------------------------------------------------
+
+    Ogre::String PipelineToolFactory::getToolDescription() const
+    {
+        return "Run several tools on a mesh without saving in between.";
+    }
+    //------------------------------------------------------------------------
+
+    bool PipelineToolFactory::processesFilesIndependently(const OptionList&) const
+    {
+        return false;
+    }
+    //------------------------------------------------------------------------
+
+    bool PipelineToolFactory::isCacheable() const
+    {
+        return false;
+    }
+    //------------------------------------------------------------------------
+}
@@ -0,0 +1,218 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmProcessPool.h"
+#include "MmThreadPool.h"
+
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+
+#if OGRE_PLATFORM != OGRE_PLATFORM_WIN32
+#   include <errno.h>
+#   include <sys/types.h>
+#   include <sys/wait.h>
+#   include <unistd.h>
+#endif
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    namespace
+    {
+        /// Output of one command. It is kept in temporary files while the command runs
+        /// and in memory once it is done, so that only running commands hold files open.
+        struct CommandOutput
+        {
+            std::FILE* outFile;
+            std::FILE* errFile;
+            String out;
+            String err;
+            bool done;
+            bool failed;
+
+            CommandOutput() : outFile(NULL), errFile(NULL), out(), err(),
+                done(false), failed(false) {}
+        };
+
+        String readAndClose(std::FILE*& file)
+        {
+            String contents;
+            if (file != NULL)
+            {
+                std::rewind(file);
+                char buffer[4096];
+                size_t size;
+                while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+                {
+                    contents.append(buffer, size);
+                }
+                std::fclose(file);
+                file = NULL;
+            }
+            return contents;
+        }
+    }
+
+    ProcessPool::ProcessPool(size_t numProcesses)
+        : mNumProcesses(numProcesses > 0 ? numProcesses : ThreadPool::getHardwareThreadCount())
+    {
+    }
+
+    size_t ProcessPool::getNumProcesses() const
+    {
+        return mNumProcesses;
+    }
+
+    void ProcessPool::addCommand(const StringVector& arguments)
+    {
+        if (arguments.empty())
+        {
+            throw std::invalid_argument("command without program");
+        }
+        mCommands.push_back(arguments);
+    }
+
+    bool ProcessPool::isSupported()
+    {
+#if OGRE_PLATFORM != OGRE_PLATFORM_WIN32
+        return true;
+#else
+        return false;
+#endif
+    }
+
+#if OGRE_PLATFORM != OGRE_PLATFORM_WIN32
+    size_t ProcessPool::run(std::ostream& out, std::ostream& err)
+    {
+        std::vector<CommandOutput> outputs(mCommands.size());
+        std::map<pid_t, size_t> running;
+        size_t nextCommand = 0;
+        size_t nextOutput = 0;
+        size_t numFailed = 0;
+
+        // Children inherit the stdio buffers, they must be empty at fork time.
+        out.flush();
+        err.flush();
+        std::fflush(NULL);
+
+        while (nextOutput < mCommands.size())
+        {
+            // Start as many commands as allowed.
+            while (nextCommand < mCommands.size() && running.size() < mNumProcesses)
+            {
+                CommandOutput& output = outputs[nextCommand];
+                output.outFile = std::tmpfile();
+                output.errFile = std::tmpfile();
+
+                pid_t pid = -1;
+                if (output.outFile != NULL && output.errFile != NULL)
+                {
+                    const StringVector& command = mCommands[nextCommand];
+                    std::vector<char*> argv;
+                    for (size_t i = 0; i < command.size(); ++i)
+                    {
+                        argv.push_back(const_cast<char*>(command[i].c_str()));
+                    }
+                    argv.push_back(NULL);
+
+                    pid = fork();
+                    if (pid == 0)
+                    {
+                        // Child. Only async-signal-safe calls from here on.
+                        if (dup2(fileno(output.outFile), STDOUT_FILENO) != -1
+                            && dup2(fileno(output.errFile), STDERR_FILENO) != -1)
+                        {
+                            execvp(argv[0], &argv[0]);
+                        }
+                        const char msg[] = "unable to start child process\n";
+                        ssize_t written = write(STDERR_FILENO, msg, sizeof(msg) - 1);
+                        (void)written;
+                        _exit(127);
+                    }
+                }
+
+                if (pid > 0)
+                {
+                    running[pid] = nextCommand;
+                }
+                else
+                {
+                    readAndClose(output.outFile);
+                    readAndClose(output.errFile);
+                    output.err = "unable to start " + mCommands[nextCommand][0] + "\n";
+                    output.done = true;
+                    output.failed = true;
+                }
+                ++nextCommand;
+            }
+
+            // Wait for one of the children, unless the next output in line is ready.
+            if (!outputs[nextOutput].done)
+            {
+                int status = 0;
+                pid_t pid = waitpid(-1, &status, 0);
+                if (pid == -1)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw std::runtime_error("waiting for child processes failed");
+                }
+
+                std::map<pid_t, size_t>::iterator it = running.find(pid);
+                if (it != running.end())
+                {
+                    CommandOutput& output = outputs[it->second];
+                    output.out = readAndClose(output.outFile);
+                    output.err = readAndClose(output.errFile);
+                    output.done = true;
+                    output.failed = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+                    running.erase(it);
+                }
+            }
+
+            // Write everything that is finished, in order.
+            while (nextOutput < mCommands.size() && outputs[nextOutput].done)
+            {
+                CommandOutput& output = outputs[nextOutput];
+                out << output.out << std::flush;
+                err << output.err << std::flush;
+                output.out.clear();
+                output.err.clear();
+                if (output.failed)
+                {
+                    ++numFailed;
+                }
+                ++nextOutput;
+            }
+        }
+
+        mCommands.clear();
+        return numFailed;
+    }
+#else
+    size_t ProcessPool::run(std::ostream&, std::ostream&)
+    {
+        throw std::logic_error("child processes are not supported on this platform");
+    }
+#endif
+}
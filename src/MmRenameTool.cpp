@@ -93,6 +93,8 @@ namespace meshmagick
                 warn("unrecognised name ending for file " + inFileNames[i]);
                 warn("file skipped.");
             }
+
+            releaseFileResources();
         }
 	}
 
@@ -173,7 +175,30 @@ namespace meshmagick
             return;
         }
         print("Processing mesh...");
+		processMesh(toolOptions, mesh);
+		meshSerializer->saveMesh(outFile, true);
+        print("Mesh saved as " + outFile + ".");
+    }
+
+	bool RenameTool::supportsLoadedMeshes() const
+	{
+		return true;
+	}
+
+	void RenameTool::doBeginLoadedMeshes(const OptionList& toolOptions)
+	{
+		mToolOptions = toolOptions;
+	}
 
+	bool RenameTool::doProcessLoadedMesh(
+		Ogre::MeshPtr mesh, const Ogre::String&, const Ogre::String&)
+	{
+		processMesh(mToolOptions, mesh);
+		return true;
+	}
+
+	void RenameTool::processMesh(const OptionList &toolOptions, Ogre::MeshPtr mesh)
+	{
 		for (OptionList::const_iterator 
 			it = toolOptions.begin(); it != toolOptions.end(); ++it)
 		{
@@ -216,10 +241,7 @@ namespace meshmagick
                 pMesh->renameSubmesh(before, after);
             }
 		}
-		
-		meshSerializer->saveMesh(outFile, true);
-        print("Mesh saved as " + outFile + ".");
-    }
+	}
 
 	RenameTool::StringPair RenameTool::split(const Ogre::String& value) const
 	{
@@ -0,0 +1,373 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmReorganiseTool.h"
+
+#include <OgreHardwareBufferManager.h>
+#include <OgreStringConverter.h>
+#include <OgreSubMesh.h>
+
+#include <algorithm>
+#include <map>
+
+#include "MmOgreEnvironment.h"
+#include "MmStatefulMeshSerializer.h"
+
+using namespace Ogre;
+
+namespace
+{
+    /// Semantic of a layout letter, as printed by InfoTool.
+    bool getSemantic(char letter, VertexElementSemantic& semantic)
+    {
+        switch (letter)
+        {
+        case 'p': semantic = VES_POSITION; return true;
+        case 'w': semantic = VES_BLEND_WEIGHTS; return true;
+        case 'i': semantic = VES_BLEND_INDICES; return true;
+        case 'n': semantic = VES_NORMAL; return true;
+        case 'd': semantic = VES_DIFFUSE; return true;
+        case 's': semantic = VES_SPECULAR; return true;
+        case 'u': semantic = VES_TEXTURE_COORDINATES; return true;
+        case 'b': semantic = VES_BINORMAL; return true;
+        case 't': semantic = VES_TANGENT; return true;
+        default: return false;
+        }
+    }
+
+    /// Type code of an element type, as printed by InfoTool. Empty for types it doesn't print.
+    String getTypeCode(VertexElementType type)
+    {
+        switch (type)
+        {
+        case VET_FLOAT1: return "f1";
+        case VET_FLOAT2: return "f2";
+        case VET_FLOAT3: return "f3";
+        case VET_FLOAT4: return "f4";
+        case VET_SHORT1: return "s1";
+        case VET_SHORT2: return "s2";
+        case VET_SHORT3: return "s3";
+        case VET_SHORT4: return "s4";
+        case VET_UBYTE4: return "u4";
+        case VET_COLOUR_ARGB: return "dx";
+        case VET_COLOUR_ABGR: return "gl";
+        default: return "";
+        }
+    }
+
+    bool isBeforeInBuffer(const VertexElement* a, const VertexElement* b)
+    {
+        return a->getSource() != b->getSource() ?
+            a->getSource() < b->getSource() : a->getOffset() < b->getOffset();
+    }
+}
+
+namespace meshmagick
+{
+    ReorganiseTool::ReorganiseTool()
+        : mLayout()
+    {
+    }
+
+    Ogre::String ReorganiseTool::getName() const
+    {
+        return "reorganise";
+    }
+
+    void ReorganiseTool::setOptions(const OptionList& toolOptions)
+    {
+        const String layout = OptionsUtil::getStringOption(toolOptions, "layout");
+        if (layout.empty())
+        {
+            fail("no layout given, use -layout=<layout>.");
+        }
+        setLayout(layout);
+    }
+
+    void ReorganiseTool::doInvoke(const OptionList& toolOptions,
+        const StringVector& inFileNames, const StringVector& outFileNamesArg)
+    {
+        // Name count has to match, else we have no way to figure out how to apply output
+        // names to input files.
+        if (!(outFileNamesArg.empty() || inFileNames.size() == outFileNamesArg.size()))
+        {
+            fail("number of output files must match number of input files.");
+        }
+
+        setOptions(toolOptions);
+
+        StringVector outFileNames = outFileNamesArg.empty() ? inFileNames : outFileNamesArg;
+
+        for (size_t i = 0, end = inFileNames.size(); i < end; ++i)
+        {
+            if (StringUtil::endsWith(inFileNames[i], ".mesh", true))
+            {
+                processMeshFile(inFileNames[i], outFileNames[i]);
+            }
+            else
+            {
+                warn("unrecognised name ending for file " + inFileNames[i]);
+                warn("file skipped.");
+            }
+
+            releaseFileResources();
+        }
+    }
+
+    void ReorganiseTool::setLayout(const Ogre::String& layout)
+    {
+        mLayout.assign(1, BufferLayout());
+
+        // Counts occurrences of each semantic, the n-th one refers to index n.
+        std::map<VertexElementSemantic, unsigned short> semanticCounts;
+        for (size_t i = 0; i < layout.size(); ++i)
+        {
+            const char c = layout[i];
+            if (c == '-')
+            {
+                mLayout.push_back(BufferLayout());
+            }
+            else if (c == '(')
+            {
+                const size_t close = layout.find(')', i);
+                if (close == String::npos || mLayout.back().empty() || mLayout.back().back().isRest)
+                {
+                    fail("malformed layout " + layout + ", type without element at " +
+                        StringConverter::toString(i) + ".");
+                }
+                mLayout.back().back().type = layout.substr(i + 1, close - i - 1);
+                i = close;
+            }
+            else
+            {
+                LayoutElement elem;
+                elem.semantic = VES_POSITION;
+                elem.index = 0;
+                elem.isRest = c == '*';
+                if (!elem.isRest)
+                {
+                    if (!getSemantic(c, elem.semantic))
+                    {
+                        fail("unknown element '" + String(1, c) + "' in layout " + layout + ".");
+                    }
+                    elem.index = semanticCounts[elem.semantic]++;
+                }
+                mLayout.back().push_back(elem);
+            }
+        }
+    }
+
+    void ReorganiseTool::processMeshFile(Ogre::String inFile, Ogre::String outFile)
+    {
+        StatefulMeshSerializer* meshSerializer =
+            OgreEnvironment::getSingleton().getMeshSerializer();
+
+        print("Loading mesh " + inFile + "...");
+        MeshPtr mesh;
+        try
+        {
+            mesh = meshSerializer->loadMesh(inFile);
+        }
+        catch(std::exception& e)
+        {
+            warn(e.what());
+            warn("Unable to open mesh file " + inFile);
+            warn("file skipped.");
+            return;
+        }
+        print("Reorganising mesh...");
+        doProcessLoadedMesh(mesh, inFile, outFile);
+        meshSerializer->saveMesh(outFile, true);
+        print("Mesh saved as " + outFile + ".");
+    }
+
+    bool ReorganiseTool::supportsLoadedMeshes() const
+    {
+        return true;
+    }
+
+    void ReorganiseTool::doBeginLoadedMeshes(const OptionList& toolOptions)
+    {
+        setOptions(toolOptions);
+    }
+
+    bool ReorganiseTool::doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String&,
+        const Ogre::String&)
+    {
+        const size_t changed = reorganise(mesh);
+        print(StringConverter::toString(changed) + " vertex data reorganised.");
+        return changed > 0;
+    }
+
+    size_t ReorganiseTool::reorganise(MeshPtr mesh)
+    {
+        mesh->_determineAnimationTypes();
+
+        size_t changed = 0;
+        if (mesh->sharedVertexData != NULL)
+        {
+            print("Reorganising shared vertex data...", V_HIGH);
+            if (processVertexData(mesh->sharedVertexData,
+                mesh->getSharedVertexDataAnimationType(),
+                mesh->getSharedVertexDataAnimationIncludesNormals()))
+            {
+                ++changed;
+            }
+        }
+        for (unsigned short i = 0; i < mesh->getNumSubMeshes(); ++i)
+        {
+            SubMesh* submesh = mesh->getSubMesh(i);
+            if (!submesh->useSharedVertices && submesh->vertexData != NULL)
+            {
+                print("Reorganising submesh " + StringConverter::toString(i) +
+                    " vertex data...", V_HIGH);
+                if (processVertexData(submesh->vertexData, submesh->getVertexAnimationType(),
+                    submesh->getVertexAnimationIncludesNormals()))
+                {
+                    ++changed;
+                }
+            }
+        }
+        return changed;
+    }
+
+    bool ReorganiseTool::processVertexData(VertexData* vertexData,
+        VertexAnimationType animationType, bool animationIncludesNormals)
+    {
+        const VertexDeclaration* oldDecl = vertexData->vertexDeclaration;
+
+        // Existing elements in buffer order, which is kept for unlisted elements.
+        std::vector<const VertexElement*> unlisted;
+        const VertexDeclaration::VertexElementList& oldElems = oldDecl->getElements();
+        for (VertexDeclaration::VertexElementList::const_iterator it = oldElems.begin();
+            it != oldElems.end(); ++it)
+        {
+            unlisted.push_back(&*it);
+        }
+        std::stable_sort(unlisted.begin(), unlisted.end(), isBeforeInBuffer);
+
+        std::vector<std::vector<const VertexElement*> > buffers(mLayout.size());
+        size_t restBuffer = mLayout.size() - 1;
+        size_t restPosition = String::npos;
+        for (size_t b = 0; b < mLayout.size(); ++b)
+        {
+            for (size_t e = 0; e < mLayout[b].size(); ++e)
+            {
+                const LayoutElement& layoutElem = mLayout[b][e];
+                if (layoutElem.isRest)
+                {
+                    restBuffer = b;
+                    restPosition = buffers[b].size();
+                    continue;
+                }
+
+                // Elements the vertex data doesn't have are skipped.
+                const VertexElement* elem =
+                    oldDecl->findElementBySemantic(layoutElem.semantic, layoutElem.index);
+                if (elem == NULL)
+                {
+                    continue;
+                }
+                if (!layoutElem.type.empty() && layoutElem.type != getTypeCode(elem->getType()))
+                {
+                    warn("element type (" + layoutElem.type + ") ignored, types are not converted.");
+                }
+                buffers[b].push_back(elem);
+                unlisted.erase(std::find(unlisted.begin(), unlisted.end(), elem));
+            }
+        }
+        if (restPosition == String::npos)
+        {
+            restPosition = buffers[restBuffer].size();
+        }
+        buffers[restBuffer].insert(buffers[restBuffer].begin() + restPosition,
+            unlisted.begin(), unlisted.end());
+
+        // Vertex animation replaces the position buffer, and the normals if they are animated
+        // as well, so they have to be alone in their buffer.
+        if (animationType != VAT_NONE)
+        {
+            for (size_t b = 0; b < buffers.size(); ++b)
+            {
+                const std::vector<const VertexElement*>& elems = buffers[b];
+                bool hasPosition = false;
+                bool hasOthers = false;
+                for (size_t e = 0; e < elems.size(); ++e)
+                {
+                    const VertexElementSemantic semantic = elems[e]->getSemantic();
+                    if (semantic == VES_POSITION)
+                    {
+                        hasPosition = true;
+                    }
+                    else if (!(semantic == VES_NORMAL && animationIncludesNormals))
+                    {
+                        hasOthers = true;
+                    }
+                }
+                if (hasPosition && hasOthers)
+                {
+                    warn("vertex animated data needs positions in a buffer of their own, "
+                        "layout not applied.");
+                    return false;
+                }
+            }
+        }
+
+        // Build the new declaration, dropping buffers without elements.
+        VertexDeclaration* newDecl = HardwareBufferManager::getSingleton().createVertexDeclaration();
+        bool isUnchanged = true;
+        unsigned short source = 0;
+        for (size_t b = 0; b < buffers.size(); ++b)
+        {
+            if (buffers[b].empty())
+            {
+                continue;
+            }
+
+            size_t offset = 0;
+            for (size_t e = 0; e < buffers[b].size(); ++e)
+            {
+                const VertexElement* elem = buffers[b][e];
+                newDecl->addElement(source, offset, elem->getType(), elem->getSemantic(),
+                    elem->getIndex());
+                isUnchanged = isUnchanged &&
+                    elem->getSource() == source && elem->getOffset() == offset;
+                offset += elem->getSize();
+            }
+            // Padded buffers are repacked as well.
+            isUnchanged = isUnchanged &&
+                vertexData->vertexBufferBinding->isBufferBound(source) &&
+                vertexData->vertexBufferBinding->getBuffer(source)->getVertexSize() == offset;
+            ++source;
+        }
+        isUnchanged = isUnchanged && source == vertexData->vertexBufferBinding->getBufferCount();
+
+        if (isUnchanged)
+        {
+            HardwareBufferManager::getSingleton().destroyVertexDeclaration(newDecl);
+            print("layout already in place.", V_HIGH);
+            return false;
+        }
+
+        // Copies the elements into new buffers and takes ownership of newDecl.
+        vertexData->reorganiseBuffers(newDecl);
+        print("reorganised into " + StringConverter::toString(source) + " buffers.", V_HIGH);
+        return true;
+    }
+}
@@ -0,0 +1,82 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmReorganiseToolFactory.h"
+#include "MmReorganiseTool.h"
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    //------------------------------------------------------------------------
+    Tool* ReorganiseToolFactory::createTool()
+    {
+        Tool* tool = new ReorganiseTool();
+        return tool;
+    }
+    //------------------------------------------------------------------------
+
+    void ReorganiseToolFactory::destroyTool(Tool* tool)
+    {
+        delete tool;
+    }
+    //------------------------------------------------------------------------
+
+    OptionDefinitionSet ReorganiseToolFactory::getOptionDefinitions() const
+    {
+        OptionDefinitionSet optionDefs;
+        optionDefs.insert(OptionDefinition("layout", OT_STRING));
+        return optionDefs;
+    }
+    //------------------------------------------------------------------------
+
+    void ReorganiseToolFactory::printToolHelp(std::ostream& out) const
+    {
+        out << std::endl;
+        out << "Rearranges vertex elements into vertex buffers" << std::endl
+            << std::endl;
+        out << "options:" << std::endl;
+        out << "   -layout=<layout> - the buffer layout, in the syntax printed by info" << std::endl;
+        out << "       p position, n normal, u texture coordinates, d diffuse, s specular,"
+            << std::endl;
+        out << "       w blend weights, i blend indices, t tangent, b binormal." << std::endl;
+        out << "       '-' starts a new buffer, '*' stands for all elements not listed." << std::endl;
+        out << "       Repeated letters refer to the next index, \"uu\" to two texture" << std::endl;
+        out << "       coordinate sets. Elements the mesh lacks are ignored, unlisted" << std::endl;
+        out << "       elements go to the last buffer if there is no '*'." << std::endl;
+        out << "       Types in parentheses, like p(f3), are allowed but not converted." << std::endl;
+        out << "       Example: -layout=p-* puts positions into a buffer of their own."
+            << std::endl;
+        out << "Vertex animated data needs positions in a buffer of their own." << std::endl
+            << std::endl;
+    }
+    //------------------------------------------------------------------------
+
+    Ogre::String ReorganiseToolFactory::getToolName() const
+    {
+        return "reorganise";
+    }
+    //------------------------------------------------------------------------
+
+    Ogre::String ReorganiseToolFactory::getToolDescription() const
+    {
+        return "Reorganise the vertex buffer layout.";
+    }
+    //------------------------------------------------------------------------
+}
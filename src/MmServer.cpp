@@ -0,0 +1,658 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmServer.h"
+
+#include "MmOgreEnvironment.h"
+#include "MmToolManager.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if OGRE_PLATFORM != OGRE_PLATFORM_WIN32
+#   include <errno.h>
+#   include <signal.h>
+#   include <sys/socket.h>
+#   include <sys/stat.h>
+#   include <sys/un.h>
+#   include <unistd.h>
+#endif
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    namespace
+    {
+        /// Just enough JSON for the requests: a value with the text it was parsed from.
+        struct JsonValue
+        {
+            enum Type {JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT};
+
+            Type type;
+            bool boolean;
+            String string;
+            std::vector<JsonValue> elements;
+            std::vector<std::pair<String, JsonValue> > members;
+            /// The value as written in the request.
+            String text;
+
+            JsonValue() : type(JSON_NULL), boolean(false) {}
+
+            const JsonValue* findMember(const String& name) const
+            {
+                for (size_t i = 0; i < members.size(); ++i)
+                {
+                    if (members[i].first == name)
+                    {
+                        return &members[i].second;
+                    }
+                }
+                return NULL;
+            }
+        };
+
+        class JsonParser
+        {
+        public:
+            explicit JsonParser(const String& text) : mText(text), mPos(0) {}
+
+            JsonValue parse()
+            {
+                JsonValue value = parseValue();
+                skipWhitespace();
+                if (mPos != mText.size())
+                {
+                    error("trailing characters");
+                }
+                return value;
+            }
+
+        private:
+            const String& mText;
+            size_t mPos;
+
+            void error(const String& what) const
+            {
+                throw std::invalid_argument("invalid JSON request: " + what);
+            }
+
+            void skipWhitespace()
+            {
+                while (mPos < mText.size() && (mText[mPos] == ' ' || mText[mPos] == '\t'
+                    || mText[mPos] == '\r' || mText[mPos] == '\n'))
+                {
+                    ++mPos;
+                }
+            }
+
+            char peek()
+            {
+                skipWhitespace();
+                if (mPos >= mText.size())
+                {
+                    error("unexpected end");
+                }
+                return mText[mPos];
+            }
+
+            void expect(char c)
+            {
+                if (peek() != c)
+                {
+                    error(String("expected '") + c + "'");
+                }
+                ++mPos;
+            }
+
+            bool consumeLiteral(const char* literal)
+            {
+                String lit(literal);
+                if (mText.compare(mPos, lit.size(), lit) == 0)
+                {
+                    mPos += lit.size();
+                    return true;
+                }
+                return false;
+            }
+
+            JsonValue parseValue()
+            {
+                JsonValue value;
+                char c = peek();
+                size_t start = mPos;
+                if (c == '{')
+                {
+                    value.type = JsonValue::JSON_OBJECT;
+                    ++mPos;
+                    if (peek() == '}')
+                    {
+                        ++mPos;
+                    }
+                    else
+                    {
+                        do
+                        {
+                            if (peek() != '"')
+                            {
+                                error("expected member name");
+                            }
+                            String name = parseString();
+                            expect(':');
+                            value.members.push_back(std::make_pair(name, parseValue()));
+                        }
+                        while (peek() == ',' && ++mPos);
+                        expect('}');
+                    }
+                }
+                else if (c == '[')
+                {
+                    value.type = JsonValue::JSON_ARRAY;
+                    ++mPos;
+                    if (peek() == ']')
+                    {
+                        ++mPos;
+                    }
+                    else
+                    {
+                        do
+                        {
+                            value.elements.push_back(parseValue());
+                        }
+                        while (peek() == ',' && ++mPos);
+                        expect(']');
+                    }
+                }
+                else if (c == '"')
+                {
+                    value.type = JsonValue::JSON_STRING;
+                    value.string = parseString();
+                }
+                else if (consumeLiteral("true") || consumeLiteral("false"))
+                {
+                    value.type = JsonValue::JSON_BOOL;
+                    value.boolean = mText[start] == 't';
+                }
+                else if (consumeLiteral("null"))
+                {
+                    value.type = JsonValue::JSON_NULL;
+                }
+                else if (c == '-' || (c >= '0' && c <= '9'))
+                {
+                    value.type = JsonValue::JSON_NUMBER;
+                    while (mPos < mText.size()
+                        && String("+-.eE0123456789").find(mText[mPos]) != String::npos)
+                    {
+                        ++mPos;
+                    }
+                }
+                else
+                {
+                    error("unexpected character");
+                }
+                value.text = mText.substr(start, mPos - start);
+                return value;
+            }
+
+            String parseString()
+            {
+                expect('"');
+                String result;
+                while (true)
+                {
+                    if (mPos >= mText.size())
+                    {
+                        error("unterminated string");
+                    }
+                    char c = mText[mPos++];
+                    if (c == '"')
+                    {
+                        return result;
+                    }
+                    if (c != '\\')
+                    {
+                        result += c;
+                        continue;
+                    }
+                    if (mPos >= mText.size())
+                    {
+                        error("unterminated string");
+                    }
+                    c = mText[mPos++];
+                    switch (c)
+                    {
+                    case 'b': result += '\b'; break;
+                    case 'f': result += '\f'; break;
+                    case 'n': result += '\n'; break;
+                    case 'r': result += '\r'; break;
+                    case 't': result += '\t'; break;
+                    case 'u': appendUtf8(result, parseCodePoint()); break;
+                    default: result += c; break;
+                    }
+                }
+            }
+
+            unsigned long parseHex4()
+            {
+                if (mPos + 4 > mText.size())
+                {
+                    error("invalid unicode escape");
+                }
+                unsigned long value = 0;
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    char c = mText[mPos++];
+                    value <<= 4;
+                    if (c >= '0' && c <= '9') value |= c - '0';
+                    else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+                    else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+                    else error("invalid unicode escape");
+                }
+                return value;
+            }
+
+            unsigned long parseCodePoint()
+            {
+                unsigned long codePoint = parseHex4();
+                // Surrogate pair
+                if (codePoint >= 0xD800 && codePoint < 0xDC00 && consumeLiteral("\\u"))
+                {
+                    unsigned long low = parseHex4();
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                return codePoint;
+            }
+
+            static void appendUtf8(String& out, unsigned long codePoint)
+            {
+                if (codePoint < 0x80)
+                {
+                    out += static_cast<char>(codePoint);
+                }
+                else if (codePoint < 0x800)
+                {
+                    out += static_cast<char>(0xC0 | (codePoint >> 6));
+                    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+                else if (codePoint < 0x10000)
+                {
+                    out += static_cast<char>(0xE0 | (codePoint >> 12));
+                    out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+                else
+                {
+                    out += static_cast<char>(0xF0 | (codePoint >> 18));
+                    out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+            }
+        };
+
+        String toJsonString(const String& value)
+        {
+            String result = "\"";
+            for (size_t i = 0; i < value.size(); ++i)
+            {
+                unsigned char c = static_cast<unsigned char>(value[i]);
+                switch (c)
+                {
+                case '"': result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\n': result += "\\n"; break;
+                case '\r': result += "\\r"; break;
+                case '\t': result += "\\t"; break;
+                default:
+                    if (c < 0x20)
+                    {
+                        char escaped[8];
+                        std::sprintf(escaped, "\\u%04x", c);
+                        result += escaped;
+                    }
+                    else
+                    {
+                        result += static_cast<char>(c);
+                    }
+                    break;
+                }
+            }
+            return result + "\"";
+        }
+
+        /// Returns the strings of an optional string array member.
+        StringVector getStringArray(const JsonValue& request, const String& name)
+        {
+            StringVector strings;
+            const JsonValue* value = request.findMember(name);
+            if (value == NULL || value->type == JsonValue::JSON_NULL)
+            {
+                return strings;
+            }
+            if (value->type != JsonValue::JSON_ARRAY)
+            {
+                throw std::invalid_argument("\"" + name + "\" must be an array of strings");
+            }
+            for (size_t i = 0; i < value->elements.size(); ++i)
+            {
+                if (value->elements[i].type != JsonValue::JSON_STRING)
+                {
+                    throw std::invalid_argument("\"" + name + "\" must be an array of strings");
+                }
+                strings.push_back(value->elements[i].string);
+            }
+            return strings;
+        }
+
+        /// Redirects std::cout and std::cerr for its lifetime.
+        class OutputCapture
+        {
+        public:
+            OutputCapture()
+                : mOldOut(std::cout.rdbuf(mOut.rdbuf())), mOldErr(std::cerr.rdbuf(mErr.rdbuf()))
+            {
+            }
+
+            ~OutputCapture()
+            {
+                std::cout.rdbuf(mOldOut);
+                std::cerr.rdbuf(mOldErr);
+            }
+
+            String getOut() const { return mOut.str(); }
+            String getErr() const { return mErr.str(); }
+
+        private:
+            std::ostringstream mOut;
+            std::ostringstream mErr;
+            std::streambuf* mOldOut;
+            std::streambuf* mOldErr;
+        };
+
+#if OGRE_PLATFORM != OGRE_PLATFORM_WIN32
+        /// Stream buffer reading from and writing to a socket.
+        class SocketStreamBuf : public std::streambuf
+        {
+        public:
+            explicit SocketStreamBuf(int fd) : mFd(fd)
+            {
+                setg(mIn, mIn, mIn);
+                setp(mOut, mOut + sizeof(mOut));
+            }
+
+            ~SocketStreamBuf()
+            {
+                sync();
+            }
+
+        protected:
+            int_type underflow()
+            {
+                ssize_t size;
+                do
+                {
+                    size = ::read(mFd, mIn, sizeof(mIn));
+                }
+                while (size < 0 && errno == EINTR);
+
+                if (size <= 0)
+                {
+                    return traits_type::eof();
+                }
+                setg(mIn, mIn, mIn + size);
+                return traits_type::to_int_type(*gptr());
+            }
+
+            int_type overflow(int_type c)
+            {
+                if (sync() == -1)
+                {
+                    return traits_type::eof();
+                }
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                {
+                    *pptr() = traits_type::to_char_type(c);
+                    pbump(1);
+                }
+                return traits_type::not_eof(c);
+            }
+
+            int sync()
+            {
+                const char* data = pbase();
+                while (data < pptr())
+                {
+                    ssize_t size = ::write(mFd, data, pptr() - data);
+                    if (size < 0)
+                    {
+                        if (errno == EINTR)
+                        {
+                            continue;
+                        }
+                        setp(mOut, mOut + sizeof(mOut));
+                        return -1;
+                    }
+                    data += size;
+                }
+                setp(mOut, mOut + sizeof(mOut));
+                return 0;
+            }
+
+        private:
+            int mFd;
+            char mIn[4096];
+            char mOut[4096];
+        };
+#endif
+    }
+
+    Server::Server(ToolManager& toolManager, const OptionDefinitionSet& globalOptionDefs)
+        : mToolManager(toolManager),
+          mGlobalOptionDefs(globalOptionDefs),
+          mShutdownRequested(false)
+    {
+    }
+
+    bool Server::isShutdownRequested() const
+    {
+        return mShutdownRequested;
+    }
+
+    String Server::handleRequest(const String& requestLine)
+    {
+        String id = "null";
+        String status = "ok";
+        String message;
+        String out, err;
+
+        try
+        {
+            JsonValue request = JsonParser(requestLine).parse();
+            if (request.type != JsonValue::JSON_OBJECT)
+            {
+                throw std::invalid_argument("request must be a JSON object");
+            }
+
+            const JsonValue* idValue = request.findMember("id");
+            if (idValue != NULL)
+            {
+                id = idValue->text;
+            }
+
+            const JsonValue* shutdown = request.findMember("shutdown");
+            if (shutdown != NULL && shutdown->type == JsonValue::JSON_BOOL && shutdown->boolean)
+            {
+                mShutdownRequested = true;
+            }
+            else
+            {
+                const JsonValue* tool = request.findMember("tool");
+                if (tool == NULL || tool->type != JsonValue::JSON_STRING)
+                {
+                    throw std::invalid_argument("\"tool\" is missing");
+                }
+                StringVector globalArgs = getStringArray(request, "global");
+                StringVector toolArgs = getStringArray(request, "options");
+                StringVector inFileNames = getStringArray(request, "in");
+                StringVector outFileNames = getStringArray(request, "out");
+                if (inFileNames.empty())
+                {
+                    throw std::invalid_argument("\"in\" is missing");
+                }
+
+                std::vector<const char*> globalArgv, toolArgv;
+                for (size_t i = 0; i < globalArgs.size(); ++i)
+                {
+                    globalArgv.push_back(globalArgs[i].c_str());
+                }
+                for (size_t i = 0; i < toolArgs.size(); ++i)
+                {
+                    toolArgv.push_back(toolArgs[i].c_str());
+                }
+
+                OutputCapture capture;
+                try
+                {
+                    OptionList globalOptions = OptionsParser::parseOptions(
+                        static_cast<int>(globalArgv.size()),
+                        globalArgv.empty() ? NULL : &globalArgv[0], mGlobalOptionDefs);
+                    mToolManager.invokeTool(tool->string, globalOptions,
+                        static_cast<int>(toolArgv.size()),
+                        toolArgv.empty() ? NULL : &toolArgv[0],
+                        inFileNames, outFileNames);
+                }
+                catch (...)
+                {
+                    out = capture.getOut();
+                    err = capture.getErr();
+                    OgreEnvironment::getSingleton().releaseResources();
+                    throw;
+                }
+                out = capture.getOut();
+                err = capture.getErr();
+                OgreEnvironment::getSingleton().releaseResources();
+            }
+        }
+        catch (std::exception& e)
+        {
+            status = "error";
+            message = e.what();
+        }
+        catch (...)
+        {
+            status = "error";
+            message = "unknown error";
+        }
+
+        String response = "{\"id\": " + id + ", \"status\": \"" + status + "\"";
+        if (!message.empty())
+        {
+            response += ", \"message\": " + toJsonString(message);
+        }
+        response += ", \"stdout\": " + toJsonString(out)
+            + ", \"stderr\": " + toJsonString(err) + "}";
+        return response;
+    }
+
+    void Server::serve(std::istream& in, std::ostream& out)
+    {
+        String line;
+        while (!mShutdownRequested && std::getline(in, line))
+        {
+            StringUtil::trim(line);
+            if (line.empty())
+            {
+                continue;
+            }
+            out << handleRequest(line) << std::endl;
+        }
+    }
+
+#if OGRE_PLATFORM != OGRE_PLATFORM_WIN32
+    void Server::serveSocket(const String& path)
+    {
+        sockaddr_un address;
+        if (path.empty() || path.size() >= sizeof(address.sun_path))
+        {
+            throw std::invalid_argument("invalid socket path " + path);
+        }
+
+        // Clients going away while we answer must not kill the server.
+        signal(SIGPIPE, SIG_IGN);
+
+        // Replace a socket left over by a previous server.
+        struct stat st;
+        if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        {
+            unlink(path.c_str());
+        }
+
+        int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd == -1)
+        {
+            throw std::runtime_error("unable to create socket");
+        }
+
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path.c_str());
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1
+            || listen(listenFd, 16) == -1)
+        {
+            close(listenFd);
+            throw std::runtime_error("unable to listen on socket " + path);
+        }
+
+        while (!mShutdownRequested)
+        {
+            int fd = accept(listenFd, NULL, NULL);
+            if (fd == -1)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                {
+                    continue;
+                }
+                close(listenFd);
+                unlink(path.c_str());
+                throw std::runtime_error("accepting connection on socket " + path + " failed");
+            }
+
+            {
+                SocketStreamBuf buffer(fd);
+                std::istream in(&buffer);
+                std::ostream out(&buffer);
+                serve(in, out);
+            }
+            close(fd);
+        }
+
+        close(listenFd);
+        unlink(path.c_str());
+    }
+#else
+    void Server::serveSocket(const String&)
+    {
+        throw std::logic_error("sockets are not supported on this platform");
+    }
+#endif
+}
@@ -0,0 +1,152 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmSkeletonRegistry.h"
+
+#include "MmBuildCache.h"
+#include "MmMappedFileDataStream.h"
+#include "MmToolUtils.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#   include <windows.h>
+#endif
+
+using namespace Ogre;
+
+namespace meshmagick
+{
+    namespace
+    {
+        const size_t BLOCK_SIZE = 16 * 1024;
+    }
+
+    size_t SkeletonRegistry::add(const String& fileName, const String& settings, bool& conflict)
+    {
+        conflict = false;
+        String resolvedPath = resolvePath(fileName);
+        std::map<String, size_t>::const_iterator it = mEntryIndices.find(resolvedPath);
+        if (it != mEntryIndices.end())
+        {
+            conflict = mEntries[it->second].settings != settings;
+            return it->second;
+        }
+
+        Entry entry;
+        entry.fileNames.push_back(fileName);
+        entry.settings = settings;
+        entry.contentHash = 0;
+        entry.contentSize = 0;
+        if (ToolUtils::hashFile(fileName, entry.contentHash, entry.contentSize))
+        {
+            // The grouping depends on the content, so a cached result does as well.
+            BuildCache::notifyFileRead(fileName, entry.contentHash, entry.contentSize);
+            for (size_t i = 0; i < mEntries.size(); ++i)
+            {
+                if (mEntries[i].contentHash == entry.contentHash
+                    && mEntries[i].contentSize == entry.contentSize
+                    && mEntries[i].settings == settings
+                    && hasSameContent(mEntries[i].fileNames[0], fileName))
+                {
+                    mEntries[i].fileNames.push_back(fileName);
+                    mEntryIndices[resolvedPath] = i;
+                    return i;
+                }
+            }
+        }
+
+        // Unreadable files get an entry of their own, the tool reports the error when loading.
+        mEntries.push_back(entry);
+        mEntryIndices[resolvedPath] = mEntries.size() - 1;
+        return mEntries.size() - 1;
+    }
+
+    bool SkeletonRegistry::contains(const String& fileName) const
+    {
+        return mEntryIndices.find(resolvePath(fileName)) != mEntryIndices.end();
+    }
+
+    size_t SkeletonRegistry::getNumEntries() const
+    {
+        return mEntries.size();
+    }
+
+    const SkeletonRegistry::Entry& SkeletonRegistry::getEntry(size_t index) const
+    {
+        return mEntries.at(index);
+    }
+
+    void SkeletonRegistry::clear()
+    {
+        mEntries.clear();
+        mEntryIndices.clear();
+    }
+
+    String SkeletonRegistry::resolvePath(const String& fileName)
+    {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+        char resolved[MAX_PATH];
+        if (GetFullPathNameA(fileName.c_str(), MAX_PATH, resolved, NULL) == 0)
+        {
+            return fileName;
+        }
+        return String(resolved);
+#else
+        char* resolved = realpath(fileName.c_str(), NULL);
+        if (resolved == NULL)
+        {
+            return fileName;
+        }
+        String rval(resolved);
+        std::free(resolved);
+        return rval;
+#endif
+    }
+
+    bool SkeletonRegistry::hasSameContent(const String& fileName1, const String& fileName2)
+    {
+        try
+        {
+            DataStreamPtr stream1 = MappedFileDataStream::open(fileName1);
+            DataStreamPtr stream2 = MappedFileDataStream::open(fileName2);
+            unsigned char block1[BLOCK_SIZE];
+            unsigned char block2[BLOCK_SIZE];
+            while (true)
+            {
+                size_t numBytes1 = stream1->read(block1, BLOCK_SIZE);
+                size_t numBytes2 = stream2->read(block2, BLOCK_SIZE);
+                if (numBytes1 != numBytes2 || std::memcmp(block1, block2, numBytes1) != 0)
+                {
+                    return false;
+                }
+                if (numBytes1 == 0)
+                {
+                    return true;
+                }
+            }
+        }
+        catch (std::exception&)
+        {
+            return false;
+        }
+    }
+}
@@ -26,7 +26,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <iostream>
 #include <stdexcept>
 
+#include "MmBuildCache.h"
 #include "MmEditableMesh.h"
+#include "MmMappedFileDataStream.h"
 
 using namespace Ogre;
 
@@ -54,20 +56,14 @@ namespace meshmagick
         mMesh = MeshPtr(new EditableMesh(mm, name, mesh->getHandle(),
 			ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME));
 
-        std::ifstream ifs;
-        ifs.open(name.c_str(), std::ios_base::in | std::ios_base::binary);
-        if (!ifs)
-        {
-            throw std::ios_base::failure(("cannot open file " + name).c_str());
-        }
-
-        DataStreamPtr stream(new FileStreamDataStream(name, &ifs, false));
+        DataStreamPtr stream = MappedFileDataStream::open(name);
+        BuildCache::notifyFileRead(name);
 
         determineFileFormat(stream);
 
         importMesh(stream, OGRE_GETPOINTER(mMesh));
 
-        ifs.close();
+        stream->close();
 
         return mMesh;
     }
@@ -81,6 +77,7 @@ namespace meshmagick
 
         Endian endianMode = keepEndianess ? mMeshFileEndian : ENDIAN_NATIVE;
         exportMesh(OGRE_GETPOINTER(mMesh), name, endianMode);
+        BuildCache::notifyFileWritten(name);
     }
 
     void StatefulMeshSerializer::clear()
@@ -26,7 +26,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <iostream>
 #include <stdexcept>
 
+#include "MmBuildCache.h"
 #include "MmEditableSkeleton.h"
+#include "MmMappedFileDataStream.h"
 
 using namespace Ogre;
 
@@ -60,20 +62,14 @@ namespace meshmagick
 
         mSkeleton = SkeletonPtr(new EditableSkeleton(*OGRE_GETPOINTER(mSkeleton)));
 
-        std::ifstream ifs;
-        ifs.open(name.c_str(), std::ios_base::in | std::ios_base::binary);
-        if (!ifs)
-        {
-            throw std::ios_base::failure(("cannot open file " + name).c_str());
-        }
-
-        DataStreamPtr stream(new FileStreamDataStream(name, &ifs, false));
+        DataStreamPtr stream = MappedFileDataStream::open(name);
+        BuildCache::notifyFileRead(name);
 
         determineFileFormat(stream);
 
         importSkeleton(stream, OGRE_GETPOINTER(mSkeleton));
 
-        ifs.close();
+        stream->close();
 
 		return mSkeleton;
     }
@@ -87,6 +83,7 @@ namespace meshmagick
 
         Endian endianMode = keepEndianess ? mSkeletonFileEndian : ENDIAN_NATIVE;
         exportSkeleton(OGRE_GETPOINTER(mSkeleton), name, SKELETON_VERSION_LATEST, endianMode);
+        BuildCache::notifyFileWritten(name);
     }
 
     void StatefulSkeletonSerializer::clear()
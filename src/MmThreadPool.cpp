@@ -0,0 +1,150 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmThreadPool.h"
+
+namespace meshmagick
+{
+    ThreadPool::ThreadPool(size_t numThreads)
+        : mTask(NULL),
+          mTaskCount(0),
+          mNextTask(0),
+          mBusyWorkers(0),
+          mGeneration(0),
+          mShutdown(false)
+    {
+        if (numThreads == 0)
+        {
+            numThreads = getHardwareThreadCount();
+        }
+
+        // The thread calling run() works too, so we need one worker less.
+        for (size_t i = 1; i < numThreads; ++i)
+        {
+            mWorkers.push_back(std::thread(&ThreadPool::workerLoop, this));
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mShutdown = true;
+        }
+        mWorkAvailable.notify_all();
+        for (size_t i = 0; i < mWorkers.size(); ++i)
+        {
+            mWorkers[i].join();
+        }
+    }
+
+    size_t ThreadPool::getNumThreads() const
+    {
+        return mWorkers.size() + 1;
+    }
+
+    size_t ThreadPool::getHardwareThreadCount()
+    {
+        unsigned int count = std::thread::hardware_concurrency();
+        return count > 0 ? count : 1;
+    }
+
+    void ThreadPool::run(size_t count, const std::function<void(size_t)>& task)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mTask = &task;
+        mTaskCount = count;
+        mNextTask = 0;
+        mError = std::exception_ptr();
+        ++mGeneration;
+        mWorkAvailable.notify_all();
+
+        runTasks(lock);
+
+        // Wait for the workers still busy with the last tasks.
+        while (mBusyWorkers > 0)
+        {
+            mWorkDone.wait(lock);
+        }
+        mTask = NULL;
+
+        if (mError)
+        {
+            std::exception_ptr error = mError;
+            mError = std::exception_ptr();
+            lock.unlock();
+            std::rethrow_exception(error);
+        }
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        unsigned int generation = mGeneration;
+        while (true)
+        {
+            while (!mShutdown && generation == mGeneration)
+            {
+                mWorkAvailable.wait(lock);
+            }
+            if (mShutdown)
+            {
+                return;
+            }
+            generation = mGeneration;
+
+            ++mBusyWorkers;
+            runTasks(lock);
+            --mBusyWorkers;
+            if (mBusyWorkers == 0)
+            {
+                mWorkDone.notify_all();
+            }
+        }
+    }
+
+    void ThreadPool::runTasks(std::unique_lock<std::mutex>& lock)
+    {
+        while (mNextTask < mTaskCount)
+        {
+            size_t index = mNextTask++;
+            const std::function<void(size_t)>& task = *mTask;
+            lock.unlock();
+            try
+            {
+                task(index);
+            }
+            catch (...)
+            {
+                lock.lock();
+                if (!mError)
+                {
+                    mError = std::current_exception();
+                }
+                continue;
+            }
+            lock.lock();
+        }
+    }
+}
@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <stdexcept>
 #include <OgreLog.h>
 
+#include "MmBuildCache.h"
 #include "MmOgreEnvironment.h"
 
 using namespace Ogre;
@@ -42,6 +43,49 @@ namespace meshmagick
     {
         setGlobalOptions(globalOptions);
         doInvoke(toolOptions, inFileNames, outFileNames);
+        releaseFileResources();
+    }
+
+    bool Tool::supportsLoadedMeshes() const
+    {
+        return false;
+    }
+
+    void Tool::beginLoadedMeshes(const OptionList& globalOptions, const OptionList& toolOptions)
+    {
+        setGlobalOptions(globalOptions);
+        doBeginLoadedMeshes(toolOptions);
+    }
+
+    bool Tool::processLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFileName,
+        const Ogre::String& outFileName)
+    {
+        return doProcessLoadedMesh(mesh, inFileName, outFileName);
+    }
+
+    void Tool::endLoadedMeshes()
+    {
+        doEndLoadedMeshes();
+    }
+
+    bool Tool::writesSidecarFiles() const
+    {
+        return false;
+    }
+
+    void Tool::doBeginLoadedMeshes(const OptionList&)
+    {
+        fail(getName() + " can't process loaded meshes.");
+    }
+
+    bool Tool::doProcessLoadedMesh(Ogre::MeshPtr, const Ogre::String&, const Ogre::String&)
+    {
+        fail(getName() + " can't process loaded meshes.");
+        return false;
+    }
+
+    void Tool::doEndLoadedMeshes()
+    {
     }
 
     void Tool::setGlobalOptions(const OptionList& globalOptions)
@@ -49,6 +93,7 @@ namespace meshmagick
         // Reset to defaults..
         mVerbosity = V_NORMAL;
         mFollowSkeletonLink = true;
+        mGlobalOptions = globalOptions;
 
         for (OptionList::const_iterator it = globalOptions.begin(); it != globalOptions.end(); ++it)
         {
@@ -84,6 +129,8 @@ namespace meshmagick
     void Tool::warn(const Ogre::String& msg) const
     {
         print("warning: " + msg, V_NORMAL, std::cerr);
+        // Restoring the result would swallow the warning.
+        BuildCache::notifyWarning();
     }
 
     void Tool::fail(const Ogre::String& msg) const
@@ -91,4 +138,9 @@ namespace meshmagick
         print("fatal error: " + msg, V_QUIET, std::cerr);
         throw std::logic_error(msg);
     }
+
+    void Tool::releaseFileResources() const
+    {
+        OgreEnvironment::getSingleton().releaseUnreferencedResources();
+    }
 }
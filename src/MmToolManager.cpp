@@ -18,12 +18,19 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
 #include "MmToolManager.h"
+
+#include "MmBuildCache.h"
 #include "MmToolFactory.h"
 
+#include <iostream>
 #include <stdexcept>
 
 namespace meshmagick
 {
+    ToolManager::ToolManager() : mBuildCache(NULL)
+    {
+    }
+
     ToolManager::~ToolManager()
     {
         while (!mFactories.empty())
@@ -40,11 +47,52 @@ namespace meshmagick
         FactoryMap::const_iterator it = mFactories.find(name);
         if (it != mFactories.end())
         {
-            OptionDefinitionSet optionDefs = it->second->getOptionDefinitions();
-            OptionList toolOptions = OptionsParser::parseOptions(toolArgc, toolArgV, optionDefs);
+            OptionList toolOptions = parseToolOptions(name, toolArgc, toolArgV);
+
+            Ogre::String cacheKey;
+            if (mBuildCache != NULL && it->second->isCacheable()
+                && !OptionsUtil::isOptionSet(globalOptions, "no-cache"))
+            {
+                cacheKey = mBuildCache->computeKey(name, globalOptions, toolOptions,
+                    inFileNames, outFileNames);
+                Ogre::StringVector restoredFiles;
+                if (!cacheKey.empty() && mBuildCache->restore(cacheKey, restoredFiles))
+                {
+                    if (!OptionsUtil::isOptionSet(globalOptions, "quiet"))
+                    {
+                        for (size_t i = 0; i < restoredFiles.size(); ++i)
+                        {
+                            std::cout << "Restored " << restoredFiles[i]
+                                << " from build cache." << std::endl;
+                        }
+                    }
+                    return;
+                }
+            }
+
             Tool* tool = it->second->createTool();
-            tool->invoke(globalOptions, toolOptions, inFileNames, outFileNames);
+            if (!cacheKey.empty())
+            {
+                mBuildCache->beginRecording(cacheKey);
+            }
+            try
+            {
+                tool->invoke(globalOptions, toolOptions, inFileNames, outFileNames);
+            }
+            catch (...)
+            {
+                if (!cacheKey.empty())
+                {
+                    mBuildCache->abortRecording();
+                }
+                it->second->destroyTool(tool);
+                throw;
+            }
             it->second->destroyTool(tool);
+            if (!cacheKey.empty())
+            {
+                mBuildCache->endRecording();
+            }
         }
         else
         {
@@ -77,6 +125,35 @@ namespace meshmagick
         }
     }
 
+    OptionList ToolManager::parseToolOptions(const Ogre::String& name, int toolArgc,
+        const char** toolArgV) const
+    {
+        FactoryMap::const_iterator it = mFactories.find(name);
+        if (it != mFactories.end())
+        {
+            OptionDefinitionSet optionDefs = it->second->getOptionDefinitions();
+            return OptionsParser::parseOptions(toolArgc, toolArgV, optionDefs);
+        }
+        else
+        {
+            throw std::logic_error("No such tool registered: " + name);
+        }
+    }
+
+    bool ToolManager::processesFilesIndependently(const Ogre::String& toolName,
+        const OptionList& globalOptions) const
+    {
+        FactoryMap::const_iterator it = mFactories.find(toolName);
+        if (it != mFactories.end())
+        {
+            return it->second->processesFilesIndependently(globalOptions);
+        }
+        else
+        {
+            throw std::logic_error("No such tool registered: " + toolName);
+        }
+    }
+
     void ToolManager::registerToolFactory(ToolFactory* factory)
     {
         mFactories.insert(std::make_pair(factory->getToolName(), factory));
@@ -87,6 +164,11 @@ namespace meshmagick
         mFactories.erase(factory->getToolName());
     }
 
+    void ToolManager::setBuildCache(BuildCache* cache)
+    {
+        mBuildCache = cache;
+    }
+
 	Tool* ToolManager::createTool(const Ogre::String& name)
 	{
 		FactoryMap::iterator it = mFactories.find(name);
@@ -19,6 +19,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "MmToolUtils.h"
 
+#include "MmMappedFileDataStream.h"
+
 #include <OgreMesh.h>
 #include <OgreStringConverter.h>
 
@@ -106,6 +108,15 @@ namespace meshmagick
         return rval;
     }
 
+    String ToolUtils::getSidecarFileName(const String& meshFileName, const String& extension)
+    {
+        if (StringUtil::endsWith(meshFileName, ".mesh"))
+        {
+            return meshFileName.substr(0, meshFileName.size() - 5) + extension;
+        }
+        return meshFileName + extension;
+    }
+
     // Code taken from http://www.codepedia.com/1/CppFileExists
     // Code is public domain according to codepedia terms of use.
     bool ToolUtils::fileExists(const Ogre::String& fileName)
@@ -120,5 +131,33 @@ namespace meshmagick
         fin.close();
         return false;
     }
-}
 
+    bool ToolUtils::hashFile(const Ogre::String& fileName, Ogre::uint64& hash, size_t& size)
+    {
+        DataStreamPtr stream;
+        try
+        {
+            stream = MappedFileDataStream::open(fileName);
+        }
+        catch (std::exception&)
+        {
+            return false;
+        }
+
+        const size_t blockSize = 16 * 1024;
+        unsigned char block[blockSize];
+        hash = 14695981039346656037ULL;
+        size = 0;
+        size_t numBytes;
+        while ((numBytes = stream->read(block, blockSize)) > 0)
+        {
+            for (size_t i = 0; i < numBytes; ++i)
+            {
+                hash = (hash ^ block[i]) * 1099511628211ULL;
+            }
+            size += numBytes;
+        }
+        stream->close();
+        return true;
+    }
+}
@@ -23,6 +23,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <OgreStringConverter.h>
 #include <OgreSubMesh.h>
 
+#include <set>
+
 #include "MmMeshUtils.h"
 #include "MmToolUtils.h"
 #include "MmOgreEnvironment.h"
@@ -77,6 +79,8 @@ using AffineTransformationType = Ogre::Matrix4;
         setOptions(toolOptions);
 
         StringVector outFileNames = outFileNamesArg.empty() ? inFileNames : outFileNamesArg;
+        mLinkedSkeletons.clear();
+        mLinkedSkeletonTransforms.clear();
 
         // Process the meshes
         for (size_t i = 0, end = inFileNames.size(); i < end; ++i)
@@ -94,10 +98,59 @@ using AffineTransformationType = Ogre::Matrix4;
                 warn("unrecognised name ending for file " + inFileNames[i]);
                 warn("file skipped.");
             }
+
+            releaseFileResources();
+        }
+
+        processLinkedSkeletons(inFileNames);
+    }
+
+    void TransformTool::processLinkedSkeletons(const StringVector& inFileNames)
+    {
+        std::set<String> inputSkeletons;
+        for (size_t i = 0; i < inFileNames.size(); ++i)
+        {
+            if (StringUtil::endsWith(inFileNames[i], ".skeleton", true))
+            {
+                inputSkeletons.insert(SkeletonRegistry::resolvePath(inFileNames[i]));
+            }
+        }
+
+        StatefulSkeletonSerializer* skeletonSerializer =
+            OgreEnvironment::getSingleton().getSkeletonSerializer();
+        for (size_t i = 0; i < mLinkedSkeletons.getNumEntries(); ++i)
+        {
+            // Skeletons given as input file have been transformed already.
+            StringVector fileNames;
+            const StringVector& entryFileNames = mLinkedSkeletons.getEntry(i).fileNames;
+            for (size_t j = 0; j < entryFileNames.size(); ++j)
+            {
+                if (inputSkeletons.count(SkeletonRegistry::resolvePath(entryFileNames[j])) == 0)
+                {
+                    fileNames.push_back(entryFileNames[j]);
+                }
+            }
+            if (fileNames.empty())
+            {
+                continue;
+            }
+
+            // In this case keep file names and use the transform of the meshes.
+            mTransform = mLinkedSkeletonTransforms[i];
+            if (processSkeletonFile(fileNames[0], fileNames[0], false))
+            {
+                for (size_t j = 1; j < fileNames.size(); ++j)
+                {
+                    skeletonSerializer->saveSkeleton(fileNames[j], true);
+                    print("Skeleton saved as " + fileNames[j] + ".");
+                }
+            }
+
+            releaseFileResources();
         }
     }
 
-    void TransformTool::processSkeletonFile(String inFile, String outFile, bool calcTransform)
+    bool TransformTool::processSkeletonFile(String inFile, String outFile, bool calcTransform)
     {
         StatefulSkeletonSerializer* skeletonSerializer =
             OgreEnvironment::getSingleton().getSkeletonSerializer();
@@ -113,7 +166,7 @@ using AffineTransformationType = Ogre::Matrix4;
             warn(e.what());
             warn("Unable to open skeleton file " + inFile);
             warn("file skipped.");
-            return;
+            return false;
         }
         print("Processing skeleton...");
         if (calcTransform)
@@ -123,6 +176,7 @@ using AffineTransformationType = Ogre::Matrix4;
         processSkeleton(skeleton);
         skeletonSerializer->saveSkeleton(outFile, true);
         print("Skeleton saved as " + outFile + ".");
+        return true;
     }
 
     void TransformTool::processMeshFile(Ogre::String inFile, Ogre::String outFile)
@@ -144,17 +198,58 @@ using AffineTransformationType = Ogre::Matrix4;
             return;
         }
         print("Processing mesh...");
-        calculateTransform(mesh);
-        processMesh(mesh);
+        doProcessLoadedMesh(mesh, inFile, outFile);
         meshSerializer->saveMesh(outFile, true);
         print("Mesh saved as " + outFile + ".");
+    }
+
+    bool TransformTool::supportsLoadedMeshes() const
+    {
+        return true;
+    }
+
+    void TransformTool::doBeginLoadedMeshes(const OptionList& toolOptions)
+    {
+        setOptions(toolOptions);
+        mLinkedSkeletons.clear();
+        mLinkedSkeletonTransforms.clear();
+    }
+
+    bool TransformTool::doProcessLoadedMesh(Ogre::MeshPtr mesh, const Ogre::String& inFile,
+        const Ogre::String&)
+    {
+        calculateTransform(mesh);
+        processMesh(mesh);
 
         if (mFollowSkeletonLink && mesh->hasSkeleton())
         {
-            // In this case keep file name and also keep already determined transform
+            // Skeletons are often shared, so they are transformed once after all meshes,
+            // with the transform determined for the first mesh linking them.
             String skeletonFileName = ToolUtils::getSkeletonFileName(mesh, inFile);
-            processSkeletonFile(skeletonFileName, skeletonFileName, false);
+            if (skeletonFileName.empty())
+            {
+                warn("Unable to find skeleton file " + mesh->getSkeletonName());
+                return true;
+            }
+            bool conflict;
+            size_t index = mLinkedSkeletons.add(skeletonFileName,
+                StringConverter::toString(mTransform), conflict);
+            if (index == mLinkedSkeletonTransforms.size())
+            {
+                mLinkedSkeletonTransforms.push_back(mTransform);
+            }
+            if (conflict)
+            {
+                warn("skeleton " + skeletonFileName + " is shared by meshes with different "
+                    "transforms, the transform of the first one is used.");
+            }
         }
+        return true;
+    }
+
+    void TransformTool::doEndLoadedMeshes()
+    {
+        processLinkedSkeletons(StringVector());
     }
 
     void TransformTool::processSkeleton(Ogre::SkeletonPtr skeleton)
@@ -407,20 +502,10 @@ using AffineTransformationType = Ogre::Matrix4;
 
         unsigned char* data =
             static_cast<unsigned char*>(buffer->lock(Ogre::HardwareBuffer::HBL_READ_ONLY));
-        for (size_t i = 0; i < vertexData->vertexCount; ++i)
-        {
-            Real* ptr;
-            vertexElem->baseVertexPointerToElement(data, &ptr);
-
-            Vector3 vertex(ptr);
-            vertex = mTransform * vertex;
-            ptr[0] = vertex.x;
-            ptr[1] = vertex.y;
-            ptr[2] = vertex.z;
-            mBoundingBox.merge(vertex);
-
-            data += buffer->getVertexSize();
-        }
+        float* positions;
+        vertexElem->baseVertexPointerToElement(data, &positions);
+        mBoundingBox.merge(MeshUtils::transformPositions(positions, vertexData->vertexCount,
+            buffer->getVertexSize(), mTransform, true));
         buffer->unlock();
     }
 
@@ -112,4 +112,10 @@ namespace meshmagick
         return "Scale, rotate or otherwise transform a mesh.";
     }
     //------------------------------------------------------------------------
+
+    bool TransformToolFactory::processesFilesIndependently(const OptionList& globalOptions) const
+    {
+        return OptionsUtil::isOptionSet(globalOptions, "no-follow-skeleton");
+    }
+    //------------------------------------------------------------------------
 }
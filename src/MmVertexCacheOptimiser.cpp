@@ -0,0 +1,222 @@
+/*
+This file is part of MeshMagick - An Ogre mesh file manipulation tool.
+Copyright (C) 2007-2009 Daniel Wickert
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MmVertexCacheOptimiser.h"
+
+#include <cassert>
+#include <cmath>
+
+using namespace Ogre;
+
+namespace
+{
+    // Scoring parameters as suggested in Forsyth's article.
+    const size_t MAX_CACHE_SIZE = 32;
+    const float CACHE_DECAY_POWER = 1.5f;
+    const float LAST_TRIANGLE_SCORE = 0.75f;
+    const float VALENCE_BOOST_SCALE = 2.0f;
+    const float VALENCE_BOOST_POWER = 0.5f;
+
+    float getVertexScore(int cachePosition, uint32 remainingTriangles)
+    {
+        if (remainingTriangles == 0)
+        {
+            // Not used by any triangle left, so it doesn't matter.
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            if (cachePosition < 3)
+            {
+                // Used by the last triangle. Fixed score, so that it doesn't matter which
+                // of the three vertices the next triangle shares.
+                score = LAST_TRIANGLE_SCORE;
+            }
+            else
+            {
+                const float scaler = 1.0f / (MAX_CACHE_SIZE - 3);
+                score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+            }
+        }
+
+        // Boost vertices with few triangles left, to get rid of lone triangles early.
+        score += VALENCE_BOOST_SCALE *
+            std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+        return score;
+    }
+}
+
+namespace meshmagick
+{
+    void VertexCacheOptimiser::optimise(std::vector<uint32>& indices, size_t vertexCount)
+    {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2)
+        {
+            return;
+        }
+
+        // Triangles using each vertex, as one array indexed by triangleStart.
+        // Only the first remainingTriangles[v] entries of a vertex are still to be emitted.
+        std::vector<uint32> remainingTriangles(vertexCount, 0);
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+        {
+            assert(indices[i] < vertexCount);
+            ++remainingTriangles[indices[i]];
+        }
+        std::vector<uint32> triangleStart(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            triangleStart[v + 1] = triangleStart[v] + remainingTriangles[v];
+        }
+        std::vector<uint32> vertexTriangles(triangleCount * 3);
+        std::vector<uint32> fill(triangleStart.begin(), triangleStart.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+        {
+            vertexTriangles[fill[indices[i]]++] = static_cast<uint32>(i / 3);
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            vertexScore[v] = getVertexScore(-1, remainingTriangles[v]);
+        }
+
+        std::vector<float> triangleScore(triangleCount);
+        std::vector<bool> emitted(triangleCount, false);
+        size_t bestTriangle = 0;
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            triangleScore[t] = vertexScore[indices[t * 3]] +
+                vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+            if (triangleScore[t] > triangleScore[bestTriangle])
+            {
+                bestTriangle = t;
+            }
+        }
+
+        std::vector<uint32> output;
+        output.reserve(triangleCount * 3);
+        std::vector<uint32> cache;
+        std::vector<uint32> newCache;
+        cache.reserve(MAX_CACHE_SIZE + 3);
+        newCache.reserve(MAX_CACHE_SIZE + 3);
+        // Fallback when no cached vertex has triangles left: next triangle in input order.
+        size_t scanPosition = 0;
+
+        while (output.size() < triangleCount * 3)
+        {
+            if (bestTriangle == triangleCount)
+            {
+                while (emitted[scanPosition])
+                {
+                    ++scanPosition;
+                }
+                bestTriangle = scanPosition;
+            }
+
+            const uint32* tri = &indices[bestTriangle * 3];
+            emitted[bestTriangle] = true;
+            newCache.clear();
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const uint32 v = tri[k];
+                output.push_back(v);
+                newCache.push_back(v);
+
+                // Remove the triangle from the vertex' remaining triangles.
+                uint32* first = &vertexTriangles[triangleStart[v]];
+                uint32* last = first + remainingTriangles[v] - 1;
+                for (uint32* t = first; t <= last; ++t)
+                {
+                    if (*t == bestTriangle)
+                    {
+                        std::swap(*t, *last);
+                        break;
+                    }
+                }
+                --remainingTriangles[v];
+            }
+
+            // Move the triangle's vertices to the front of the LRU cache.
+            for (size_t c = 0; c < cache.size(); ++c)
+            {
+                const uint32 v = cache[c];
+                if (v != tri[0] && v != tri[1] && v != tri[2])
+                {
+                    newCache.push_back(v);
+                }
+            }
+            cache.swap(newCache);
+
+            // Update scores of all vertices that were or still are cached, and of their
+            // triangles. Pick the best triangle among them for the next round.
+            bestTriangle = triangleCount;
+            float bestScore = -1.0f;
+            for (size_t c = 0; c < cache.size(); ++c)
+            {
+                const uint32 v = cache[c];
+                cachePosition[v] = c < MAX_CACHE_SIZE ? static_cast<int>(c) : -1;
+                const float score = getVertexScore(cachePosition[v], remainingTriangles[v]);
+                const float delta = score - vertexScore[v];
+                vertexScore[v] = score;
+
+                for (uint32 i = 0; i < remainingTriangles[v]; ++i)
+                {
+                    const uint32 t = vertexTriangles[triangleStart[v] + i];
+                    triangleScore[t] += delta;
+                    if (triangleScore[t] > bestScore)
+                    {
+                        bestScore = triangleScore[t];
+                        bestTriangle = t;
+                    }
+                }
+            }
+            if (cache.size() > MAX_CACHE_SIZE)
+            {
+                cache.resize(MAX_CACHE_SIZE);
+            }
+        }
+
+        indices.swap(output);
+    }
+
+    size_t VertexCacheOptimiser::countCacheMisses(const std::vector<uint32>& indices,
+        size_t vertexCount, size_t cacheSize)
+    {
+        // A vertex is cached if fewer than cacheSize vertices were loaded since it was loaded.
+        std::vector<size_t> loadTime(vertexCount, 0);
+        size_t time = cacheSize + 1;
+        size_t misses = 0;
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            const uint32 v = indices[i];
+            assert(v < vertexCount);
+            if (time - loadTime[v] > cacheSize)
+            {
+                loadTime[v] = time++;
+                ++misses;
+            }
+        }
+        return misses;
+    }
+}
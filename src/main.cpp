@@ -19,16 +19,27 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "MeshMagickPrerequisites.h"
 
+#include "MmBuildCache.h"
+#include "MmCompressToolFactory.h"
 #include "MmMeshMergeToolFactory.h"
+#include "MmMeshletToolFactory.h"
 #include "MmInfoToolFactory.h"
+#include "MmLodToolFactory.h"
 #include "MmOgreEnvironment.h"
 #include "MmOptimiseToolFactory.h"
 #include "MmOptionsParser.h"
+#include "MmPipelineToolFactory.h"
+#include "MmProcessPool.h"
 #include "MmRenameToolFactory.h"
+#include "MmReorganiseToolFactory.h"
+#include "MmServer.h"
+#include "MmSkeletonRegistry.h"
 #include "MmTool.h"
 #include "MmToolManager.h"
 #include "MmTransformToolFactory.h"
 
+#include <set>
+
 using namespace Ogre;
 using namespace meshmagick;
 
@@ -42,9 +53,18 @@ void printHelp(void)
     std::cout << "Copyright 2007-2008 by Daniel Wickert" << std::endl << std::endl;
     std::cout << "Usage: MeshMagick [global_options] toolname [tool_options] infile(s) -- [outfile(s)]" << std::endl;
     std::cout << "Global options:" << std::endl;
+    std::cout << "    -cache-dir=path     = Directory of the build cache, default is the user's" << std::endl;
+    std::cout << "                          cache directory." << std::endl;
+    std::cout << "    -cache-size=mb      = Size limit of the build cache in MB, default 512." << std::endl;
+    std::cout << "                          Least recently used results are removed first." << std::endl;
+    std::cout << "    -cache-stats        = Prints build cache statistics" << std::endl;
     std::cout << "    -help               = Prints this help text" << std::endl;
     std::cout << "    -help=toolname      = Prints help for the specified tool" << std::endl;
+    std::cout << "    -jobs=n             = Process up to n input files at once, each in its own" << std::endl;
+    std::cout << "                          process. 0 or no value: one per hardware thread." << std::endl;
+    std::cout << "                          Output is printed in input file order." << std::endl;
     std::cout << "    -list               = Lists available tools" << std::endl;
+    std::cout << "    -no-cache           = Always run the tool, don't use the build cache" << std::endl;
     std::cout << "    -no-follow-skeleton = Do not follow Skeleton-Link (if applicable)" << std::endl;
     std::cout << "    -quiet              = Supress all messages to cout." << std::endl;
     std::cout << "    -verbose            = Print more detailed messages." << std::endl;
@@ -52,6 +72,16 @@ void printHelp(void)
     std::cout << std::endl;
     std::cout << "If no outfile is specified, the infile is overwritten. (if applicable)" << std::endl;
     std::cout << std::endl;
+    std::cout << "Files written by a tool are kept in the build cache. Invoking it again with" << std::endl;
+    std::cout << "the same options on unchanged files restores them instead of processing." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Usage: MeshMagick serve [-socket=path]" << std::endl;
+    std::cout << "Runs tools on requests given as one JSON object per line, like" << std::endl;
+    std::cout << "    {\"id\": 1, \"tool\": \"info\", \"options\": [\"-brief\"], \"in\": [\"a.mesh\"]}" << std::endl;
+    std::cout << "and answers each with one JSON line. Requests are read from stdin or, with" << std::endl;
+    std::cout << "-socket, from connections to a unix domain socket created at path." << std::endl;
+    std::cout << "{\"shutdown\": true} stops the server." << std::endl;
+    std::cout << std::endl;
 }
 
 struct CommandLine
@@ -103,8 +133,8 @@ CommandLine parseCommandLine(int argc, const char** argv)
 
     if (!cmdLine.toolName.empty())
     {
-        // determine number of tool arguments
-        int numToolArgs = 0;
+        // determine number of tool arguments, all remaining ones if there is no infile
+        int numToolArgs = argc - numGlobalArgs - 2;
         for (int i = idx; i < argc; ++i)
         {
             String arg = argv[i];
@@ -154,6 +184,97 @@ CommandLine parseCommandLine(int argc, const char** argv)
     return cmdLine;
 }
 
+/// Looks for a file that the per file invocations of -jobs would all write, which they
+/// would do concurrently. Returns true and its name if there is one.
+bool findSharedOutputFile(const CommandLine& cmdLine, String& fileName)
+{
+    const StringVector& outFileNames =
+        cmdLine.outFileNames.empty() ? cmdLine.inFileNames : cmdLine.outFileNames;
+    std::set<String> resolvedNames;
+    for (size_t i = 0; i < outFileNames.size(); ++i)
+    {
+        if (!resolvedNames.insert(SkeletonRegistry::resolvePath(outFileNames[i])).second)
+        {
+            fileName = outFileNames[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+int invokeToolInProcesses(const CommandLine& cmdLine, size_t numJobs)
+{
+    // Each input file gets its own invocation, with the same options minus -jobs.
+    StringVector baseArgs;
+    baseArgs.push_back(cmdLine.commandName);
+    for (int i = 0; i < cmdLine.globalArgc; ++i)
+    {
+        String arg = cmdLine.globalArgv[i];
+        if (arg.substr(1, arg.find('=') - 1) != "jobs")
+        {
+            baseArgs.push_back(arg);
+        }
+    }
+    baseArgs.push_back(cmdLine.toolName);
+    for (int i = 0; i < cmdLine.toolArgc; ++i)
+    {
+        baseArgs.push_back(cmdLine.toolArgv[i]);
+    }
+
+    ProcessPool pool(numJobs);
+    for (size_t i = 0; i < cmdLine.inFileNames.size(); ++i)
+    {
+        StringVector args = baseArgs;
+        args.push_back(cmdLine.inFileNames[i]);
+        if (!cmdLine.outFileNames.empty())
+        {
+            args.push_back("--");
+            args.push_back(cmdLine.outFileNames[i]);
+        }
+        pool.addCommand(args);
+    }
+
+    size_t numFailed = pool.run();
+    if (numFailed > 0)
+    {
+        std::cout << numFailed << " of " << cmdLine.inFileNames.size()
+            << " files failed." << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+int serve(const CommandLine& cmdLine, ToolManager& manager,
+    const OptionDefinitionSet& globalOptionDefs)
+{
+    OptionDefinitionSet serveOptionDefs;
+    serveOptionDefs.insert(OptionDefinition("socket", OT_STRING, false, false, Any(String())));
+
+    try
+    {
+        OptionList serveOptions = OptionsParser::parseOptions(
+            cmdLine.toolArgc, cmdLine.toolArgv, serveOptionDefs);
+        String socketPath = OptionsUtil::getStringOption(serveOptions, "socket");
+
+        Server server(manager, globalOptionDefs);
+        if (socketPath.empty())
+        {
+            server.serve(std::cin, std::cout);
+        }
+        else
+        {
+            server.serveSocket(socketPath);
+        }
+    }
+    catch (std::exception& se)
+    {
+        std::cerr << "Serving failed:" << std::endl;
+        std::cerr << se.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
 int main(int argc, const char** argv)
 {
     if (argc < 2)
@@ -168,6 +289,11 @@ int main(int argc, const char** argv)
     manager.registerToolFactory(new MeshMergeToolFactory());
     manager.registerToolFactory(new RenameToolFactory());
 	manager.registerToolFactory(new OptimiseToolFactory());
+    manager.registerToolFactory(new CompressToolFactory());
+    manager.registerToolFactory(new LodToolFactory());
+    manager.registerToolFactory(new MeshletToolFactory());
+    manager.registerToolFactory(new ReorganiseToolFactory());
+    manager.registerToolFactory(new PipelineToolFactory(manager));
 
     OgreEnvironment* ogreEnv = new OgreEnvironment();
 	ogreEnv->initialize();
@@ -176,8 +302,13 @@ int main(int argc, const char** argv)
 
     // Define allowed global arguments
     OptionDefinitionSet globalOptionDefs = OptionDefinitionSet();
+    globalOptionDefs.insert(OptionDefinition("cache-dir", OT_STRING, false, false, Any(String())));
+    globalOptionDefs.insert(OptionDefinition("cache-size", OT_INT, false, false, Any(512)));
+    globalOptionDefs.insert(OptionDefinition("cache-stats"));
     globalOptionDefs.insert(OptionDefinition("help", OT_STRING, false, false, Any(String())));
+    globalOptionDefs.insert(OptionDefinition("jobs", OT_INT, false, false, Any(0)));
     globalOptionDefs.insert(OptionDefinition("list"));
+    globalOptionDefs.insert(OptionDefinition("no-cache"));
     globalOptionDefs.insert(OptionDefinition("no-follow-skeleton"));
     globalOptionDefs.insert(OptionDefinition("version"));
     globalOptionDefs.insert(OptionDefinition("quiet"));
@@ -202,6 +333,11 @@ int main(int argc, const char** argv)
     }
 
     // Evaluate global options (as far as they are of interest here...)
+    int numJobs = 1;
+    String cacheDir;
+    int cacheSize = 512;
+    bool noCache = false;
+    bool printCacheStats = false;
     for (OptionList::const_iterator it = globalOptions.begin(); it != globalOptions.end(); ++it)
     {
         if (it->first == "version")
@@ -248,6 +384,50 @@ int main(int argc, const char** argv)
             manager.printToolList(std::cout);
             return 0;
         }
+        else if (it->first == "jobs")
+        {
+            numJobs = std::max(0, any_cast<int>(it->second));
+        }
+        else if (it->first == "cache-dir")
+        {
+            cacheDir = any_cast<String>(it->second);
+        }
+        else if (it->first == "cache-size")
+        {
+            cacheSize = std::max(0, any_cast<int>(it->second));
+        }
+        else if (it->first == "no-cache")
+        {
+            noCache = true;
+        }
+        else if (it->first == "cache-stats")
+        {
+            printCacheStats = true;
+        }
+    }
+
+    BuildCache* buildCache = NULL;
+    if (cacheDir.empty())
+    {
+        cacheDir = BuildCache::getDefaultDirectory();
+    }
+    if (!noCache && !cacheDir.empty())
+    {
+        buildCache = new BuildCache(cacheDir, static_cast<uint64>(cacheSize) * 1024 * 1024);
+        manager.setBuildCache(buildCache);
+    }
+
+    if (printCacheStats)
+    {
+        if (buildCache != NULL)
+        {
+            buildCache->printStatistics(std::cout);
+        }
+        else
+        {
+            std::cout << "The build cache is disabled." << std::endl;
+        }
+        return 0;
     }
 
     if (cmdLine.toolName.empty())
@@ -257,9 +437,43 @@ int main(int argc, const char** argv)
         return -1;
     }
 
+    if (cmdLine.toolName == "serve")
+    {
+        return serve(cmdLine, manager, globalOptionDefs);
+    }
+
     // create and invoke tool
     try
     {
+        // Ogre's managers aren't thread safe, so files are processed in parallel by
+        // separate processes. Not for tools combining all files or when the number of
+        // output files doesn't fit, the tool reports that on its own.
+        if (numJobs != 1 && cmdLine.inFileNames.size() > 1
+            && (cmdLine.outFileNames.empty()
+                || cmdLine.outFileNames.size() == cmdLine.inFileNames.size()))
+        {
+            String sharedFileName;
+            if (!manager.processesFilesIndependently(cmdLine.toolName, globalOptions))
+            {
+                std::cout << "Tool " << cmdLine.toolName
+                    << " processes all files together, -jobs is ignored." << std::endl;
+            }
+            else if (findSharedOutputFile(cmdLine, sharedFileName))
+            {
+                std::cout << "Several input files are written to " << sharedFileName
+                    << ", -jobs is ignored." << std::endl;
+            }
+            else if (!ProcessPool::isSupported())
+            {
+                std::cout << "-jobs is not supported on this platform, "
+                    << "files are processed one after another." << std::endl;
+            }
+            else
+            {
+                return invokeToolInProcesses(cmdLine, static_cast<size_t>(numJobs));
+            }
+        }
+
         manager.invokeTool(cmdLine.toolName, globalOptions, cmdLine.toolArgc, cmdLine.toolArgv,
             cmdLine.inFileNames, cmdLine.outFileNames);
     }